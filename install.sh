@@ -1,5 +1,9 @@
 #!/bin/sh
 
+# the compression libraries zlib, bzip2 and liblzma (with development
+# headers) are not installed by this script, e.g. on Debian/Ubuntu run
+# sudo apt-get install zlib1g-dev libbz2-dev liblzma-dev
+
 cd tools
 ./install.sh
 cd ..
@@ -0,0 +1,133 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CheckpointWriter.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include "CheckpointWriter.hpp"
+#include "Utils/BinaryIO.hpp"
+
+CheckpointWriter::CheckpointWriter(const std::string &FileName_) :
+  FileName(FileName_),
+  PendingData(),
+  HasPendingData(false),
+  IsWriting(false),
+  StopWriterThread(false)
+{
+  WriterThread = std::thread(&CheckpointWriter::WriterThreadFn, this);
+}
+
+
+CheckpointWriter::~CheckpointWriter()
+{
+  {
+    std::lock_guard<std::mutex> Lock(JobsMutex);
+    StopWriterThread = true;
+  }
+  JobsCondition.notify_all();
+  WriterThread.join();
+}
+
+
+void CheckpointWriter::Write(std::string &&Data)
+{
+  {
+    std::lock_guard<std::mutex> Lock(JobsMutex);
+    PendingData = std::move(Data);
+    HasPendingData = true;
+  }
+  JobsCondition.notify_all();
+}
+
+
+void CheckpointWriter::Flush()
+{
+  std::unique_lock<std::mutex> Lock(JobsMutex);
+  JobsCondition.wait(Lock, [this]() {
+    return !HasPendingData && !IsWriting;
+  });
+}
+
+
+void CheckpointWriter::WriterThreadFn()
+{
+  while (true) {
+    std::string Data;
+    {
+      std::unique_lock<std::mutex> Lock(JobsMutex);
+      JobsCondition.wait(Lock, [this]() {
+        return StopWriterThread || HasPendingData;
+      });
+      if (!HasPendingData) {
+        return;
+      }
+      Data.swap(PendingData);
+      HasPendingData = false;
+      IsWriting = true;
+    }
+
+    WriteCheckpointFile(Data);
+
+    {
+      std::lock_guard<std::mutex> Lock(JobsMutex);
+      IsWriting = false;
+    }
+    JobsCondition.notify_all();
+  }
+}
+
+
+void CheckpointWriter::WriteCheckpointFile(const std::string &Data) const
+{
+  std::string TmpFileName = FileName + ".tmp";
+  bool Written = false;
+  try {
+    BinaryWriter Writer(TmpFileName);
+    Writer.WriteBytes(Data.data(), Data.size());
+    Written = Writer.Close();
+  } catch (const std::runtime_error &) {
+  }
+  if (!Written ||
+      std::rename(TmpFileName.c_str(), FileName.c_str()) != 0) {
+    std::cerr << "Warning: Could not write checkpoint " << FileName
+              << std::endl;
+    std::remove(TmpFileName.c_str());
+  }
+}
@@ -0,0 +1,106 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CheckpointWriter.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: writes checkpoints of the sampler state in a background thread
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _CHECKPOINTWRITER_HPP_
+#define _CHECKPOINTWRITER_HPP_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* writes checkpoints of the sampler state in a dedicated thread. The state
+   is passed as a serialized snapshot, so sampling continues while it is
+   written. A checkpoint is written to a temporary file which then replaces
+   the previous checkpoint, so an interrupted run always leaves a complete
+   checkpoint behind */
+class CheckpointWriter {
+  const std::string FileName;
+
+  std::thread WriterThread;
+  std::mutex JobsMutex;
+  std::condition_variable JobsCondition;
+  std::string PendingData;             // serialized state waiting to be written
+  bool HasPendingData;
+  bool IsWriting;                      // a checkpoint is being written
+  bool StopWriterThread;
+
+
+  /* internal functions */
+  void WriterThreadFn();
+
+  // write Data to the temporary file and rename it to FileName
+  void WriteCheckpointFile(
+    const std::string &Data
+  ) const;
+
+public:
+  /* constructor */
+  CheckpointWriter(
+    const std::string &FileName_
+  );
+
+  // write the pending checkpoint and stop the writer thread
+  ~CheckpointWriter();
+
+
+  /* interface */
+  // queue a serialized state for writing. A checkpoint still waiting to be
+  // written is replaced, since it is outdated by the new one
+  void Write(
+    std::string &&Data
+  );
+
+  // wait until all queued checkpoints are written
+  void Flush();
+};
+
+#endif
@@ -44,6 +44,7 @@
 #include "DebugLib.hpp"
 #include <iomanip>
 #include <iostream>
+#include <sys/resource.h>
 
 void DebugLib::PrintTransitions(const ContextToContextTransitions &Transitions, unsigned int CurrentContextId, std::vector< bool > &VisitedContextIds, const NHPYLM &LanguageModel, int SentEndWordId)
 {
@@ -120,14 +121,20 @@ void DebugLib::PrintLexiconStatistics(const std::vector< int > &LexiconCorrNFoun
             << std::endl << std::endl;
 }
 
-void DebugLib::PrintSentencesPerplexity(const std::vector<std::vector<int> > &Sentences, const NHPYLM &LanguageModel)
+void DebugLib::PrintSentencesPerplexity(const std::vector<std::vector<int> > &Sentences, const NHPYLM &LanguageModel, unsigned int NumThreads, std::vector<double> *SentenceLoglikelihoods)
 {
   int WHPYLMContextLenght = LanguageModel.GetWHPYLMOrder() - 1;
+  std::vector<double> Loglikelihoods = LanguageModel.WordSequencesLoglikelihoods(Sentences, NumThreads);
+  // summed in sentence order, so that the result does not depend on the
+  // number of threads
   double LoglikelihoodSum = 0;
   int NumWords = 0;
-  for (const std::vector<int> &Sentence : Sentences) {
-    LoglikelihoodSum += LanguageModel.WordSequenceLoglikelihood(Sentence);
-    NumWords += Sentence.size() - WHPYLMContextLenght;
+  for (std::size_t IdxSentence = 0; IdxSentence < Sentences.size(); ++IdxSentence) {
+    LoglikelihoodSum += Loglikelihoods[IdxSentence];
+    NumWords += Sentences[IdxSentence].size() - WHPYLMContextLenght;
+  }
+  if (SentenceLoglikelihoods != nullptr) {
+    *SentenceLoglikelihoods = std::move(Loglikelihoods);
   }
   std::cout << std::setprecision(2) << std::fixed << " Perplexity: " << exp(-LoglikelihoodSum / NumWords) << std::endl << std::endl;
 }
@@ -149,6 +156,17 @@ void DebugLib::PrintLanguageModelStats(const NHPYLM &LanguageModel)
   std::cout << std::endl << std::endl;
 }
 
+void DebugLib::PrintPeakMemoryUsage(const std::string &Description)
+{
+  // ru_maxrss is given in kilobytes on linux
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage) != 0) {
+    return;
+  }
+  std::cout << " " << Description << ": "
+            << Usage.ru_maxrss / 1024 << " MB" << std::endl;
+}
+
 void DebugLib::PrintVectorOfInts(const std::vector< int > &VectorOfInts, int Width, const std::string &Description, const std::string &Postfix)
 {
   std::cout << Description;
@@ -276,8 +294,8 @@ void DebugLib::GenerateSentencesOfWordsFromCharLM(
   const NHPYLM &LanguageModel)
 {
   // Id2 Character sequence vector for printing
-  std::vector<std::string> Id2CharacterSequenceVector(
-    LanguageModel.GetId2CharacterSequenceVector());
+  const std::vector<std::string> &Id2CharacterSequenceVector =
+    LanguageModel.GetId2CharacterSequenceVector();
 
   // generate sentences of words from the Character language model
   std::vector<std::vector<int> > GeneratedSentencesFromCHPYLM = LanguageModel.Generate("CHPYLM", 100000, -1, NULL);
@@ -300,7 +318,7 @@ void DebugLib::GenerateSentencesOfWordsFromWordLM(
   const NHPYLM &LanguageModel, int SentEndWordId)
 {
   // Id2 word sequence vector for printing
-  std::vector<std::string> Id2WordSequenceVector(LanguageModel.GetId2CharacterSequenceVector());
+  const std::vector<std::string> &Id2WordSequenceVector = LanguageModel.GetId2CharacterSequenceVector();
 
   // generate sentences of words from the word language model
   std::vector<std::vector<int> > GeneratedSentencesFromWHPYLM = LanguageModel.Generate("WHPYLM", 10000, SentEndWordId, NULL);
@@ -95,15 +95,25 @@ public:
     const std::vector<int> &LexiconCorrNFoundNRef
   );
   
+  // print perplexity of the sentences calculated with NumThreads threads,
+  // the log likelihood of each sentence is returned in SentenceLoglikelihoods
+  // if given
   static void PrintSentencesPerplexity(
     const std::vector<std::vector<int> > &Sentences,
-    const NHPYLM &LanguageModel
+    const NHPYLM &LanguageModel,
+    unsigned int NumThreads = 1,
+    std::vector<double> *SentenceLoglikelihoods = nullptr
   );
   
   static void PrintLanguageModelStats(
     const NHPYLM &LanguageModel
   );
   
+  // print the peak resident memory of the process so far
+  static void PrintPeakMemoryUsage(
+    const std::string &Description
+  );
+  
   static void PrintVectorOfInts(
     const std::vector<int> &VectorOfInts,
     int Width,
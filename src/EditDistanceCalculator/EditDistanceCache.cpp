@@ -0,0 +1,108 @@
+// ----------------------------------------------------------------------------
+/**
+   File: EditDistanceCache.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <FNV1aHash.hpp>
+#include "EditDistanceCache.hpp"
+
+EditDistanceCache::EditDistanceCache() :
+  InsDelSubCorrNFoundNRef(6, 0),
+  NumChangedSentences(0)
+{
+}
+
+
+uint64_t EditDistanceCache::GetSentenceHash(const std::vector<int> &InputSentence, const std::vector<int> &ReferenceSentence, const std::vector<std::string> &Id2CharacterSequenceVector)
+{
+  // hash over the spellings, each terminated by a zero byte and each
+  // sentence by a one byte
+  FNV1aHash Hash;
+  auto HashSentence = [&](const std::vector<int> &Sentence) {
+    for (int Id : Sentence) {
+      Hash.Update(Id2CharacterSequenceVector.at(Id));
+      Hash.Update(0);
+    }
+    Hash.Update(1);
+  };
+  HashSentence(InputSentence);
+  HashSentence(ReferenceSentence);
+  return Hash.GetHash() == 0 ? 1 : Hash.GetHash();
+}
+
+
+void EditDistanceCache::Resize(std::size_t NumSentences)
+{
+  if (SentenceHashes.size() != NumSentences) {
+    SentenceHashes.assign(NumSentences, 0);
+    SentenceCounts.assign(NumSentences, std::vector<int>(6, 0));
+    InsDelSubCorrNFoundNRef.assign(6, 0);
+  }
+  NumChangedSentences = 0;
+}
+
+
+bool EditDistanceCache::IsCached(std::size_t IdxSentence, uint64_t Hash) const
+{
+  return SentenceHashes[IdxSentence] == Hash;
+}
+
+
+void EditDistanceCache::Update(std::size_t IdxSentence, uint64_t Hash, const std::vector<int> &Counts)
+{
+  for (std::size_t IdxCount = 0; IdxCount < InsDelSubCorrNFoundNRef.size(); ++IdxCount) {
+    InsDelSubCorrNFoundNRef[IdxCount] += Counts[IdxCount] - SentenceCounts[IdxSentence][IdxCount];
+  }
+  if (SentenceHashes[IdxSentence] != Hash) {
+    ++NumChangedSentences;
+  }
+  SentenceHashes[IdxSentence] = Hash;
+  SentenceCounts[IdxSentence] = Counts;
+}
+
+
+const std::vector<int> &EditDistanceCache::GetInsDelSubCorrNFoundNRef() const
+{
+  return InsDelSubCorrNFoundNRef;
+}
+
+
+std::size_t EditDistanceCache::GetNumChangedSentences() const
+{
+  return NumChangedSentences;
+}
@@ -0,0 +1,106 @@
+// ----------------------------------------------------------------------------
+/**
+   File: EditDistanceCache.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: cache of per sentence edit distance counts across iterations
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _EDITDISTANCECACHE_HPP_
+#define _EDITDISTANCECACHE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* cache of the edit distance counts of each sentence across iterations.
+   Sentences are identified by a hash of the spellings of their input and
+   reference symbols, so that changed word ids do not invalidate entries.
+   The corpus totals are updated by the differences of changed sentences */
+class EditDistanceCache {
+  std::vector<uint64_t> SentenceHashes;            // hash of each cached sentence (0: not cached)
+  std::vector<std::vector<int> > SentenceCounts;   // InsDelSubCorrNFoundNRef of each sentence
+  std::vector<int> InsDelSubCorrNFoundNRef;        // corpus totals
+  std::size_t NumChangedSentences;                 // number of sentences updated since last call of Resize
+
+public:
+  /* constructor */
+  EditDistanceCache();
+
+
+  /* interface */
+  // hash of the spellings of input and reference sentence
+  static uint64_t GetSentenceHash(
+    const std::vector<int> &InputSentence,
+    const std::vector<int> &ReferenceSentence,
+    const std::vector<std::string> &Id2CharacterSequenceVector
+  );
+
+  // prepare cache for NumSentences sentences, clearing it if the number of
+  // sentences changed
+  void Resize(
+    std::size_t NumSentences
+  );
+
+  // true if the counts of sentence IdxSentence with hash Hash are cached
+  bool IsCached(
+    std::size_t IdxSentence,
+    uint64_t Hash
+  ) const;
+
+  // replace the counts of sentence IdxSentence and update the totals
+  void Update(
+    std::size_t IdxSentence,
+    uint64_t Hash,
+    const std::vector<int> &Counts
+  );
+
+  const std::vector<int> &GetInsDelSubCorrNFoundNRef() const;
+
+  std::size_t GetNumChangedSentences() const;
+};
+
+#endif
@@ -43,25 +43,31 @@
 // ----------------------------------------------------------------------------
 #include <fst/compose.h>
 #include <fst/shortest-path.h>
-#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <ParallelFor.hpp>
 #include "EditDistanceCalculator.hpp"
 #include "definitions.hpp"
 
-EditDistanceCalculator::EditDistanceCalculator(unsigned int NumThreads_, const std::vector<std::string> &FileNames_, const std::string &Prefix_, bool OutputEditOperations_) :
+EditDistanceCalculator::EditDistanceCalculator(unsigned int NumThreads_, const std::vector<std::string> &FileNames_, const std::string &Prefix_, bool OutputEditOperations_, EditDistanceCache *Cache_, bool ConsolidateEditOperations_) :
   NumThreads(NumThreads_),
   InsDelSubCorrNFoundNRef(6, 0),
   FileNames(FileNames_),
   Prefix(Prefix_),
-  OutputEditOperations(OutputEditOperations_)
+  OutputEditOperations(OutputEditOperations_),
+  ConsolidateEditOperations(ConsolidateEditOperations_),
+  Cache(Cache_)
 {
 }
 
 
-void EditDistanceCalculator::SetInputFstsAndReferenceSentences(const std::vector<fst::VectorFst< fst::StdArc > > &InputFsts_, const std::vector<std::vector< int > > &ReferenceSentences_, const vector< int > &InputAndOutputIds_, const vector< string > &Id2CharacterSequenceVector_)
+void EditDistanceCalculator::SetInputFstsAndReferenceSentences(const InputFstFunction &GetInputFst, const std::vector<std::vector< int > > &ReferenceSentences_, const vector< int > &InputAndOutputIds_, const vector< string > &Id2CharacterSequenceVector_)
 {
   // initialize some variables
-  NumSentences = InputFsts_.size();
-  InputFsts = InputFsts_;
+  NumSentences = ReferenceSentences_.size();
   ReferenceSentences = ReferenceSentences_;
   InputAndOutputIds = InputAndOutputIds_;
   Id2CharacterSequenceVector = Id2CharacterSequenceVector_;
@@ -76,7 +82,7 @@ void EditDistanceCalculator::SetInputFstsAndReferenceSentences(const std::vector
   BuildLeftAndRightFactors();
 
   // calculate edit Calculate edit distance
-  CalculateEditDistance();
+  CalculateEditDistance(GetInputFst);
 }
 
 
@@ -94,22 +100,13 @@ void EditDistanceCalculator::SetInputAndReferenceSentences(const vector< vector<
 //   std::cout << "Setting Id2CharacterSequenceVector" << std::endl;
   Id2CharacterSequenceVector = Id2CharacterSequenceVector_;
 
-  // build input and reference fsts
-//   std::cout << "build input and reference fsts" << std::endl;
-  InputFsts.resize(NumSentences);
-  ReferenceFsts.resize(NumSentences);
-  for (unsigned int IdxSentence = 0; IdxSentence < NumSentences; IdxSentence++) {
-    BuildFstFromIdSequence(InputSentences.at(IdxSentence), &InputFsts.at(IdxSentence));
-    BuildFstFromIdSequence(ReferenceSentences.at(IdxSentence), &ReferenceFsts.at(IdxSentence));
-  }
-
-  // build left and right factors
-//   std::cout << "build left and right factors" << std::endl;
-  BuildLeftAndRightFactors();
+  // sentences are aligned directly by dynamic programming, the factor
+  // transducers are only needed for input fsts
+  std::sort(InputAndOutputIds.begin(), InputAndOutputIds.end());
 
   // calculate edit distance
 //   std::cout << "calculate edit distance" << std::endl;
-  CalculateEditDistance();
+  CalculateEditDistance(nullptr);
 }
 
 
@@ -159,51 +156,97 @@ void EditDistanceCalculator::BuildLeftAndRightFactors()
 }
 
 
-void EditDistanceCalculator::CalculateEditDistance()
+void EditDistanceCalculator::CalculateEditDistance(const InputFstFunction &GetInputFst)
 {
-  ResultFsts.resize(NumSentences);
-
-//   std::cout << "initialize threads and variables" << std::endl;
-  std::vector<std::thread> Threads(NumThreads - 1);
-  int IdxRangeStep = std::ceil(NumSentences / static_cast<double>(NumThreads));
-  std::vector<std::vector<int> > InsDelSubCorrNFoundNRefPerIdxRange(NumThreads - 1, std::vector<int>(6, 0));
-
-  std::vector<fst::VectorFst<fst::StdArc> > RightFactors(NumThreads - 1, RightFactor);
-  std::vector<fst::VectorFst<fst::StdArc> > LeftFactors(NumThreads - 1, LeftFactor);
-//   std::cout << "starting threads: ";
-  for (unsigned int IdxRange = 0; IdxRange < (NumThreads - 1); ++IdxRange) {
-//     std::cout << IdxRange << " ";
-    unsigned int StartIdx = IdxRange * IdxRangeStep;
-    unsigned int EndIdx = std::min((IdxRange + 1) * IdxRangeStep, NumSentences);
-    Threads[IdxRange] = std::thread(CalculateEditDistanceIdxRange, &InputFsts, &ReferenceFsts, &ResultFsts, &LeftFactors.at(IdxRange), &RightFactors.at(IdxRange), &InsDelSubCorrNFoundNRefPerIdxRange.at(IdxRange), StartIdx, EndIdx, &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+  // sentences are handed out one by one to the threads, as their alignment
+  // times differ a lot
+  std::size_t NumWorkerThreads = GetNumWorkerThreads(NumThreads, NumSentences);
+  std::vector<std::vector<int> > InsDelSubCorrNFoundNRefPerThread(NumWorkerThreads, std::vector<int>(6, 0));
+
+  // the factor transducers are only needed for input fsts. Every thread
+  // composes with its own copies
+  std::vector<fst::VectorFst<fst::StdArc> > LeftFactors;
+  std::vector<fst::VectorFst<fst::StdArc> > RightFactors;
+  if (GetInputFst) {
+    for (std::size_t IdxThread = 0; IdxThread < NumWorkerThreads; ++IdxThread) {
+      LeftFactors.push_back(DeepCopyFst(LeftFactor));
+      RightFactors.push_back(DeepCopyFst(RightFactor));
+    }
   }
-//   std::cout << std::endl << "starting final thread" << std::endl;
-  CalculateEditDistanceIdxRange(&InputFsts, &ReferenceFsts, &ResultFsts, &LeftFactor, &RightFactor, &InsDelSubCorrNFoundNRef, (NumThreads - 1) * IdxRangeStep, std::min(NumThreads * IdxRangeStep, NumSentences), &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
-
-//   std::cout << "wating for threads and collecting data: " << std::endl;
-  for (unsigned int IdxRange = 0; IdxRange < (NumThreads - 1); ++IdxRange) {
-//     std::cout << IdxRange << ":";
-    Threads[IdxRange].join();
-//     std::cout << IdxRange;
-    InsDelSubCorrNFoundNRef[0] += InsDelSubCorrNFoundNRefPerIdxRange[IdxRange][0];
-    InsDelSubCorrNFoundNRef[1] += InsDelSubCorrNFoundNRefPerIdxRange[IdxRange][1];
-    InsDelSubCorrNFoundNRef[2] += InsDelSubCorrNFoundNRefPerIdxRange[IdxRange][2];
-    InsDelSubCorrNFoundNRef[3] += InsDelSubCorrNFoundNRefPerIdxRange[IdxRange][3];
-    InsDelSubCorrNFoundNRef[4] += InsDelSubCorrNFoundNRefPerIdxRange[IdxRange][4];
-    InsDelSubCorrNFoundNRef[5] += InsDelSubCorrNFoundNRefPerIdxRange[IdxRange][5];
-//     std::cout << "(ok) ";
+
+  // with a cache only sentences that changed since the last calculation
+  // are aligned (all if edit operations are written)
+  bool UseCache = (Cache != nullptr) && !GetInputFst;
+  std::vector<uint64_t> SentenceHashes;
+  std::vector<std::vector<int> > SentenceCounts;
+  std::vector<char> IsSentenceAligned;
+  if (UseCache) {
+    Cache->Resize(NumSentences);
+    SentenceHashes.resize(NumSentences);
+    SentenceCounts.resize(NumSentences);
+    IsSentenceAligned.resize(NumSentences, false);
   }
-}
 
-void EditDistanceCalculator::CalculateEditDistanceIdxRange(const std::vector<fst::VectorFst< fst::StdArc > > *InputFsts, const std::vector<fst::VectorFst< fst::StdArc > > *ReferenceFsts, std::vector<fst::VectorFst< fst::StdArc > > *ResultFsts, const fst::VectorFst< fst::StdArc > *LeftFactor, const fst::VectorFst< fst::StdArc > *RightFactor, vector< int > *InsDelSubCorrNFoundNRef, unsigned int StartIdx, unsigned int EndIdx, const std::vector<std::string> *Id2CharacterSequenceVector, const std::vector<std::string> *Filenames, const std::string *Prefix, bool OutputEditOperations)
-{
-  for (unsigned int IdxLattice = StartIdx; IdxLattice < EndIdx; ++IdxLattice) {
-    CalculateEditDistanceSingleIdx(InputFsts->at(IdxLattice), ReferenceFsts->at(IdxLattice), &ResultFsts->at(IdxLattice), *LeftFactor, *RightFactor, InsDelSubCorrNFoundNRef, Id2CharacterSequenceVector, &Filenames->at(IdxLattice), Prefix, OutputEditOperations);
+  // the edit operations of a sentence are collected in a string stream and
+  // written at once, either to a file per sentence or to the consolidated
+  // edit operations file of all sentences
+  std::unique_ptr<EditOperationsFile> ConsolidatedEditOperations;
+  if (OutputEditOperations && ConsolidateEditOperations) {
+    ConsolidatedEditOperations.reset(new EditOperationsFile(Prefix + "EditOperations"));
+  }
+  auto WriteEditOperations = [&](unsigned int IdxSentence, const std::ostringstream &EditOperationsStream) {
+    if (ConsolidatedEditOperations) {
+      ConsolidatedEditOperations->Write(IdxSentence, FileNames.at(IdxSentence), EditOperationsStream.str());
+    } else {
+      std::ofstream OutputFile(Prefix + FileNames.at(IdxSentence));
+      OutputFile << EditOperationsStream.str();
+    }
+  };
+
+  ParallelForWithThreadIdx(NumThreads, NumSentences, [&](std::size_t IdxSentence, std::size_t IdxThread) {
+    std::ostringstream EditOperationsStream;
+    std::ostream *EditOperationsOutput = OutputEditOperations ? &EditOperationsStream : nullptr;
+    if (UseCache) {
+      SentenceHashes[IdxSentence] = EditDistanceCache::GetSentenceHash(InputSentences.at(IdxSentence), ReferenceSentences.at(IdxSentence), Id2CharacterSequenceVector);
+      if (!OutputEditOperations && Cache->IsCached(IdxSentence, SentenceHashes[IdxSentence])) {
+        return;
+      }
+      SentenceCounts[IdxSentence].assign(6, 0);
+      CalculateEditDistanceOfSentencesSingleIdx(InputSentences.at(IdxSentence), ReferenceSentences.at(IdxSentence), InputAndOutputIds, &SentenceCounts[IdxSentence], &Id2CharacterSequenceVector, EditOperationsOutput);
+      IsSentenceAligned[IdxSentence] = true;
+    } else if (!GetInputFst) {
+      CalculateEditDistanceOfSentencesSingleIdx(InputSentences.at(IdxSentence), ReferenceSentences.at(IdxSentence), InputAndOutputIds, &InsDelSubCorrNFoundNRefPerThread.at(IdxThread), &Id2CharacterSequenceVector, EditOperationsOutput);
+    } else {
+      fst::VectorFst<fst::StdArc> InputFst;
+      fst::VectorFst<fst::StdArc> ResultFst;
+      GetInputFst(IdxSentence, &InputFst);
+      CalculateEditDistanceSingleIdx(InputFst, ReferenceFsts.at(IdxSentence), &ResultFst, LeftFactors.at(IdxThread), RightFactors.at(IdxThread), &InsDelSubCorrNFoundNRefPerThread.at(IdxThread), &Id2CharacterSequenceVector, EditOperationsOutput);
+    }
+    if (OutputEditOperations) {
+      WriteEditOperations(IdxSentence, EditOperationsStream);
+    }
+  });
+
+  if (UseCache) {
+    // update the corpus totals by the differences of the aligned sentences
+    for (unsigned int IdxSentence = 0; IdxSentence < NumSentences; ++IdxSentence) {
+      if (IsSentenceAligned[IdxSentence]) {
+        Cache->Update(IdxSentence, SentenceHashes[IdxSentence], SentenceCounts[IdxSentence]);
+      }
+    }
+    InsDelSubCorrNFoundNRef = Cache->GetInsDelSubCorrNFoundNRef();
+    return;
+  }
+
+  for (const std::vector<int> &InsDelSubCorrNFoundNRefOfThread : InsDelSubCorrNFoundNRefPerThread) {
+    for (unsigned int IdxCount = 0; IdxCount < InsDelSubCorrNFoundNRef.size(); ++IdxCount) {
+      InsDelSubCorrNFoundNRef[IdxCount] += InsDelSubCorrNFoundNRefOfThread[IdxCount];
+    }
   }
 }
 
 
-void EditDistanceCalculator::CalculateEditDistanceSingleIdx(const fst::VectorFst<fst::StdArc> &InputFst, const fst::VectorFst<fst::StdArc> &ReferenceFst, fst::VectorFst<fst::StdArc> *ResultFst, const fst::VectorFst<fst::StdArc> &LeftFactor, const fst::VectorFst<fst::StdArc> &RightFactor, std::vector<int> *InsDelSubCorrNFoundNRef, const std::vector<std::string> *Id2CharacterSequenceVector, const std::string *FileName, const std::string *Prefix, bool OutputEditOperations)
+void EditDistanceCalculator::CalculateEditDistanceSingleIdx(const fst::VectorFst<fst::StdArc> &InputFst, const fst::VectorFst<fst::StdArc> &ReferenceFst, fst::VectorFst<fst::StdArc> *ResultFst, const fst::VectorFst<fst::StdArc> &LeftFactor, const fst::VectorFst<fst::StdArc> &RightFactor, std::vector<int> *InsDelSubCorrNFoundNRef, const std::vector<std::string> *Id2CharacterSequenceVector, std::ostream *EditOperationsStream)
 {
   fst::ComposeFstOptions<fst::StdArc> copt;
   copt.gc_limit = 0;
@@ -223,49 +266,131 @@ void EditDistanceCalculator::CalculateEditDistanceSingleIdx(const fst::VectorFst
 //   fst::ArcMapFst<fst::StdArc, fst::LogArc, fst::StdToLogMapper > StdToLog4(*ResultFst, fst::StdToLogMapper());
 //   FileReader::PrintFST("lattice_debug/Result.0", *Id2CharacterSequenceVector, fst::VectorFst<fst::LogArc>(StdToLog4), true, NAMESANDIDS);
 
-  std::ofstream myfile;
-  if (OutputEditOperations) {
-    myfile.open(*Prefix + *FileName);
-  }
-
-  // get insertions, deletions and substitutions
+  std::vector<std::pair<int, int> > EditOperations;
   for (fst::StateIterator<fst::Fst<fst::StdArc> > siter(*ResultFst); !siter.Done(); siter.Next()) {
     for (fst::ArcIterator<fst::Fst<fst::StdArc> > aiter(*ResultFst, siter.Value()); !aiter.Done(); aiter.Next()) {
-      if (aiter.Value().ilabel == EPS_SYMBOLID) {
-        (*InsDelSubCorrNFoundNRef)[0]++;
-        (*InsDelSubCorrNFoundNRef)[4]++;
-        if (OutputEditOperations) {
-//           std::cout << "i:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-          myfile << "i:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-        }
-      } else if (aiter.Value().olabel == EPS_SYMBOLID) {
-        (*InsDelSubCorrNFoundNRef)[1]++;
-        (*InsDelSubCorrNFoundNRef)[5]++;
-        if (OutputEditOperations) {
-//           std::cout << "d:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-          myfile << "d:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-        }
-      } else if (aiter.Value().ilabel != aiter.Value().olabel) {
-        (*InsDelSubCorrNFoundNRef)[2]++;
-        (*InsDelSubCorrNFoundNRef)[4]++;
-        (*InsDelSubCorrNFoundNRef)[5]++;
-        if (OutputEditOperations) {
-//           std::cout << "s:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-          myfile << "s:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-        }
-      } else {
-        (*InsDelSubCorrNFoundNRef)[3]++;
-        (*InsDelSubCorrNFoundNRef)[4]++;
-        (*InsDelSubCorrNFoundNRef)[5]++;
-        if (OutputEditOperations) {
-//           std::cout << "c:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-          myfile << "c:[" << aiter.Value().ilabel << "," << Id2CharacterSequenceVector->at(aiter.Value().ilabel) << " --> " << aiter.Value().olabel << "," << Id2CharacterSequenceVector->at(aiter.Value().olabel) << "]" << std::endl;
-        }
+      EditOperations.push_back(std::make_pair(aiter.Value().ilabel, aiter.Value().olabel));
+    }
+  }
+  AccumulateEditOperations(EditOperations, InsDelSubCorrNFoundNRef, Id2CharacterSequenceVector, EditOperationsStream);
+}
+
+
+void EditDistanceCalculator::CalculateEditDistanceOfSentencesSingleIdx(const std::vector<int> &InputSentence, const std::vector<int> &ReferenceSentence, const std::vector<int> &InputAndOutputIds, vector< int > *InsDelSubCorrNFoundNRef, const std::vector<std::string> *Id2CharacterSequenceVector, std::ostream *EditOperationsStream)
+{
+  auto IsKnownId = [&InputAndOutputIds](int Id) {
+    return std::binary_search(InputAndOutputIds.begin(), InputAndOutputIds.end(), Id);
+  };
+
+  // as with the factor transducers, there is no alignment if a sentence
+  // contains ids that are not in InputAndOutputIds
+  std::vector<std::pair<int, int> > EditOperations;
+  if (std::all_of(InputSentence.begin(), InputSentence.end(), IsKnownId) &&
+      std::all_of(ReferenceSentence.begin(), ReferenceSentence.end(), IsKnownId)) {
+    AlignSentences(InputSentence, ReferenceSentence, &EditOperations);
+  }
+  AccumulateEditOperations(EditOperations, InsDelSubCorrNFoundNRef, Id2CharacterSequenceVector, EditOperationsStream);
+}
+
+
+void EditDistanceCalculator::AlignSentences(const std::vector<int> &InputSentence, const std::vector<int> &ReferenceSentence, std::vector<std::pair<int, int> > *EditOperations)
+{
+  // costs of the factor transducers (0.5 and 0.500001) scaled to integers,
+  // so that substitutions are preferred to an insertion and a deletion
+  // but equally long alignments with fewer substitutions win
+  const int64_t InsDelCost = 500000;
+  const int64_t SubCost = 500001;
+  enum Operation : unsigned char {DIAGONAL, DELETION, INSERTION};
+
+  std::size_t NumReference = ReferenceSentence.size();
+  std::size_t NumInput = InputSentence.size();
+  std::size_t NumColumns = NumInput + 1;
+  std::vector<int64_t> PreviousCosts(NumColumns);
+  std::vector<int64_t> Costs(NumColumns);
+  std::vector<unsigned char> Operations((NumReference + 1) * NumColumns, INSERTION);
+
+  for (std::size_t IdxInput = 0; IdxInput <= NumInput; ++IdxInput) {
+    Costs[IdxInput] = IdxInput * InsDelCost;
+  }
+  for (std::size_t IdxReference = 1; IdxReference <= NumReference; ++IdxReference) {
+    Costs.swap(PreviousCosts);
+    Costs[0] = IdxReference * InsDelCost;
+    Operations[IdxReference * NumColumns] = DELETION;
+    for (std::size_t IdxInput = 1; IdxInput <= NumInput; ++IdxInput) {
+      int64_t Cost = PreviousCosts[IdxInput - 1] +
+        (ReferenceSentence[IdxReference - 1] == InputSentence[IdxInput - 1] ? 0 : SubCost);
+      unsigned char BestOperation = DIAGONAL;
+      if (PreviousCosts[IdxInput] + InsDelCost < Cost) {
+        Cost = PreviousCosts[IdxInput] + InsDelCost;
+        BestOperation = DELETION;
+      }
+      if (Costs[IdxInput - 1] + InsDelCost < Cost) {
+        Cost = Costs[IdxInput - 1] + InsDelCost;
+        BestOperation = INSERTION;
       }
+      Costs[IdxInput] = Cost;
+      Operations[IdxReference * NumColumns + IdxInput] = BestOperation;
     }
   }
-  if (OutputEditOperations) {
-    myfile.close();
+
+  // trace back from the end of both sentences
+  EditOperations->clear();
+  EditOperations->reserve(NumReference + NumInput);
+  std::size_t IdxReference = NumReference;
+  std::size_t IdxInput = NumInput;
+  while (IdxReference > 0 || IdxInput > 0) {
+    switch (Operations[IdxReference * NumColumns + IdxInput]) {
+      case DIAGONAL:
+        --IdxReference;
+        --IdxInput;
+        EditOperations->push_back(std::make_pair(ReferenceSentence[IdxReference], InputSentence[IdxInput]));
+        break;
+      case DELETION:
+        --IdxReference;
+        EditOperations->push_back(std::make_pair(ReferenceSentence[IdxReference], static_cast<int>(EPS_SYMBOLID)));
+        break;
+      default:
+        --IdxInput;
+        EditOperations->push_back(std::make_pair(static_cast<int>(EPS_SYMBOLID), InputSentence[IdxInput]));
+        break;
+    }
+  }
+}
+
+
+void EditDistanceCalculator::AccumulateEditOperations(const std::vector<std::pair<int, int> > &EditOperations, std::vector<int> *InsDelSubCorrNFoundNRef, const std::vector<std::string> *Id2CharacterSequenceVector, std::ostream *EditOperationsStream)
+{
+  // get insertions, deletions and substitutions
+  for (const std::pair<int, int> &EditOperation : EditOperations) {
+    int ilabel = EditOperation.first;
+    int olabel = EditOperation.second;
+    if (ilabel == EPS_SYMBOLID) {
+      (*InsDelSubCorrNFoundNRef)[0]++;
+      (*InsDelSubCorrNFoundNRef)[4]++;
+      if (EditOperationsStream != nullptr) {
+        *EditOperationsStream << "i:[" << ilabel << "," << Id2CharacterSequenceVector->at(ilabel) << " --> " << olabel << "," << Id2CharacterSequenceVector->at(olabel) << "]\n";
+      }
+    } else if (olabel == EPS_SYMBOLID) {
+      (*InsDelSubCorrNFoundNRef)[1]++;
+      (*InsDelSubCorrNFoundNRef)[5]++;
+      if (EditOperationsStream != nullptr) {
+        *EditOperationsStream << "d:[" << ilabel << "," << Id2CharacterSequenceVector->at(ilabel) << " --> " << olabel << "," << Id2CharacterSequenceVector->at(olabel) << "]\n";
+      }
+    } else if (ilabel != olabel) {
+      (*InsDelSubCorrNFoundNRef)[2]++;
+      (*InsDelSubCorrNFoundNRef)[4]++;
+      (*InsDelSubCorrNFoundNRef)[5]++;
+      if (EditOperationsStream != nullptr) {
+        *EditOperationsStream << "s:[" << ilabel << "," << Id2CharacterSequenceVector->at(ilabel) << " --> " << olabel << "," << Id2CharacterSequenceVector->at(olabel) << "]\n";
+      }
+    } else {
+      (*InsDelSubCorrNFoundNRef)[3]++;
+      (*InsDelSubCorrNFoundNRef)[4]++;
+      (*InsDelSubCorrNFoundNRef)[5]++;
+      if (EditOperationsStream != nullptr) {
+        *EditOperationsStream << "c:[" << ilabel << "," << Id2CharacterSequenceVector->at(ilabel) << " --> " << olabel << "," << Id2CharacterSequenceVector->at(olabel) << "]\n";
+      }
+    }
   }
 }
 
@@ -61,12 +61,19 @@
 #define _EDITDISTANCECALCULATOR_HPP_
 
 #include <fst/vector-fst.h>
+#include <functional>
+#include "EditDistanceCache.hpp"
+#include "EditOperationsFile.hpp"
 
 /* class to calculate edit distance */
 class EditDistanceCalculator {
+protected:
+  // writes the input fst of sentence Idx to its second argument
+  typedef std::function<void(unsigned int, fst::VectorFst<fst::StdArc> *)> InputFstFunction;
+
+private:
   unsigned int NumSentences;
   unsigned int NumThreads;
-  std::vector<fst::VectorFst<fst::StdArc> > InputFsts;
   std::vector<std::vector<int> > InputSentences;
   std::vector<fst::VectorFst<fst::StdArc> > ReferenceFsts;
   std::vector<std::vector<int> > ReferenceSentences;
@@ -77,7 +84,6 @@ class EditDistanceCalculator {
   int DeletionId;
   fst::VectorFst<fst::StdArc> LeftFactor;
   fst::VectorFst<fst::StdArc> RightFactor;
-  std::vector<fst::VectorFst<fst::StdArc> > ResultFsts;
 
   std::vector<std::string> Id2CharacterSequenceVector;
 
@@ -85,28 +91,48 @@ class EditDistanceCalculator {
   std::vector<std::string> FileNames;
   std::string Prefix;
   bool OutputEditOperations;
+  bool ConsolidateEditOperations; // write edit operations of all sentences to one indexed file
+  EditDistanceCache *Cache; // per sentence counts of previous calculations (only for sentences)
 
 
   /* internal functions */
   void BuildLeftAndRightFactors();
 
-  void CalculateEditDistance();
+  // align the input fsts given by GetInputFst (or the input sentences if
+  // it is empty) to the reference
+  void CalculateEditDistance(
+    const InputFstFunction &GetInputFst
+  );
 
-  static inline void CalculateEditDistanceIdxRange(
-    const vector< fst::VectorFst< fst::StdArc > > *InputFsts,
-    const vector< fst::VectorFst< fst::StdArc > > *ReferenceFsts,
-    vector< fst::VectorFst< fst::StdArc > > *ResultFsts,
-    const fst::VectorFst< fst::StdArc > *LeftFactor,
-    const fst::VectorFst< fst::StdArc > *RightFactor,
+  static inline void CalculateEditDistanceOfSentencesSingleIdx(
+    const vector< int > &InputSentence,
+    const vector< int > &ReferenceSentence,
+    const vector< int > &InputAndOutputIds,
     vector< int > *InsDelSubCorrNFoundNRef,
-    unsigned int StartIdx,
-    unsigned int EndIdx,
     const vector< string > *Id2CharacterSequenceVector,
-    const vector< string > *Filenames,
-    const string *Prefix,
-    bool OutputEditOperations
+    std::ostream *EditOperationsStream
   );
-  
+
+  // align input and reference sentence by dynamic programming with the
+  // costs of the factor transducers and return the edit operations as
+  // pairs of reference and input label, in the order of the states of
+  // the shortest path fst (last operation first). Ties between alignments
+  // of equal cost are not necessarily broken as by fst::ShortestPath
+  static inline void AlignSentences(
+    const vector< int > &InputSentence,
+    const vector< int > &ReferenceSentence,
+    vector< pair< int, int > > *EditOperations
+  );
+
+  // count the edit operations given as pairs of reference and input label
+  // and write them to EditOperationsStream if given
+  static inline void AccumulateEditOperations(
+    const vector< pair< int, int > > &EditOperations,
+    vector< int > *InsDelSubCorrNFoundNRef,
+    const vector< string > *Id2CharacterSequenceVector,
+    std::ostream *EditOperationsStream
+  );
+
   static inline void BuildFstFromIdSequence(
     const vector< int > &IdSequence,
     fst::VectorFst< fst::StdArc > *Fst
@@ -120,9 +146,7 @@ class EditDistanceCalculator {
     const fst::VectorFst< fst::StdArc > &RightFactor,
     vector< int > *InsDelSubCorrNFoundNRef,
     const vector< string > *Id2CharacterSequenceVector,
-    const string *FileName,
-    const string *Prefix,
-    bool OutputEditOperations);
+    std::ostream *EditOperationsStream);
 
 protected:
   /* interface for derived classes */
@@ -133,8 +157,10 @@ protected:
     const std::vector<std::string> &Id2CharacterSequenceVector_
   );
   
+  // the input fsts are requested sentence by sentence from GetInputFst
+  // while aligning, so that they are never held all at once
   void SetInputFstsAndReferenceSentences(
-    const vector< fst::VectorFst< fst::StdArc > > &InputFsts_,
+    const InputFstFunction &GetInputFst,
     const vector< vector< int > > &ReferenceSentence,
     const vector< int > &InputAndOutputIds_,
     const vector< string > &Id2CharacterSequenceVector_
@@ -146,7 +172,9 @@ public:
     unsigned int NumThreads_,
     const vector< string > &FileNames_,
     const string &Prefix_,
-    bool OutputEditOperations_
+    bool OutputEditOperations_,
+    EditDistanceCache *Cache_ = nullptr,
+    bool ConsolidateEditOperations_ = false
   );
   
   /* interface */
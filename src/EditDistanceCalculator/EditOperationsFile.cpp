@@ -0,0 +1,150 @@
+// ----------------------------------------------------------------------------
+/**
+   File: EditOperationsFile.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "EditOperationsFile.hpp"
+
+EditOperationsFile::EditOperationsFile(const std::string &FileName_, std::size_t BufferSize_) :
+  FileName(FileName_),
+  DataFile(FileName_, std::ios::binary),
+  BufferSize(BufferSize_),
+  BufferOffset(0)
+{
+  if (!DataFile) {
+    throw std::runtime_error("Could not open edit operations file " + FileName);
+  }
+  Buffer.reserve(BufferSize);
+}
+
+
+EditOperationsFile::~EditOperationsFile()
+{
+  // a destructor must not throw, write errors are only reported
+  FlushBuffer();
+  DataFile.close();
+  if (!DataFile) {
+    std::cerr << "Warning: Could not write edit operations " << FileName
+              << std::endl;
+  }
+
+  std::ofstream IndexFile(FileName + ".idx");
+  std::ostringstream IndexStream;
+  for (std::size_t IdxEntry = 0; IdxEntry < Entries.size(); ++IdxEntry) {
+    if (HasEntry[IdxEntry]) {
+      IndexStream << Entries[IdxEntry].Name << "\t" << Entries[IdxEntry].Offset << "\t" << Entries[IdxEntry].Length << "\n";
+    }
+  }
+  IndexFile << IndexStream.str();
+  IndexFile.close();
+  if (!IndexFile) {
+    std::cerr << "Warning: Could not write edit operations index "
+              << FileName << ".idx" << std::endl;
+  }
+}
+
+
+void EditOperationsFile::FlushBuffer()
+{
+  DataFile.write(Buffer.data(), Buffer.size());
+  BufferOffset += Buffer.size();
+  Buffer.clear();
+}
+
+
+void EditOperationsFile::Write(std::size_t IdxEntry, const std::string &Name, const std::string &EditOperations)
+{
+  std::lock_guard<std::mutex> lck(mtx);
+  if (Buffer.size() + EditOperations.size() > BufferSize) {
+    FlushBuffer();
+  }
+  if (IdxEntry >= Entries.size()) {
+    Entries.resize(IdxEntry + 1);
+    HasEntry.resize(IdxEntry + 1, false);
+  }
+  Entries[IdxEntry].Name = Name;
+  Entries[IdxEntry].Offset = BufferOffset + Buffer.size();
+  Entries[IdxEntry].Length = EditOperations.size();
+  HasEntry[IdxEntry] = true;
+  if (EditOperations.size() > BufferSize) {
+    DataFile.write(EditOperations.data(), EditOperations.size());
+    BufferOffset += EditOperations.size();
+  } else {
+    Buffer.append(EditOperations);
+  }
+}
+
+
+std::vector<EditOperationsFile::Entry> EditOperationsFile::ReadIndex(const std::string &FileName)
+{
+  std::ifstream IndexFile(FileName + ".idx");
+  if (!IndexFile) {
+    throw std::runtime_error("Could not open edit operations index " + FileName + ".idx");
+  }
+
+  // names may contain tabs, offset and length are the last two fields
+  std::vector<Entry> Index;
+  std::string Line;
+  while (std::getline(IndexFile, Line)) {
+    std::size_t LengthPos = Line.rfind('\t');
+    std::size_t OffsetPos = (LengthPos == std::string::npos || LengthPos == 0) ? std::string::npos : Line.rfind('\t', LengthPos - 1);
+    if (OffsetPos == std::string::npos) {
+      throw std::runtime_error("Invalid line in edit operations index " + FileName + ".idx: " + Line);
+    }
+    Entry IndexEntry;
+    IndexEntry.Name = Line.substr(0, OffsetPos);
+    IndexEntry.Offset = std::stoull(Line.substr(OffsetPos + 1, LengthPos - OffsetPos - 1));
+    IndexEntry.Length = std::stoull(Line.substr(LengthPos + 1));
+    Index.push_back(IndexEntry);
+  }
+  return Index;
+}
+
+
+std::string EditOperationsFile::ReadEntry(const std::string &FileName, const Entry &IndexEntry)
+{
+  std::ifstream DataFile(FileName, std::ios::binary);
+  std::string EditOperations(IndexEntry.Length, '\0');
+  if (!DataFile.seekg(IndexEntry.Offset) || !DataFile.read(&EditOperations[0], IndexEntry.Length)) {
+    throw std::runtime_error("Could not read edit operations of " + IndexEntry.Name + " from " + FileName);
+  }
+  return EditOperations;
+}
@@ -0,0 +1,124 @@
+// ----------------------------------------------------------------------------
+/**
+   File: EditOperationsFile.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: consolidated, indexed file of edit operations
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _EDITOPERATIONSFILE_HPP_
+#define _EDITOPERATIONSFILE_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* single file holding the edit operations of all sentences of an edit
+   distance calculation. The edit operations of the sentences are appended
+   in the order they are calculated to a large buffer, which is written to
+   the data file when full. The index file (FileName + ".idx") lists name,
+   offset and length of each entry in sentence order and is written when
+   the file is destroyed */
+class EditOperationsFile {
+public:
+  /* entry of the index file */
+  struct Entry {
+    std::string Name;   // name of the entry (input file name)
+    uint64_t Offset;    // offset of the edit operations in the data file
+    uint64_t Length;    // length of the edit operations in bytes
+  };
+
+private:
+  std::string FileName;          // name of the data file
+  std::ofstream DataFile;        // data file
+  std::string Buffer;            // buffered data not written yet
+  std::size_t BufferSize;        // buffer size in bytes
+  uint64_t BufferOffset;         // offset of the buffer in the data file
+  std::vector<Entry> Entries;    // index entries by sentence index
+  std::vector<char> HasEntry;    // true if an entry was written for the sentence index
+  std::mutex mtx;                // mutex to allow writing from multiple threads
+
+
+  /* internal functions */
+  // write the buffer to the data file
+  void FlushBuffer();
+
+public:
+  /* constructor */
+  // open data file FileName for writing
+  EditOperationsFile(
+    const std::string &FileName_,
+    std::size_t BufferSize_ = 1 << 22
+  );
+
+  // write remaining data and the index file
+  ~EditOperationsFile();
+
+
+  /* interface */
+  // append the edit operations of sentence IdxEntry named Name
+  // (thread safe)
+  void Write(
+    std::size_t IdxEntry,
+    const std::string &Name,
+    const std::string &EditOperations
+  );
+
+  // read the index of data file FileName
+  static std::vector<Entry> ReadIndex(
+    const std::string &FileName
+  );
+
+  // read the edit operations of an entry of data file FileName
+  static std::string ReadEntry(
+    const std::string &FileName,
+    const Entry &IndexEntry
+  );
+};
+
+#endif
@@ -46,18 +46,24 @@
 #include <CustomArcMappers.hpp>
 #include "LPERCalculator.hpp"
 
-LPERCalculator::LPERCalculator(const vector< fst::VectorFst< fst::LogArc > > &InputFsts_, const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts, const vector< string > &Id2CharacterSequenceVector, unsigned int NumThreads_, const std::vector<std::string> &FileNames_, const std::string &Prefix_, bool OutputEditOperations_, const std::vector<ArcInfo> &InputArcInfos_) :
-  EditDistanceCalculator(NumThreads_, FileNames_, Prefix_, OutputEditOperations_)
+LPERCalculator::LPERCalculator(const vector< fst::VectorFst< fst::LogArc > > &InputFsts_, const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts, const vector< string > &Id2CharacterSequenceVector, unsigned int NumThreads_, const std::vector<std::string> &FileNames_, const std::string &Prefix_, bool OutputEditOperations_, const std::vector<ArcInfo> &InputArcInfos_, bool ConsolidateEditOperations_, const std::function<void(std::size_t, fst::VectorFst<fst::LogArc> *)> &PruneInputFst) :
+  EditDistanceCalculator(NumThreads_, FileNames_, Prefix_, OutputEditOperations_, nullptr, ConsolidateEditOperations_)
 {
-//   FileReader::PrintFST("lattice_debug/BeforeRemove.fst", Id2CharacterSequenceVector, InputFsts_[0], false, NONE);
-  RemoveWeightAndConvertToStdArc(InputFsts_, &InputFsts, InputArcInfos_);
-//   fst::ArcMapFst<fst::StdArc, fst::LogArc, fst::StdToLogMapper > StdToLogFst(InputFsts[0], fst::StdToLogMapper());
-//   FileReader::PrintFST("lattice_debug/AfterRemove.fst", Id2CharacterSequenceVector, fst::VectorFst<fst::LogArc>(StdToLogFst), false, NONE);
   ParseFsts(ReferenceFsts, &ReferenceSentences);
   InputAndReferenceIds.resize(Id2CharacterSequenceVector.size() - CHARACTERSBEGIN);
   std::iota(InputAndReferenceIds.begin(), InputAndReferenceIds.end(), CHARACTERSBEGIN);
 
-  SetInputFstsAndReferenceSentences(InputFsts, ReferenceSentences, InputAndReferenceIds, Id2CharacterSequenceVector);
+  // the input fsts are pruned and converted per sentence by the alignment
+  // threads, each sentence is only accessed by one thread
+  SetInputFstsAndReferenceSentences([&](unsigned int IdxSentence, fst::VectorFst<fst::StdArc> *InputFst) {
+    if (PruneInputFst) {
+      fst::VectorFst<fst::LogArc> PrunedFst;
+      PruneInputFst(IdxSentence, &PrunedFst);
+      RemoveWeightAndConvertToStdArc(PrunedFst, InputFst, InputArcInfos_);
+    } else {
+      RemoveWeightAndConvertToStdArc(InputFsts_.at(IdxSentence), InputFst, InputArcInfos_);
+    }
+  }, ReferenceSentences, InputAndReferenceIds, Id2CharacterSequenceVector);
 }
 
 
@@ -87,12 +93,9 @@ void LPERCalculator::ParseFsts(const vector< fst::VectorFst< fst::LogArc > > &Fs
 }
 
 
-void LPERCalculator::RemoveWeightAndConvertToStdArc(const vector< fst::VectorFst< fst::LogArc > > &LogFsts, vector< fst::VectorFst< fst::StdArc > > *StdFsts, const std::vector<ArcInfo> &InputArcInfos)
+void LPERCalculator::RemoveWeightAndConvertToStdArc(const fst::VectorFst< fst::LogArc > &LogFst, fst::VectorFst< fst::StdArc > *StdFst, const std::vector<ArcInfo> &InputArcInfos)
 {
-  StdFsts->resize(LogFsts.size());
-  for (unsigned int IdxFst = 0; IdxFst < LogFsts.size(); ++IdxFst) {
-    fst::ArcMapFst<fst::LogArc, fst::LogArc, fst::RestoreIlabelMapper> LogArcMapFst(LogFsts.at(IdxFst), fst::RestoreIlabelMapper(InputArcInfos));
-    fst::RmEpsilonFst<fst::LogArc> LogArcRmEpsilonFst(LogArcMapFst);
-    fst::ArcMap(LogArcRmEpsilonFst, &StdFsts->at(IdxFst), fst::RmWeightMapper<fst::LogArc, fst::StdArc>());
-  }
+  fst::ArcMapFst<fst::LogArc, fst::LogArc, fst::RestoreIlabelMapper> LogArcMapFst(LogFst, fst::RestoreIlabelMapper(InputArcInfos));
+  fst::RmEpsilonFst<fst::LogArc> LogArcRmEpsilonFst(LogArcMapFst);
+  fst::ArcMap(LogArcRmEpsilonFst, StdFst, fst::RmWeightMapper<fst::LogArc, fst::StdArc>());
 }
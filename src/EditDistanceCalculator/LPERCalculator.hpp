@@ -65,7 +65,6 @@
 
 /* class to calculate lattice phoneme error rate */
 class LPERCalculator : public EditDistanceCalculator {
-  std::vector<fst::VectorFst<fst::StdArc> > InputFsts;
   std::vector<std::vector<int> > ReferenceSentences;
   std::vector<int> InputAndReferenceIds;
 
@@ -76,14 +75,17 @@ class LPERCalculator : public EditDistanceCalculator {
     std::vector< std::vector< int > > *Sentences
   );
 
-  void RemoveWeightAndConvertToStdArc(
-    const vector< fst::VectorFst< fst::LogArc > > &LogFsts,
-    vector< fst::VectorFst< fst::StdArc > > *StdFsts,
+  static void RemoveWeightAndConvertToStdArc(
+    const fst::VectorFst< fst::LogArc > &LogFst,
+    fst::VectorFst< fst::StdArc > *StdFst,
     const std::vector<ArcInfo> &InputArcInfos
   );
 
 public:
   /* constructor */
+  // if PruneInputFst is given, it writes the pruned input fst of sentence
+  // Idx to its second argument when the sentence is aligned, instead of
+  // the input fst being used as is
   LPERCalculator(
     const vector< fst::VectorFst< fst::LogArc > > &InputFsts_,
     const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts,
@@ -92,7 +94,9 @@ public:
     const vector< string > &FileNames_,
     const string &Prefix_,
     bool OutputEditOperations_,
-    const std::vector<ArcInfo> &InputArcInfos_
+    const std::vector<ArcInfo> &InputArcInfos_,
+    bool ConsolidateEditOperations_ = false,
+    const std::function<void(std::size_t, fst::VectorFst<fst::LogArc> *)> &PruneInputFst = nullptr
   );
 };
 
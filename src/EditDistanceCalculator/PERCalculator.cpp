@@ -43,8 +43,8 @@
 // ----------------------------------------------------------------------------
 #include "PERCalculator.hpp"
 
-PERCalculator::PERCalculator(const vector< fst::VectorFst< fst::LogArc > > &InputFsts, const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts, const vector< string > &Id2CharacterSequenceVector, unsigned int NumThreads_, const std::vector<std::string> &FileNames_, const std::string &Prefix_, bool OutputEditOperations_, const std::vector<ArcInfo> &InputArcInfos_) :
-  EditDistanceCalculator(NumThreads_, FileNames_, Prefix_, OutputEditOperations_)
+PERCalculator::PERCalculator(const vector< fst::VectorFst< fst::LogArc > > &InputFsts, const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts, const vector< string > &Id2CharacterSequenceVector, unsigned int NumThreads_, const std::vector<std::string> &FileNames_, const std::string &Prefix_, bool OutputEditOperations_, const std::vector<ArcInfo> &InputArcInfos_, EditDistanceCache *Cache_, bool ConsolidateEditOperations_) :
+  EditDistanceCalculator(NumThreads_, FileNames_, Prefix_, OutputEditOperations_, Cache_, ConsolidateEditOperations_)
 {
   ParseFsts(InputFsts, &InputSentences, InputArcInfos_);
   ParseFsts(ReferenceFsts, &ReferenceSentences, std::vector<ArcInfo>());
@@ -87,7 +87,9 @@ public:
     const vector< string > &FileNames_,
     const string &Prefix_,
     bool OutputEditOperations_,
-    const std::vector<ArcInfo> &InputArcInfos_
+    const std::vector<ArcInfo> &InputArcInfos_,
+    EditDistanceCache *Cache_ = nullptr,
+    bool ConsolidateEditOperations_ = false
   );
 };
 
@@ -0,0 +1,111 @@
+// ----------------------------------------------------------------------------
+/**
+   File: ReferenceLexicon.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <stdexcept>
+#include "ReferenceLexicon.hpp"
+#include "../ParseLib.hpp"
+
+ReferenceLexicon::ReferenceLexicon(const std::vector<fst::VectorFst<fst::LogArc> > &ReferenceFsts, const std::vector<std::string> &Symbols) :
+  Sentences(ReferenceFsts.size()),
+  NumReferenceTypes(0)
+{
+  // the word ids of a fresh dictionary are assigned in order of first
+  // occurrence and directly give the type indices
+  Dictionary Dict(0, Symbols);
+  int WordsBegin = Dict.GetWordsBegin();
+  std::vector<int> Sentence;
+  for (std::size_t IdxSentence = 0; IdxSentence < ReferenceFsts.size(); ++IdxSentence) {
+    ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionary(
+      ReferenceFsts[IdxSentence],
+      &Dict,
+      &Sentence,
+      nullptr,
+      std::vector<ArcInfo>()
+    );
+    Sentences[IdxSentence].reserve(Sentence.size());
+    for (int WordId : Sentence) {
+      if (Dict.GetId2Word().find(WordId) == Dict.GetId2Word().end()) {
+        throw std::runtime_error("Reference transcriptions have to be given as character sequences");
+      }
+      Sentences[IdxSentence].push_back(WordId - WordsBegin);
+    }
+  }
+
+  Types.resize(Dict.GetMaxNumWords() - WordsBegin);
+  for (std::size_t IdxType = 0; IdxType < Types.size(); ++IdxType) {
+    WordBeginLengthPair WordBeginLength = Dict.GetWordBeginLength(IdxType + WordsBegin);
+    Types[IdxType].assign(WordBeginLength.first, WordBeginLength.first + WordBeginLength.second);
+  }
+
+  std::vector<bool> IsReferenceType(Types.size(), false);
+  for (const std::vector<int> &TypeSentence : Sentences) {
+    for (std::size_t IdxWord = 0; IdxWord + 1 < TypeSentence.size(); ++IdxWord) {
+      if (!IsReferenceType[TypeSentence[IdxWord]]) {
+        IsReferenceType[TypeSentence[IdxWord]] = true;
+        ++NumReferenceTypes;
+      }
+    }
+  }
+}
+
+
+void ReferenceLexicon::AddToDictionary(Dictionary *Dict, std::vector<std::vector<int> > *ReferenceSentences) const
+{
+  std::vector<int> TypeIds(Types.size());
+  for (std::size_t IdxType = 0; IdxType < Types.size(); ++IdxType) {
+    TypeIds[IdxType] = Dict->AddCharacterIdSequenceToDictionary(Types[IdxType].begin(), Types[IdxType].size()).first;
+  }
+
+  ReferenceSentences->resize(Sentences.size());
+  for (std::size_t IdxSentence = 0; IdxSentence < Sentences.size(); ++IdxSentence) {
+    const std::vector<int> &TypeSentence = Sentences[IdxSentence];
+    std::vector<int> &ReferenceSentence = ReferenceSentences->at(IdxSentence);
+    ReferenceSentence.clear();
+    for (std::size_t IdxWord = 0; IdxWord + 1 < TypeSentence.size(); ++IdxWord) {
+      ReferenceSentence.push_back(TypeIds[TypeSentence[IdxWord]]);
+    }
+  }
+}
+
+
+std::size_t ReferenceLexicon::GetNumReferenceTypes() const
+{
+  return NumReferenceTypes;
+}
@@ -0,0 +1,90 @@
+// ----------------------------------------------------------------------------
+/**
+   File: ReferenceLexicon.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: reference sentences and word types for the word error rate calculation
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _REFERENCELEXICON_HPP_
+#define _REFERENCELEXICON_HPP_
+
+#include <fst/vector-fst.h>
+#include "../NHPYLM/Dictionary.hpp"
+
+/* reference transcriptions parsed once into word types given by their
+   character sequences. The references do not change, so each word error
+   rate calculation only adds the types to its dictionary to get the
+   reference sentences with the current word ids, instead of parsing the
+   reference fsts and sorting the concatenated references again */
+class ReferenceLexicon {
+  std::vector<std::vector<int> > Types;      // character ids of each reference word type in order of first occurrence
+  std::vector<std::vector<int> > Sentences;  // reference sentences as type indices, including the final sentence end word
+  std::size_t NumReferenceTypes;             // number of different types in the sentences without sentence end
+
+public:
+  /* constructor */
+  // parse the reference fsts with a dictionary of the given symbols
+  ReferenceLexicon(
+    const std::vector<fst::VectorFst<fst::LogArc> > &ReferenceFsts,
+    const std::vector<std::string> &Symbols
+  );
+
+
+  /* interface */
+  // add the reference word types to Dict in order of first occurrence
+  // (like parsing the reference fsts) and return the reference sentences
+  // without sentence end with the word ids of Dict
+  void AddToDictionary(
+    Dictionary *Dict,
+    std::vector<std::vector<int> > *ReferenceSentences
+  ) const;
+
+  // number of different words in the reference sentences
+  std::size_t GetNumReferenceTypes() const;
+};
+
+#endif
@@ -42,30 +42,32 @@
 */
 // ----------------------------------------------------------------------------
 #include "WERCalculator.hpp"
-#include "../ParseLib.hpp"
 
 WERCalculator::WERCalculator(
   const vector< vector< int > > &InputSentences_,
-  const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts_,
+  const ReferenceLexicon &References_,
   const Dictionary &dict_,
   int WHPYLMContextLength,
   unsigned int NumThreads_,
   const std::vector<std::string> &FileNames_,
   const std::string &Prefix_,
-  bool OutputEditOperations_
+  bool OutputEditOperations_,
+  EditDistanceCache *Cache_,
+  bool ConsolidateEditOperations_
 ) :
   EditDistanceCalculator(NumThreads_, FileNames_,
-                         Prefix_, OutputEditOperations_),
+                         Prefix_, OutputEditOperations_, Cache_,
+                         ConsolidateEditOperations_),
   dict(dict_),
   LexiconCorrNFoundNRef(3, 0),
-  TotalNumReferenceWords(0)
+  NumReferenceTypes(0)
 {
 //   std::cout << "Setting LexiconCorrNFoundNRef[1]" << std::endl;
   LexiconCorrNFoundNRef[1] = dict.GetId2Word().size() - 1;
 //   std::cout << "Triming input sentences" << std::endl;
   TrimInputSentences(InputSentences_, WHPYLMContextLength);
-//   std::cout << "Parsing reference sentences" << std::endl;
-  ParseReferenceFsts(ReferenceFsts_);
+//   std::cout << "Adding reference sentences" << std::endl;
+  AddReferenceSentencesToDictionary(References_);
 //   std::cout << "Setting input and reference sentences" << std::endl;
   SetInputAndReferenceSentences(InputSentences,
                                 ReferenceSentences,
@@ -92,27 +94,12 @@ void WERCalculator::TrimInputSentences(
   }
 }
 
-void WERCalculator::ParseReferenceFsts(
-  const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts
+void WERCalculator::AddReferenceSentencesToDictionary(
+  const ReferenceLexicon &References
 )
 {
-  int NumReferenceFsts = ReferenceFsts.size();
-  ReferenceSentences.resize(NumReferenceFsts);
-  for (int IdxReferenceFst = 0;
-       IdxReferenceFst < NumReferenceFsts;
-       ++IdxReferenceFst) {
-//     std::cout << "Parsing reference FST " << IdxReferenceFst << std::flush;
-    ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionary(
-      ReferenceFsts.at(IdxReferenceFst),
-      &dict,
-      &ReferenceSentences.at(IdxReferenceFst),
-      nullptr,
-      std::vector<ArcInfo>()
-    );
-//     std::cout << " Done!" << std::endl << std::flush;
-    ReferenceSentences.at(IdxReferenceFst).pop_back();
-    TotalNumReferenceWords += ReferenceSentences.at(IdxReferenceFst).size();
-  }
+  References.AddToDictionary(&dict, &ReferenceSentences);
+  NumReferenceTypes = References.GetNumReferenceTypes();
   InputAndReferenceIds.resize(dict.GetMaxNumWords() - dict.GetWordsBegin());
   std::iota(InputAndReferenceIds.begin(),
             InputAndReferenceIds.end(),
@@ -121,22 +108,8 @@ void WERCalculator::ParseReferenceFsts(
 
 void WERCalculator::CalcLexiconCorrNFoundNRef()
 {
-  std::vector<int> ConcatenatedReferenceSentences;
-  ConcatenatedReferenceSentences.reserve(TotalNumReferenceWords);
-  for (const std::vector<int> &ReferenceSentence : ReferenceSentences) {
-    ConcatenatedReferenceSentences.insert(ConcatenatedReferenceSentences.end(),
-                                          ReferenceSentence.begin(),
-                                          ReferenceSentence.end());
-  }
-
-  std::sort(ConcatenatedReferenceSentences.begin(),
-            ConcatenatedReferenceSentences.end());
-  std::vector<int>::iterator LastUniqueElement =
-    std::unique(ConcatenatedReferenceSentences.begin(),
-                ConcatenatedReferenceSentences.end());
-  LexiconCorrNFoundNRef[2] =
-    std::distance(ConcatenatedReferenceSentences.begin(),
-                  LastUniqueElement);
+  // reference words not found in the lexicon were added to the dictionary
+  LexiconCorrNFoundNRef[2] = NumReferenceTypes;
   LexiconCorrNFoundNRef[0] = LexiconCorrNFoundNRef[1] -
                              (dict.GetId2Word().size() - 1 - LexiconCorrNFoundNRef[2]);
 }
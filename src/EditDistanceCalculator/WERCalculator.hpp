@@ -62,6 +62,7 @@
 
 #include "../NHPYLM/Dictionary.hpp"
 #include "EditDistanceCalculator.hpp"
+#include "ReferenceLexicon.hpp"
 
 /* class to calculate word error rate of input sentences */
 class WERCalculator : public EditDistanceCalculator {
@@ -70,7 +71,7 @@ class WERCalculator : public EditDistanceCalculator {
   std::vector<std::vector<int> > InputSentences;
   std::vector<std::vector<int> > ReferenceSentences;
   std::vector<int> InputAndReferenceIds;
-  int TotalNumReferenceWords;
+  std::size_t NumReferenceTypes;
 
 
   /* internal functions */
@@ -79,8 +80,8 @@ class WERCalculator : public EditDistanceCalculator {
     int WHPYLMContextLength
   );
 
-  void ParseReferenceFsts(
-    const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts);
+  void AddReferenceSentencesToDictionary(
+    const ReferenceLexicon &References);
   
   void CalcLexiconCorrNFoundNRef();
 
@@ -88,13 +89,15 @@ public:
   /* constructor */
   WERCalculator(
     const vector< vector< int > > &InputSentences_,
-    const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts_,
+    const ReferenceLexicon &References_,
     const Dictionary &dict_,
     int WHPYLMContextLength,
     unsigned int NumThreads_,
     const vector< string > &FileNames_,
     const string &Prefix_,
-    bool OutputEditOperations_
+    bool OutputEditOperations_,
+    EditDistanceCache *Cache_ = nullptr,
+    bool ConsolidateEditOperations_ = false
   );
 
   
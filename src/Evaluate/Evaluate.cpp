@@ -41,6 +41,7 @@
    Author: Thomas Glarner
 */
 // ----------------------------------------------------------------------------
+#include <iostream>
 #include "Evaluate.hpp"
 #include "../DebugLib.hpp"
 #include "../EditDistanceCalculator/WERCalculator.hpp"
@@ -49,26 +50,50 @@
 
 
 
+const std::size_t Evaluate::MAX_PENDING_EVALUATIONS;
+
+
+Evaluate::~Evaluate()
+{
+  {
+    std::lock_guard<std::mutex> Lock(JobsMutex);
+    StopBackgroundThread = true;
+  }
+  JobsCondition.notify_all();
+  if (BackgroundThread.joinable()) {
+    BackgroundThread.join();
+  }
+}
+
 void Evaluate::WriteSentencesToOutputFiles(
     const std::vector<std::vector<int>>& SampledSentences,
     const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
     std::size_t IdxIter)
 {
-  // write to output
-  DebugLib::PrintSentencesToFile(
-    BuildPrefix("Sentences", IdxIter),
+  WriteSentencesToOutputFiles(
     SampledSentences,
-    LanguageModel->GetId2CharacterSequenceVector()
+    TimedSampledSentences,
+    LanguageModel->GetId2CharacterSequenceVector(),
+    BuildPrefix("Sentences", IdxIter),
+    BuildPrefix("TimedSentences", IdxIter)
   );
+}
 
-  if (!InputFileData.GetInputArcInfos().empty()) {
-    DebugLib::PrintTimedSentencesToFile(
-      BuildPrefix("TimedSentences", IdxIter),
-      TimedSampledSentences,
-      LanguageModel->GetId2CharacterSequenceVector(),
-      InputFileData.GetInputFileNames()
-    );
-  }
+void Evaluate::WriteSentencesToOutputFiles(
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
+    const std::vector<std::string>& Id2CharacterSequence,
+    const std::string& SentencesPrefix,
+    const std::string& TimedSentencesPrefix)
+{
+  // write to output (in the writer thread)
+  SentencesWriter.Write(
+    SentencesPrefix,
+    InputFileData.GetInputArcInfos().empty() ? "" : TimedSentencesPrefix,
+    SampledSentences,
+    TimedSampledSentences,
+    Id2CharacterSequence
+  );
 }
 
 /******************************************************************************
@@ -87,13 +112,12 @@ void Evaluate::OutputMeasureStatistics(
 {
     // get perplexity
     Timer.tCalcPerplexity.SetStart();
-    DebugLib::PrintSentencesPerplexity(SampledSentences, *LanguageModel);
+    DebugLib::PrintSentencesPerplexity(SampledSentences, *LanguageModel,
+                                       Params.NoThreads,
+                                       &SentenceLoglikelihoods);
     Timer.tCalcPerplexity.AddTimeSinceStartToDuration();
 
-    bool OutputEditOperations =
-      Params.OutputEditOperations && ((IdxIter == (Params.NumIter - 1)) ||
-      (IdxIter == (Params.DeactivateCharacterModel - 1)) ||
-      (IdxIter == (Params.UseViterby - 2)));
+    bool OutputEditOperations = GetOutputEditOperations(IdxIter);
 
     // calculate word error rate
     if (Params.CalculateWER && ((IdxIter % Params.EvalInterval) == 0)) {
@@ -116,6 +140,21 @@ void Evaluate::OutputMeasureStatistics(
     Timer.PrintTimingStatistics();
 }
 
+const ReferenceLexicon &Evaluate::GetWERReferences(const Dictionary &Dict)
+{
+  std::call_once(WERReferencesFlag, [this, &Dict]() {
+    const std::vector<std::string> &Id2CharacterSequence =
+      Dict.GetId2CharacterSequenceVector();
+    WERReferences.reset(new ReferenceLexicon(
+      InputFileData.GetReferenceFsts(),
+      std::vector<std::string>(Id2CharacterSequence.begin(),
+                               Id2CharacterSequence.begin() +
+                               Dict.GetWordsBegin())
+    ));
+  });
+  return *WERReferences;
+}
+
 void Evaluate::OutputWordErrorRate(
     const std::vector<std::vector<int>>& SampledSentences,
     bool OutputEditOperations,
@@ -126,13 +165,15 @@ void Evaluate::OutputWordErrorRate(
 
   WERCalculator SegStatsCalculator(
     SampledSentences,
-    InputFileData.GetReferenceFsts(),
+    GetWERReferences(*LanguageModel),
     *LanguageModel,
     WHPYLMContextLength,
-    1,
+    Params.NoThreads,
     InputFileData.GetInputFileNames(),
     BuildPrefix("WER", IdxIter) + "_",
-    OutputEditOperations
+    OutputEditOperations,
+    &WERCache,
+    Params.ConsolidateEditOperations
   );
   //       std::cout << "Finished WER calculation" << std::endl;
   DebugLib::PrintEditDistanceStatistics(
@@ -157,7 +198,9 @@ void Evaluate::OutputPhonemeErrorRate(
       InputFileData.GetInputFileNames(),
       BuildPrefix("PER", IdxIter) + "_",
       OutputEditOperations,
-      InputFileData.GetInputArcInfos()
+      InputFileData.GetInputArcInfos(),
+      &PERCache,
+      Params.ConsolidateEditOperations
     );
 
     DebugLib::PrintEditDistanceStatistics(
@@ -167,11 +210,251 @@ void Evaluate::OutputPhonemeErrorRate(
     );
 }
 
+bool Evaluate::GetOutputEditOperations(std::size_t IdxIter) const
+{
+  return Params.OutputEditOperations && ((IdxIter == (Params.NumIter - 1)) ||
+    (IdxIter == (Params.DeactivateCharacterModel - 1)) ||
+    (IdxIter == (Params.UseViterby - 2)));
+}
+
 std::string Evaluate::BuildPrefix(std::string specifier, std::size_t IdxIter)
+{
+  return BuildPrefix(specifier, IdxIter, LanguageModel->GetWHPYLMOrder(),
+                     LanguageModel->GetCHPYLMOrder());
+}
+
+std::string Evaluate::BuildPrefix(const std::string &specifier,
+                                  std::size_t IdxIter,
+                                  int WHPYLMOrder,
+                                  int CHPYLMOrder) const
 {
   return Params.OutputDirectoryBasename +
-      "KnownN_" + std::to_string(LanguageModel->GetWHPYLMOrder()) +
-      "_UnkN_" + std::to_string(LanguageModel->GetCHPYLMOrder()) +
+      "KnownN_" + std::to_string(WHPYLMOrder) +
+      "_UnkN_" + std::to_string(CHPYLMOrder) +
       "/" + Params.OutputFilesBasename + specifier +
       "_Iter_" + std::to_string(IdxIter + 1);
 }
+
+/******************************************************************************
+ * Asynchronous evaluation:
+ * The sampled sentences and fsts and the dictionary of an iteration are
+ * copied into a job which is evaluated by a single background thread while
+ * the next iteration is sampled. WER and PER are calculated with
+ * -AsyncEvaluationThreads threads besides the sampling threads. Perplexity
+ * and language model statistics need the current language model and are
+ * calculated directly. Results of finished jobs are printed by the main
+ * thread in iteration order, a failed evaluation is rethrown there.
+ ******************************************************************************/
+void Evaluate::EvaluateIteration(
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
+    const std::vector<LogVectorFst>& SampledFsts,
+    std::size_t IdxIter)
+{
+  if (!Params.AsyncEvaluation) {
+    WriteSentencesToOutputFiles(SampledSentences, TimedSampledSentences,
+                                IdxIter);
+    OutputMeasureStatistics(SampledSentences, SampledFsts, IdxIter);
+    return;
+  }
+
+  // get perplexity
+  Timer.tCalcPerplexity.SetStart();
+  DebugLib::PrintSentencesPerplexity(SampledSentences, *LanguageModel,
+                                     Params.NoThreads,
+                                     &SentenceLoglikelihoods);
+  Timer.tCalcPerplexity.AddTimeSinceStartToDuration();
+
+  // take snapshot of the iteration
+  std::shared_ptr<EvaluationJob> Job = std::make_shared<EvaluationJob>();
+  Job->IdxIter = IdxIter;
+  Job->WHPYLMOrder = LanguageModel->GetWHPYLMOrder();
+  Job->CHPYLMOrder = LanguageModel->GetCHPYLMOrder();
+  Job->OutputEditOperations = GetOutputEditOperations(IdxIter);
+  Job->CalculateWER =
+    Params.CalculateWER && ((IdxIter % Params.EvalInterval) == 0);
+  Job->CalculatePER =
+    Params.CalculatePER && ((IdxIter % Params.EvalInterval) == 0);
+  Job->SampledSentences = SampledSentences;
+  Job->TimedSampledSentences = TimedSampledSentences;
+  Job->Id2CharacterSequence = LanguageModel->GetId2CharacterSequenceVector();
+  if (Job->CalculateWER) {
+    Job->Dict.reset(new Dictionary(*LanguageModel));
+  }
+  if (Job->CalculatePER) {
+    // the background thread gets its own copies of the sampled fsts
+    Job->SampledFsts.reserve(SampledFsts.size());
+    for (const LogVectorFst &SampledFst : SampledFsts) {
+      Job->SampledFsts.push_back(DeepCopyFst(SampledFst));
+    }
+  }
+  Job->Done = false;
+
+  // hand over to the background thread, waiting if too many iterations are
+  // still being evaluated
+  {
+    std::unique_lock<std::mutex> Lock(JobsMutex);
+    JobsCondition.wait(Lock, [this]() {
+      std::size_t NumUnfinishedJobs = 0;
+      for (const std::shared_ptr<EvaluationJob> &UnreportedJob : UnreportedJobs) {
+        NumUnfinishedJobs += !UnreportedJob->Done;
+      }
+      return NumUnfinishedJobs < MAX_PENDING_EVALUATIONS;
+    });
+    PendingJobs.push_back(Job);
+    UnreportedJobs.push_back(Job);
+    if (!BackgroundThread.joinable()) {
+      BackgroundThread = std::thread(&Evaluate::BackgroundThreadFn, this);
+    }
+  }
+  JobsCondition.notify_all();
+
+  // output some language model stats
+  DebugLib::PrintLanguageModelStats(*LanguageModel);
+
+  ReportFinishedJobs(false);
+
+  // output some timing statistics
+  Timer.PrintTimingStatistics();
+}
+
+const std::vector<double> &Evaluate::GetSentenceLoglikelihoods() const
+{
+  return SentenceLoglikelihoods;
+}
+
+void Evaluate::FinishEvaluation()
+{
+  ReportFinishedJobs(true);
+  SentencesWriter.Flush();
+}
+
+void Evaluate::BackgroundThreadFn()
+{
+  while (true) {
+    std::shared_ptr<EvaluationJob> Job;
+    {
+      std::unique_lock<std::mutex> Lock(JobsMutex);
+      JobsCondition.wait(Lock, [this]() {
+        return StopBackgroundThread || !PendingJobs.empty();
+      });
+      if (StopBackgroundThread) {
+        return;
+      }
+      Job = PendingJobs.front();
+      PendingJobs.pop_front();
+    }
+
+    try {
+      EvaluateJob(Job.get());
+    } catch (...) {
+      Job->Error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> Lock(JobsMutex);
+      Job->Done = true;
+    }
+    JobsCondition.notify_all();
+  }
+}
+
+void Evaluate::EvaluateJob(EvaluationJob *Job)
+{
+  WriteSentencesToOutputFiles(
+    Job->SampledSentences,
+    Job->TimedSampledSentences,
+    Job->Id2CharacterSequence,
+    BuildPrefix("Sentences", Job->IdxIter, Job->WHPYLMOrder, Job->CHPYLMOrder),
+    BuildPrefix("TimedSentences", Job->IdxIter, Job->WHPYLMOrder,
+                Job->CHPYLMOrder)
+  );
+
+  if (Job->CalculateWER) {
+    Job->tCalcWER.SetStart();
+    WERCalculator SegStatsCalculator(
+      Job->SampledSentences,
+      GetWERReferences(*Job->Dict),
+      *Job->Dict,
+      Job->WHPYLMOrder - 1,
+      Params.AsyncEvaluationThreads,
+      InputFileData.GetInputFileNames(),
+      BuildPrefix("WER", Job->IdxIter, Job->WHPYLMOrder,
+                  Job->CHPYLMOrder) + "_",
+      Job->OutputEditOperations,
+      &WERCache,
+      Params.ConsolidateEditOperations
+    );
+    Job->WERInsDelSubCorrNFoundNRef =
+      SegStatsCalculator.GetInsDelSubCorrNFoundNRef();
+    Job->LexiconCorrNFoundNRef = SegStatsCalculator.GetLexiconCorrNFoundNRef();
+    Job->tCalcWER.AddTimeSinceStartToDuration();
+  }
+
+  if (Job->CalculatePER) {
+    Job->tCalcPER.SetStart();
+    PERCalculator PhonemeStatsCalculator(
+      Job->SampledFsts,
+      InputFileData.GetReferenceFsts(),
+      InputFileData.GetReferenceIntToStringVector(),
+      Params.AsyncEvaluationThreads,
+      InputFileData.GetInputFileNames(),
+      BuildPrefix("PER", Job->IdxIter, Job->WHPYLMOrder,
+                  Job->CHPYLMOrder) + "_",
+      Job->OutputEditOperations,
+      InputFileData.GetInputArcInfos(),
+      &PERCache,
+      Params.ConsolidateEditOperations
+    );
+    Job->PERInsDelSubCorrNFoundNRef =
+      PhonemeStatsCalculator.GetInsDelSubCorrNFoundNRef();
+    Job->tCalcPER.AddTimeSinceStartToDuration();
+  }
+}
+
+void Evaluate::ReportFinishedJobs(bool WaitForAll)
+{
+  while (true) {
+    std::shared_ptr<EvaluationJob> Job;
+    {
+      std::unique_lock<std::mutex> Lock(JobsMutex);
+      if (UnreportedJobs.empty()) {
+        return;
+      }
+      if (WaitForAll) {
+        JobsCondition.wait(Lock, [this]() {
+          return UnreportedJobs.front()->Done;
+        });
+      } else if (!UnreportedJobs.front()->Done) {
+        return;
+      }
+      Job = UnreportedJobs.front();
+      UnreportedJobs.pop_front();
+    }
+    JobsCondition.notify_all();
+
+    if (Job->Error) {
+      std::rethrow_exception(Job->Error);
+    }
+
+    std::cout << " Evaluation of iteration " << Job->IdxIter + 1 << ":"
+              << std::endl;
+    if (Job->CalculateWER) {
+      DebugLib::PrintEditDistanceStatistics(
+          Job->WERInsDelSubCorrNFoundNRef,
+          "Word error rate",
+          "WER");
+
+      DebugLib::PrintLexiconStatistics(Job->LexiconCorrNFoundNRef);
+      Timer.tCalcWER.AddDuration(Job->tCalcWER);
+    }
+    if (Job->CalculatePER) {
+      DebugLib::PrintEditDistanceStatistics(
+        Job->PERInsDelSubCorrNFoundNRef,
+        "Phoneme error rate",
+        "PER"
+      );
+      Timer.tCalcPER.AddDuration(Job->tCalcPER);
+    }
+  }
+}
@@ -60,18 +60,84 @@
 #ifndef _EVALUATE_HPP_
 #define _EVALUATE_HPP_
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "../FileReader/FileData.hpp"
 #include "../ParameterParser/ParameterParser.hpp"
 #include "../LatticeWordSegmentationTimer.hpp"
 #include "../NHPYLM/NHPYLM.hpp"
+#include "../EditDistanceCalculator/EditDistanceCache.hpp"
+#include "../EditDistanceCalculator/ReferenceLexicon.hpp"
+#include "SegmentationWriter.hpp"
 
 class Evaluate{
+  /* snapshot of an iteration for the evaluation in the background thread
+     and the results of the evaluation */
+  struct EvaluationJob {
+    std::size_t IdxIter;
+    int WHPYLMOrder;
+    int CHPYLMOrder;
+    bool OutputEditOperations;
+    bool CalculateWER;
+    bool CalculatePER;
+    std::vector<std::vector<int>> SampledSentences;
+    std::vector<std::vector<ArcInfo>> TimedSampledSentences;
+    std::vector<LogVectorFst> SampledFsts;          // deep copies of the sampled fsts (only for PER)
+    std::vector<std::string> Id2CharacterSequence;
+    std::unique_ptr<Dictionary> Dict;               // copy of the dictionary (only for WER)
+    std::vector<int> WERInsDelSubCorrNFoundNRef;
+    std::vector<int> LexiconCorrNFoundNRef;
+    std::vector<int> PERInsDelSubCorrNFoundNRef;
+    LatticeWordSegmentationTimer::SimpleTimer tCalcWER;
+    LatticeWordSegmentationTimer::SimpleTimer tCalcPER;
+    std::exception_ptr Error;                       // exception of the evaluation, rethrown when reported
+    bool Done;
+  };
+
+  // maximum number of iterations waiting for or in background evaluation
+  static const std::size_t MAX_PENDING_EVALUATIONS = 2;
+
   const ParameterStruct& Params;
   const FileData& InputFileData;
   LatticeWordSegmentationTimer& Timer;
   const NHPYLM* LanguageModel;
 
+  // per sentence counts of the last WER and PER calculation, only
+  // sentences changed since then are aligned again
+  EditDistanceCache WERCache;
+  EditDistanceCache PERCache;
+
+  // reference sentences and word types for the WER calculation, parsed
+  // once at the first calculation
+  std::unique_ptr<ReferenceLexicon> WERReferences;
+  std::once_flag WERReferencesFlag;
+
+  // writes the sampled sentences in its own thread
+  SegmentationWriter SentencesWriter;
+
+  // log likelihood of each sentence in the last evaluated iteration
+  std::vector<double> SentenceLoglikelihoods;
+
+  // members for asynchronous evaluation: jobs not yet started by the
+  // background thread and all jobs not yet reported, in iteration order
+  std::thread BackgroundThread;
+  std::mutex JobsMutex;
+  std::condition_variable JobsCondition;
+  std::deque<std::shared_ptr<EvaluationJob>> PendingJobs;
+  std::deque<std::shared_ptr<EvaluationJob>> UnreportedJobs;
+  bool StopBackgroundThread;
+
   /* internal functions */
+  // return the reference lexicon, parsing the reference fsts with the
+  // symbols of Dict on the first call
+  const ReferenceLexicon &GetWERReferences(
+    const Dictionary &Dict
+  );
+
   void OutputPhonemeErrorRate(
     const std::vector<LogVectorFst>& SampledFsts,
     bool OutputEditOperations,
@@ -84,23 +150,74 @@ class Evaluate{
     std::size_t IdxIter
   );
 
+  // true if edit operations are written in iteration IdxIter
+  bool GetOutputEditOperations(
+    std::size_t IdxIter
+  ) const;
+
   std::string BuildPrefix(
     std::string specifier,
     std::size_t IdxIter
   );
 
+  // prefix of output files for the given language model orders
+  std::string BuildPrefix(
+    const std::string &specifier,
+    std::size_t IdxIter,
+    int WHPYLMOrder,
+    int CHPYLMOrder
+  ) const;
+
+  void WriteSentencesToOutputFiles(
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
+    const std::vector<std::string>& Id2CharacterSequence,
+    const std::string& SentencesPrefix,
+    const std::string& TimedSentencesPrefix
+  );
+
+  // write the sentences and calculate the error rates of a job
+  // (called in the background thread)
+  void EvaluateJob(
+    EvaluationJob *Job
+  );
+
+  // take jobs from PendingJobs until StopBackgroundThread is set
+  void BackgroundThreadFn();
+
+  // print the results of finished jobs in iteration order, waiting for
+  // unfinished jobs if WaitForAll is set. An exception of a failed job is
+  // rethrown when the job is reported
+  void ReportFinishedJobs(
+    bool WaitForAll
+  );
+
 public:
   /* constructor */
+  // IsResumed: the run continues from a checkpoint, so the segmentations
+  // are appended to the delta file of the interrupted run
   Evaluate(
     const ParameterStruct& Params,
     const FileData& InputFileData,
     LatticeWordSegmentationTimer& Timer,
-    const NHPYLM* LanguageModel
+    const NHPYLM* LanguageModel,
+    bool IsResumed = false
   ):
     Params(Params),
     InputFileData(InputFileData),
     Timer(Timer),
-    LanguageModel(LanguageModel) {};
+    LanguageModel(LanguageModel),
+    SentencesWriter(Params.SegmentationOutput,
+                    Params.CompressSegmentations ? GZIP : UNCOMPRESSED,
+                    Params.DeltaSnapshotInterval,
+                    Params.OutputDirectoryBasename +
+                    Params.OutputFilesBasename + "Segmentations.delta",
+                    InputFileData.GetInputFileNames(),
+                    IsResumed),
+    StopBackgroundThread(false) {};
+
+  // stop the background thread (unreported results are dropped)
+  ~Evaluate();
 
 
   /* interface */
@@ -115,6 +232,25 @@ public:
     const std::vector<LogVectorFst>& SampledFsts,
     std::size_t IdxIter
   );
+
+  // write the sentences and output the statistics of an iteration. With
+  // -AsyncEvaluation only perplexity and language model statistics are
+  // calculated directly, the rest is evaluated on a snapshot in the
+  // background and reported in iteration order in later iterations
+  void EvaluateIteration(
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
+    const std::vector<LogVectorFst>& SampledFsts,
+    std::size_t IdxIter
+  );
+
+  // wait for the background evaluation and report the remaining results,
+  // rethrows the first failed write of the segmentations
+  void FinishEvaluation();
+
+  // log likelihoods of the sentences of the last evaluated iteration
+  // under the language model of that iteration
+  const std::vector<double> &GetSentenceLoglikelihoods() const;
 };
 
 
@@ -0,0 +1,461 @@
+// ----------------------------------------------------------------------------
+/**
+   File: SegmentationWriter.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include "SegmentationWriter.hpp"
+#include "../Utils/MappedFile.hpp"
+
+const std::size_t SegmentationWriter::MAX_PENDING_WRITES;
+const uint32_t SegmentationWriter::DELTA_FILE_MAGIC;
+const uint32_t SegmentationWriter::DELTA_FILE_VERSION;
+
+namespace {
+
+// append a value in native binary representation (as BinaryWriter)
+template<typename T>
+void AppendValue(const T &Value, std::string *Record)
+{
+  Record->append(reinterpret_cast<const char *>(&Value), sizeof(T));
+}
+
+// append a string (length followed by characters, as BinaryWriter)
+void AppendString(const std::string &String, std::string *Record)
+{
+  AppendValue<uint64_t>(String.size(), Record);
+  Record->append(String);
+}
+
+/* sequential reader for the values of a (compressed) delta file, which
+   decompresses the file chunk by chunk instead of all at once */
+class DeltaFileReader {
+  MappedFile File;             // mapped delta file
+  DecompressingReader Reader;  // decompressed delta file data
+  std::vector<char> Buffer;    // decompressed data not read yet
+  std::size_t Pos;             // position of the next byte in Buffer
+  std::size_t End;             // end of the valid data in Buffer
+
+  // refill the buffer if it is empty, returns false at the end of the data
+  bool Fill()
+  {
+    if (Pos == End) {
+      Pos = 0;
+      End = Reader.Read(Buffer.data(), Buffer.size());
+    }
+    return Pos < End;
+  }
+
+public:
+  /* constructor */
+  // open delta file FileName
+  DeltaFileReader(const std::string &FileName) :
+    File(FileName),
+    Reader(File.GetData(), File.GetSize()),
+    Buffer(1 << 16),
+    Pos(0),
+    End(0)
+  {
+  }
+
+  /* interface */
+  // true if all data was read
+  bool AtEnd()
+  {
+    return !Fill();
+  }
+
+  // append Size bytes to Data, throws std::runtime_error at the end of data
+  void ReadBytes(std::size_t Size, std::string *Data)
+  {
+    while (Size > 0) {
+      if (!Fill()) {
+        throw std::runtime_error("Unexpected end of binary data");
+      }
+      std::size_t ChunkSize = std::min(Size, End - Pos);
+      Data->append(Buffer.data() + Pos, ChunkSize);
+      Pos += ChunkSize;
+      Size -= ChunkSize;
+    }
+  }
+
+  // read a value in native binary representation (as BinaryReader)
+  template<typename T>
+  T Read()
+  {
+    std::string Data;
+    ReadBytes(sizeof(T), &Data);
+    T Value;
+    std::memcpy(&Value, Data.data(), sizeof(T));
+    return Value;
+  }
+
+  // read a string (length followed by characters, as BinaryReader)
+  std::string ReadString()
+  {
+    std::size_t Size = Read<uint64_t>();
+    std::string String;
+    ReadBytes(Size, &String);
+    return String;
+  }
+};
+
+} // namespace
+
+
+SegmentationWriter::SegmentationWriter(SegmentationOutputFormats Format_, CompressionTypes Compression_, unsigned int SnapshotInterval_, const std::string &DeltaFileName_, const std::vector<std::string> &InputFileNames_, bool AppendToExistingDeltaFile_) :
+  Format(Format_),
+  Compression(Compression_),
+  SnapshotInterval(std::max(1u, SnapshotInterval_)),
+  DeltaFileName(DeltaFileName_ + CompressingWriter::GetSuffix(Compression_)),
+  InputFileNames(InputFileNames_),
+  AppendToExistingDeltaFile(AppendToExistingDeltaFile_),
+  DeltaFileSize(0),
+  NumRecordsSinceSnapshot(0),
+  StopWriterThread(false)
+{
+  WriterThread = std::thread(&SegmentationWriter::WriterThreadFn, this);
+}
+
+
+SegmentationWriter::~SegmentationWriter()
+{
+  {
+    std::lock_guard<std::mutex> Lock(JobsMutex);
+    StopWriterThread = true;
+  }
+  JobsCondition.notify_all();
+  WriterThread.join();
+  if (DeltaFile) {
+    DeltaFile->Close();
+  }
+}
+
+
+void SegmentationWriter::Write(const std::string &SentencesFileName, const std::string &TimedSentencesFileName, const std::vector<std::vector<int> > &Sentences, const std::vector<std::vector<ArcInfo> > &TimedSentences, const std::vector<std::string> &Id2CharacterSequence)
+{
+  std::unique_ptr<WriteJob> Job(new WriteJob());
+  Job->SentencesFileName = SentencesFileName;
+  Job->TimedSentencesFileName = TimedSentencesFileName;
+  Job->Sentences = Sentences;
+  if (!TimedSentencesFileName.empty()) {
+    Job->TimedSentences = TimedSentences;
+  }
+  Job->Id2CharacterSequence = Id2CharacterSequence;
+
+  std::unique_lock<std::mutex> Lock(JobsMutex);
+  JobsCondition.wait(Lock, [this]() {
+    return Jobs.size() < MAX_PENDING_WRITES;
+  });
+  Jobs.push_back(std::move(Job));
+  JobsCondition.notify_all();
+}
+
+
+void SegmentationWriter::Flush()
+{
+  std::unique_lock<std::mutex> Lock(JobsMutex);
+  JobsCondition.wait(Lock, [this]() {
+    return Jobs.empty();
+  });
+  if (WriteError) {
+    std::exception_ptr Error = WriteError;
+    WriteError = nullptr;
+    std::rethrow_exception(Error);
+  }
+}
+
+
+void SegmentationWriter::WriterThreadFn()
+{
+  while (true) {
+    const WriteJob *Job;
+    {
+      std::unique_lock<std::mutex> Lock(JobsMutex);
+      JobsCondition.wait(Lock, [this]() {
+        return StopWriterThread || !Jobs.empty();
+      });
+      if (Jobs.empty()) {
+        return;
+      }
+      Job = Jobs.front().get();
+    }
+
+    // the job stays queued while it is written, so that Flush waits for it
+    std::exception_ptr Error;
+    try {
+      if (Format == SEGMENTATION_DELTA) {
+        AppendToDeltaFile(*Job);
+      } else {
+        WriteTextFiles(*Job);
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "  Writing segmentation " << Job->SentencesFileName
+                << " failed: " << e.what() << std::endl;
+      Error = std::current_exception();
+      if (Format == SEGMENTATION_DELTA) {
+        DiscardIncompleteDeltaRecord();
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> Lock(JobsMutex);
+      Jobs.pop_front();
+      if (Error && !WriteError) {
+        WriteError = Error;
+      }
+    }
+    JobsCondition.notify_all();
+  }
+}
+
+
+void SegmentationWriter::FormatSentences(const WriteJob &Job, std::vector<std::string> *Lines, std::vector<std::string> *TimedLines) const
+{
+  Lines->resize(Job.Sentences.size());
+  for (std::size_t IdxSentence = 0; IdxSentence < Job.Sentences.size(); ++IdxSentence) {
+    std::string &Line = Lines->at(IdxSentence);
+    Line.clear();
+    for (int WordId : Job.Sentences[IdxSentence]) {
+      Line += Job.Id2CharacterSequence.at(WordId);
+      Line += ' ';
+    }
+    Line += '\n';
+  }
+
+  TimedLines->resize(Job.TimedSentences.size());
+  for (std::size_t IdxSentence = 0; IdxSentence < Job.TimedSentences.size(); ++IdxSentence) {
+    std::ostringstream TimedLine;
+    for (const ArcInfo &Word : Job.TimedSentences[IdxSentence]) {
+      TimedLine << InputFileNames.at(IdxSentence) << " "
+                << Job.Id2CharacterSequence.at(Word.label) << " "
+                << Word.start << " "
+                << Word.end << "\n";
+    }
+    TimedLines->at(IdxSentence) = TimedLine.str();
+  }
+}
+
+
+void SegmentationWriter::WriteLinesToFile(const std::string &FileName, const std::vector<std::string> &Lines, CompressionTypes Compression)
+{
+  boost::filesystem::path ParentPath = boost::filesystem::path(FileName).parent_path();
+  if (!ParentPath.empty()) {
+    boost::filesystem::create_directories(ParentPath);
+  }
+
+  CompressingWriter File(FileName + CompressingWriter::GetSuffix(Compression), Compression);
+  for (const std::string &Line : Lines) {
+    File.Write(Line);
+  }
+  if (!File.Close()) {
+    throw std::runtime_error("Could not write " + FileName);
+  }
+}
+
+
+void SegmentationWriter::WriteTextFiles(const WriteJob &Job) const
+{
+  std::vector<std::string> Lines;
+  std::vector<std::string> TimedLines;
+  FormatSentences(Job, &Lines, &TimedLines);
+
+  WriteLinesToFile(Job.SentencesFileName, Lines, Compression);
+  if (!Job.TimedSentencesFileName.empty()) {
+    WriteLinesToFile(Job.TimedSentencesFileName, TimedLines, Compression);
+  }
+}
+
+
+/******************************************************************************
+ * Delta file format (native binary representation):
+ * - header: magic (uint32), version (uint32)
+ * - records: snapshot flag (uint8), sentences file name, timed sentences file
+ *   name (strings), number of sentences (uint64), number of stored
+ *   sentences (uint64) and for each stored sentence its index (uint64), its
+ *   line and its timed lines (strings)
+ * A snapshot stores all sentences, other records only the sentences that
+ * differ from the last snapshot. Each record is flushed (and finishes a
+ * gzip member) so that the file is readable up to the last record.
+ ******************************************************************************/
+void SegmentationWriter::AppendToDeltaFile(const WriteJob &Job)
+{
+  std::vector<std::string> Lines;
+  std::vector<std::string> TimedLines;
+  FormatSentences(Job, &Lines, &TimedLines);
+  TimedLines.resize(Lines.size());
+
+  std::string Record;
+  if (!DeltaFile) {
+    boost::filesystem::path ParentPath = boost::filesystem::path(DeltaFileName).parent_path();
+    if (!ParentPath.empty()) {
+      boost::filesystem::create_directories(ParentPath);
+    }
+    // a resumed run continues the delta file of the interrupted run and
+    // after a failed write the file is continued behind the last complete
+    // record. The first record is a snapshot then and does not depend on
+    // the old records
+    boost::system::error_code Error;
+    boost::uintmax_t Size = boost::filesystem::file_size(DeltaFileName, Error);
+    bool Append = AppendToExistingDeltaFile && !Error && (Size > 0);
+    DeltaFile.reset(new CompressingWriter(DeltaFileName, Compression, 1 << 22, Append));
+    DeltaFileSize = Append ? Size : 0;
+    if (!Append) {
+      AppendValue<uint32_t>(DELTA_FILE_MAGIC, &Record);
+      AppendValue<uint32_t>(DELTA_FILE_VERSION, &Record);
+    }
+  }
+
+  bool IsSnapshot = SnapshotLines.empty() ||
+                    (NumRecordsSinceSnapshot + 1 >= SnapshotInterval) ||
+                    (Lines.size() != SnapshotLines.size());
+  std::vector<std::size_t> StoredSentences;
+  for (std::size_t IdxSentence = 0; IdxSentence < Lines.size(); ++IdxSentence) {
+    if (IsSnapshot ||
+        (Lines[IdxSentence] != SnapshotLines[IdxSentence]) ||
+        (TimedLines[IdxSentence] != SnapshotTimedLines[IdxSentence])) {
+      StoredSentences.push_back(IdxSentence);
+    }
+  }
+
+  AppendValue<uint8_t>(IsSnapshot, &Record);
+  AppendString(Job.SentencesFileName, &Record);
+  AppendString(Job.TimedSentencesFileName, &Record);
+  AppendValue<uint64_t>(Lines.size(), &Record);
+  AppendValue<uint64_t>(StoredSentences.size(), &Record);
+  for (std::size_t IdxSentence : StoredSentences) {
+    AppendValue<uint64_t>(IdxSentence, &Record);
+    AppendString(Lines[IdxSentence], &Record);
+    AppendString(TimedLines[IdxSentence], &Record);
+  }
+  DeltaFile->Write(Record);
+  if (!DeltaFile->Flush()) {
+    throw std::runtime_error("Could not write " + DeltaFileName);
+  }
+  DeltaFileSize = boost::filesystem::file_size(DeltaFileName);
+
+  if (IsSnapshot) {
+    SnapshotLines.swap(Lines);
+    SnapshotTimedLines.swap(TimedLines);
+    NumRecordsSinceSnapshot = 0;
+  } else {
+    ++NumRecordsSinceSnapshot;
+  }
+}
+
+
+void SegmentationWriter::DiscardIncompleteDeltaRecord()
+{
+  if (!DeltaFile) {
+    return;
+  }
+  DeltaFile->Close();
+  DeltaFile.reset();
+  boost::system::error_code Error;
+  boost::filesystem::resize_file(DeltaFileName, DeltaFileSize, Error);
+  if (Error) {
+    std::cerr << "  Could not truncate " << DeltaFileName << " to its last "
+              << "complete record: " << Error.message() << std::endl;
+  }
+  AppendToExistingDeltaFile = true;
+  SnapshotLines.clear();
+  SnapshotTimedLines.clear();
+  NumRecordsSinceSnapshot = 0;
+}
+
+
+void SegmentationWriter::ConvertDeltaFile(const std::string &DeltaFileName, const std::vector<std::string> &SentencesFileNames)
+{
+  DeltaFileReader Reader(DeltaFileName);
+  if ((Reader.Read<uint32_t>() != DELTA_FILE_MAGIC) ||
+      (Reader.Read<uint32_t>() != DELTA_FILE_VERSION)) {
+    throw std::runtime_error(DeltaFileName + " is not a segmentation delta file of version " + std::to_string(DELTA_FILE_VERSION));
+  }
+
+  std::vector<std::string> SnapshotLines;
+  std::vector<std::string> SnapshotTimedLines;
+  while (!Reader.AtEnd()) {
+    bool IsSnapshot = Reader.Read<uint8_t>();
+    std::string SentencesFileName = Reader.ReadString();
+    std::string TimedSentencesFileName = Reader.ReadString();
+    std::size_t NumSentences = Reader.Read<uint64_t>();
+    std::size_t NumStoredSentences = Reader.Read<uint64_t>();
+    if (!IsSnapshot && (NumSentences != SnapshotLines.size())) {
+      throw std::runtime_error("Record " + SentencesFileName + " in " + DeltaFileName + " does not match its snapshot");
+    }
+
+    std::vector<std::string> Lines;
+    std::vector<std::string> TimedLines;
+    if (IsSnapshot) {
+      Lines.resize(NumSentences);
+      TimedLines.resize(NumSentences);
+    } else {
+      Lines = SnapshotLines;
+      TimedLines = SnapshotTimedLines;
+    }
+    for (std::size_t IdxStored = 0; IdxStored < NumStoredSentences; ++IdxStored) {
+      std::size_t IdxSentence = Reader.Read<uint64_t>();
+      if (IdxSentence >= NumSentences) {
+        throw std::runtime_error("Invalid sentence index in " + DeltaFileName);
+      }
+      Lines[IdxSentence] = Reader.ReadString();
+      TimedLines[IdxSentence] = Reader.ReadString();
+    }
+
+    if (SentencesFileNames.empty() ||
+        (std::find(SentencesFileNames.begin(), SentencesFileNames.end(),
+                   SentencesFileName) != SentencesFileNames.end())) {
+      std::cout << "Writing " << SentencesFileName << std::endl;
+      WriteLinesToFile(SentencesFileName, Lines, UNCOMPRESSED);
+      if (!TimedSentencesFileName.empty()) {
+        std::cout << "Writing " << TimedSentencesFileName << std::endl;
+        WriteLinesToFile(TimedSentencesFileName, TimedLines, UNCOMPRESSED);
+      }
+    }
+
+    if (IsSnapshot) {
+      SnapshotLines.swap(Lines);
+      SnapshotTimedLines.swap(TimedLines);
+    }
+  }
+}
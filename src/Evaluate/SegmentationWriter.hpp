@@ -0,0 +1,179 @@
+// ----------------------------------------------------------------------------
+/**
+   File: SegmentationWriter.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: asynchronous writing of the sampled segmentations of the iterations
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _SEGMENTATIONWRITER_HPP_
+#define _SEGMENTATIONWRITER_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "definitions.hpp"
+#include "../FileReader/CompressedOutput.hpp"
+
+/* writes the sampled segmentations of the iterations in a dedicated thread.
+   In text format each iteration is written to its own (compressed) text
+   files. In delta format all iterations are appended to one (compressed)
+   binary file. Every SnapshotInterval-th record is a full snapshot, the
+   others only store the sentences whose text changed since the last
+   snapshot. ConvertDeltaFile regenerates the text files from it */
+class SegmentationWriter {
+  /* segmentation of an iteration waiting to be written */
+  struct WriteJob {
+    std::string SentencesFileName;
+    std::string TimedSentencesFileName;                  // empty if there are no timings
+    std::vector<std::vector<int> > Sentences;
+    std::vector<std::vector<ArcInfo> > TimedSentences;
+    std::vector<std::string> Id2CharacterSequence;
+  };
+
+  // maximum number of segmentations waiting to be written
+  static const std::size_t MAX_PENDING_WRITES = 2;
+
+  // identification and version of the delta file format
+  static const uint32_t DELTA_FILE_MAGIC = 0x4453574c; // "LWSD"
+  static const uint32_t DELTA_FILE_VERSION = 1;
+
+  const SegmentationOutputFormats Format;
+  const CompressionTypes Compression;
+  const unsigned int SnapshotInterval;
+  const std::string DeltaFileName;
+  const std::vector<std::string> &InputFileNames;
+  bool AppendToExistingDeltaFile;                      // continue the delta file (of a resumed run or after a failed write)
+
+  // state of the delta file, only used by the writer thread
+  std::unique_ptr<CompressingWriter> DeltaFile;
+  uint64_t DeltaFileSize;                              // size of the delta file up to the last complete record
+  std::vector<std::string> SnapshotLines;              // sentence lines of the last snapshot
+  std::vector<std::string> SnapshotTimedLines;         // timed sentence lines of the last snapshot
+  unsigned int NumRecordsSinceSnapshot;
+
+  std::thread WriterThread;
+  std::mutex JobsMutex;
+  std::condition_variable JobsCondition;
+  std::deque<std::unique_ptr<WriteJob> > Jobs;         // queued jobs, the front one is being written
+  bool StopWriterThread;
+  std::exception_ptr WriteError;                       // first failed write, rethrown by Flush
+
+
+  /* internal functions */
+  void WriterThreadFn();
+
+  // get the text lines of each sentence as written to the text files
+  void FormatSentences(
+    const WriteJob &Job,
+    std::vector<std::string> *Lines,
+    std::vector<std::string> *TimedLines
+  ) const;
+
+  void WriteTextFiles(
+    const WriteJob &Job
+  ) const;
+
+  void AppendToDeltaFile(
+    const WriteJob &Job
+  );
+
+  // close the delta file after a failed write and truncate it to the last
+  // complete record. The next record is appended as a snapshot
+  void DiscardIncompleteDeltaRecord();
+
+  // write the concatenated lines to FileName, creating its directory
+  static void WriteLinesToFile(
+    const std::string &FileName,
+    const std::vector<std::string> &Lines,
+    CompressionTypes Compression
+  );
+
+public:
+  /* constructor */
+  // with AppendToExistingDeltaFile_ the records are appended to an
+  // existing delta file instead of replacing it
+  SegmentationWriter(
+    SegmentationOutputFormats Format_,
+    CompressionTypes Compression_,
+    unsigned int SnapshotInterval_,
+    const std::string &DeltaFileName_,
+    const std::vector<std::string> &InputFileNames_,
+    bool AppendToExistingDeltaFile_ = false
+  );
+
+  // write all queued segmentations and stop the writer thread
+  ~SegmentationWriter();
+
+
+  /* interface */
+  // queue the segmentation of an iteration for writing, waits if too many
+  // segmentations are queued already. No timed sentences are written if
+  // TimedSentencesFileName is empty
+  void Write(
+    const std::string &SentencesFileName,
+    const std::string &TimedSentencesFileName,
+    const std::vector<std::vector<int> > &Sentences,
+    const std::vector<std::vector<ArcInfo> > &TimedSentences,
+    const std::vector<std::string> &Id2CharacterSequence
+  );
+
+  // wait until all queued segmentations are written, rethrows the
+  // exception of the first failed write
+  void Flush();
+
+  // write the text files of the records in delta file DeltaFileName whose
+  // sentences file name is in SentencesFileNames (all if empty)
+  static void ConvertDeltaFile(
+    const std::string &DeltaFileName,
+    const std::vector<std::string> &SentencesFileNames
+  );
+};
+
+#endif
@@ -0,0 +1,107 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CharacterNGrams.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include "CharacterNGrams.hpp"
+
+void CharacterNGrams::Collect(const LogExpandedFst &Fst)
+{
+  // the composition matches the output labels of the input with the lexicon,
+  // so collect for every state the first output labels reachable over
+  // epsilon output arcs
+  std::vector<std::vector<CharId> > FirstLabels(Fst.NumStates());
+  std::vector<StateId> VisitedFrom(Fst.NumStates(), fst::kNoStateId);
+  for (StateId s = 0; s < Fst.NumStates(); ++s) {
+    std::vector<StateId> StateStack(1, s);
+    VisitedFrom[s] = s;
+    while (!StateStack.empty()) {
+      StateId CurrentState = StateStack.back();
+      StateStack.pop_back();
+      for (fst::ArcIterator<LogExpandedFst> aiter(Fst, CurrentState); !aiter.Done(); aiter.Next()) {
+        const fst::LogArc &arc = aiter.Value();
+        if (arc.olabel != EPS_SYMBOLID) {
+          FirstLabels[s].push_back(arc.olabel);
+        } else if (VisitedFrom[arc.nextstate] != s) {
+          VisitedFrom[arc.nextstate] = s;
+          StateStack.push_back(arc.nextstate);
+        }
+      }
+    }
+    std::sort(FirstLabels[s].begin(), FirstLabels[s].end());
+    FirstLabels[s].erase(std::unique(FirstLabels[s].begin(), FirstLabels[s].end()), FirstLabels[s].end());
+  }
+
+  // collect unigrams and bigrams of output labels
+  Unigrams.clear();
+  Bigrams.clear();
+  for (StateId s = 0; s < Fst.NumStates(); ++s) {
+    for (fst::ArcIterator<LogExpandedFst> aiter(Fst, s); !aiter.Done(); aiter.Next()) {
+      const fst::LogArc &arc = aiter.Value();
+      if (arc.olabel != EPS_SYMBOLID) {
+        Unigrams.push_back(arc.olabel);
+        for (CharId NextLabel : FirstLabels[arc.nextstate]) {
+          Bigrams.push_back(BigramKey(arc.olabel, NextLabel));
+        }
+      }
+    }
+  }
+  std::sort(Unigrams.begin(), Unigrams.end());
+  Unigrams.erase(std::unique(Unigrams.begin(), Unigrams.end()), Unigrams.end());
+  std::sort(Bigrams.begin(), Bigrams.end());
+  Bigrams.erase(std::unique(Bigrams.begin(), Bigrams.end()), Bigrams.end());
+}
+
+bool CharacterNGrams::MayContain(const std::vector<CharId> &Prefix) const
+{
+  if (Prefix.size() == 1) {
+    return std::binary_search(Unigrams.begin(), Unigrams.end(), Prefix[0]);
+  }
+  for (std::size_t IdxChar = 1; IdxChar < Prefix.size(); ++IdxChar) {
+    if (!std::binary_search(Bigrams.begin(), Bigrams.end(), BigramKey(Prefix[IdxChar - 1], Prefix[IdxChar]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t CharacterNGrams::BigramKey(CharId First, CharId Second)
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(First)) << 32) | static_cast<uint32_t>(Second);
+}
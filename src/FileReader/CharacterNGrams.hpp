@@ -0,0 +1,83 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CharacterNGrams.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: character unigrams and bigrams of input fsts
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _CHARACTERNGRAMS_HPP_
+#define _CHARACTERNGRAMS_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "definitions.hpp"
+
+/* output label unigrams and bigrams of an input fst, used to find the
+ * sentences in which a word prefix may occur */
+struct CharacterNGrams {
+  std::vector<CharId> Unigrams;   // sorted output labels
+  std::vector<uint64_t> Bigrams;  // sorted keys of consecutive output labels (across epsilon arcs)
+
+  // collect the unigrams and bigrams of the output labels of Fst
+  void Collect(
+    const LogExpandedFst &Fst
+  );
+
+  // check if the unigram of a one character prefix or all bigrams of a
+  // longer prefix are contained
+  bool MayContain(
+    const std::vector<CharId> &Prefix
+  ) const;
+
+  // combine two characters to a bigram key
+  static uint64_t BigramKey(
+    CharId First,
+    CharId Second
+  );
+};
+
+#endif
@@ -0,0 +1,529 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CompressedInput.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+#include <boost/filesystem/path.hpp>
+#include "CompressedInput.hpp"
+
+CompressionTypes DetectCompression(const char *Data, std::size_t Size)
+{
+  if (Size >= 2 && std::memcmp(Data, "\x1f\x8b", 2) == 0) {
+    return GZIP;
+  } else if (Size >= 3 && std::memcmp(Data, "BZh", 3) == 0) {
+    return BZIP2;
+  } else if (Size >= 6 && std::memcmp(Data, "\xfd" "7zXZ\0", 6) == 0) {
+    return XZ;
+  }
+  return UNCOMPRESSED;
+}
+
+CompressionTypes DetectCompression(const char *Data, std::size_t Size,
+                                   const std::string &FileName)
+{
+  CompressionTypes SuffixCompression = UNCOMPRESSED;
+  for (const auto &Suffix : std::vector<std::pair<const char *, CompressionTypes> >{
+         {".gz", GZIP}, {".tgz", GZIP}, {".bz2", BZIP2}, {".tbz2", BZIP2},
+         {".tbz", BZIP2}, {".xz", XZ}, {".txz", XZ}}) {
+    std::size_t Length = std::strlen(Suffix.first);
+    if (FileName.size() >= Length &&
+        FileName.compare(FileName.size() - Length, Length, Suffix.first) == 0) {
+      SuffixCompression = Suffix.second;
+    }
+  }
+  if (DetectCompression(Data, Size) != SuffixCompression) {
+    return UNCOMPRESSED;
+  }
+  return SuffixCompression;
+}
+
+
+/* interface of the decoders for the different compressions */
+struct StreamDecoder {
+  const char *InputPos;                // next compressed byte to be decoded
+  const char *InputEnd;                // end of compressed data
+  bool Finished;                       // end of compressed data reached
+
+  StreamDecoder(const char *Data, std::size_t Size) :
+    InputPos(Data),
+    InputEnd(Data + Size),
+    Finished(Size == 0)
+  {
+  }
+
+  virtual ~StreamDecoder()
+  {
+  }
+
+  // get next chunk of at most MaxSize compressed bytes
+  std::size_t NextChunk(const char **Chunk, std::size_t MaxSize)
+  {
+    std::size_t ChunkSize =
+      std::min<std::size_t>(InputEnd - InputPos, MaxSize);
+    *Chunk = InputPos;
+    InputPos += ChunkSize;
+    return ChunkSize;
+  }
+
+  virtual std::size_t Read(char *Buffer, std::size_t Size) = 0;
+};
+
+namespace {
+
+/* copies uncompressed data */
+struct PlainDecoder : public StreamDecoder {
+  PlainDecoder(const char *Data, std::size_t Size) :
+    StreamDecoder(Data, Size)
+  {
+  }
+
+  std::size_t Read(char *Buffer, std::size_t Size)
+  {
+    const char *Chunk;
+    std::size_t ChunkSize = NextChunk(&Chunk, Size);
+    std::memcpy(Buffer, Chunk, ChunkSize);
+    return ChunkSize;
+  }
+};
+
+/* zlib based gzip decoder */
+struct GzipDecoder : public StreamDecoder {
+  z_stream Stream;
+
+  GzipDecoder(const char *Data, std::size_t Size) :
+    StreamDecoder(Data, Size)
+  {
+    std::memset(&Stream, 0, sizeof(Stream));
+    // 15 + 32: maximum window size with automatic gzip header detection
+    if (inflateInit2(&Stream, 15 + 32) != Z_OK) {
+      throw std::runtime_error("Could not initialize gzip decoder");
+    }
+  }
+
+  ~GzipDecoder()
+  {
+    inflateEnd(&Stream);
+  }
+
+  std::size_t Read(char *Buffer, std::size_t Size)
+  {
+    Stream.next_out = reinterpret_cast<Bytef *>(Buffer);
+    Stream.avail_out = std::min<std::size_t>(Size, UINT_MAX);
+    std::size_t RequestedSize = Stream.avail_out;
+    while (Stream.avail_out > 0 && !Finished) {
+      if (Stream.avail_in == 0) {
+        const char *Chunk;
+        Stream.avail_in = NextChunk(&Chunk, UINT_MAX);
+        Stream.next_in =
+          reinterpret_cast<Bytef *>(const_cast<char *>(Chunk));
+        if (Stream.avail_in == 0) {
+          throw std::runtime_error("Unexpected end of gzip data");
+        }
+      }
+      int Ret = inflate(&Stream, Z_NO_FLUSH);
+      if (Ret == Z_STREAM_END) {
+        // continue with the next gzip member if there is one
+        if (Stream.avail_in == 0 && InputPos == InputEnd) {
+          Finished = true;
+        } else {
+          inflateReset(&Stream);
+        }
+      } else if (Ret != Z_OK && Ret != Z_BUF_ERROR) {
+        throw std::runtime_error("Corrupted gzip data");
+      }
+    }
+    return RequestedSize - Stream.avail_out;
+  }
+};
+
+/* libbz2 based bzip2 decoder */
+struct Bzip2Decoder : public StreamDecoder {
+  bz_stream Stream;
+
+  Bzip2Decoder(const char *Data, std::size_t Size) :
+    StreamDecoder(Data, Size)
+  {
+    std::memset(&Stream, 0, sizeof(Stream));
+    if (BZ2_bzDecompressInit(&Stream, 0, 0) != BZ_OK) {
+      throw std::runtime_error("Could not initialize bzip2 decoder");
+    }
+  }
+
+  ~Bzip2Decoder()
+  {
+    BZ2_bzDecompressEnd(&Stream);
+  }
+
+  std::size_t Read(char *Buffer, std::size_t Size)
+  {
+    Stream.next_out = Buffer;
+    Stream.avail_out = std::min<std::size_t>(Size, UINT_MAX);
+    std::size_t RequestedSize = Stream.avail_out;
+    while (Stream.avail_out > 0 && !Finished) {
+      if (Stream.avail_in == 0) {
+        const char *Chunk;
+        Stream.avail_in = NextChunk(&Chunk, UINT_MAX);
+        Stream.next_in = const_cast<char *>(Chunk);
+        if (Stream.avail_in == 0) {
+          throw std::runtime_error("Unexpected end of bzip2 data");
+        }
+      }
+      int Ret = BZ2_bzDecompress(&Stream);
+      if (Ret == BZ_STREAM_END) {
+        // continue with the next bzip2 stream if there is one
+        if (Stream.avail_in == 0 && InputPos == InputEnd) {
+          Finished = true;
+        } else {
+          char *NextIn = Stream.next_in;
+          unsigned int AvailIn = Stream.avail_in;
+          char *NextOut = Stream.next_out;
+          unsigned int AvailOut = Stream.avail_out;
+          BZ2_bzDecompressEnd(&Stream);
+          std::memset(&Stream, 0, sizeof(Stream));
+          if (BZ2_bzDecompressInit(&Stream, 0, 0) != BZ_OK) {
+            throw std::runtime_error("Could not initialize bzip2 decoder");
+          }
+          Stream.next_in = NextIn;
+          Stream.avail_in = AvailIn;
+          Stream.next_out = NextOut;
+          Stream.avail_out = AvailOut;
+        }
+      } else if (Ret != BZ_OK) {
+        throw std::runtime_error("Corrupted bzip2 data");
+      }
+    }
+    return RequestedSize - Stream.avail_out;
+  }
+};
+
+/* liblzma based xz decoder */
+struct XzDecoder : public StreamDecoder {
+  lzma_stream Stream;
+
+  XzDecoder(const char *Data, std::size_t Size) :
+    StreamDecoder(Data, Size),
+    Stream(LZMA_STREAM_INIT)
+  {
+    if (lzma_stream_decoder(&Stream, UINT64_MAX, LZMA_CONCATENATED) !=
+        LZMA_OK) {
+      throw std::runtime_error("Could not initialize xz decoder");
+    }
+    const char *Chunk;
+    Stream.avail_in = NextChunk(&Chunk, Size);
+    Stream.next_in = reinterpret_cast<const uint8_t *>(Chunk);
+  }
+
+  ~XzDecoder()
+  {
+    lzma_end(&Stream);
+  }
+
+  std::size_t Read(char *Buffer, std::size_t Size)
+  {
+    Stream.next_out = reinterpret_cast<uint8_t *>(Buffer);
+    Stream.avail_out = Size;
+    while (Stream.avail_out > 0 && !Finished) {
+      lzma_ret Ret = lzma_code(&Stream, LZMA_FINISH);
+      if (Ret == LZMA_STREAM_END) {
+        Finished = true;
+      } else if (Ret != LZMA_OK) {
+        throw std::runtime_error("Corrupted xz data");
+      }
+    }
+    return Size - Stream.avail_out;
+  }
+};
+
+} // namespace
+
+
+DecompressingReader::DecompressingReader(const char *Data, std::size_t Size) :
+  DecompressingReader(Data, Size, DetectCompression(Data, Size))
+{
+}
+
+DecompressingReader::DecompressingReader(const char *Data, std::size_t Size,
+                                         CompressionTypes Compression)
+{
+  switch (Compression) {
+  case GZIP:
+    Decoder.reset(new GzipDecoder(Data, Size));
+    break;
+  case BZIP2:
+    Decoder.reset(new Bzip2Decoder(Data, Size));
+    break;
+  case XZ:
+    Decoder.reset(new XzDecoder(Data, Size));
+    break;
+  default:
+    Decoder.reset(new PlainDecoder(Data, Size));
+  }
+}
+
+DecompressingReader::~DecompressingReader()
+{
+}
+
+std::size_t DecompressingReader::Read(char *Buffer, std::size_t Size)
+{
+  return Decoder->Read(Buffer, Size);
+}
+
+void DecompressingReader::ReadAll(std::string *Contents)
+{
+  const std::size_t CHUNK_SIZE = 1 << 20;
+  std::size_t ContentsSize = Contents->size();
+  for (std::size_t NumRead = 1; NumRead > 0; ContentsSize += NumRead) {
+    Contents->resize(ContentsSize + CHUNK_SIZE);
+    NumRead = Read(&(*Contents)[ContentsSize], CHUNK_SIZE);
+  }
+  Contents->resize(ContentsSize);
+}
+
+
+TarReader::TarReader(const std::string &FileName) :
+  File(FileName),
+  Reader(File.GetData(), File.GetSize(),
+         DetectCompression(File.GetData(), File.GetSize(), FileName))
+{
+}
+
+void TarReader::ReadFully(char *Buffer, std::size_t Size)
+{
+  while (Size > 0) {
+    std::size_t NumRead = Reader.Read(Buffer, Size);
+    if (NumRead == 0) {
+      throw std::runtime_error("Unexpected end of tar archive");
+    }
+    Buffer += NumRead;
+    Size -= NumRead;
+  }
+}
+
+void TarReader::Skip(std::size_t Size)
+{
+  char Buffer[4096];
+  while (Size > 0) {
+    std::size_t ChunkSize = std::min(Size, sizeof(Buffer));
+    ReadFully(Buffer, ChunkSize);
+    Size -= ChunkSize;
+  }
+}
+
+bool TarReader::Next(std::string *Name, std::string *Contents)
+{
+  const std::size_t BLOCK_SIZE = 512;
+  std::string LongName;
+  for (;;) {
+    // read the header, an empty block marks the end of the archive
+    char Header[BLOCK_SIZE];
+    std::size_t NumRead = Reader.Read(Header, BLOCK_SIZE);
+    if (NumRead == 0) {
+      return false;
+    }
+    if (NumRead < BLOCK_SIZE) {
+      ReadFully(Header + NumRead, BLOCK_SIZE - NumRead);
+    }
+    if (std::all_of(Header, Header + BLOCK_SIZE,
+                    [](char c) { return c == 0; })) {
+      return false;
+    }
+
+    // size is octal or base-256 for large files
+    std::size_t Size = 0;
+    if (Header[124] & 0x80) {
+      for (int Idx = 125; Idx < 136; ++Idx) {
+        Size = (Size << 8) | static_cast<unsigned char>(Header[Idx]);
+      }
+    } else {
+      for (int Idx = 124; Idx < 136 && Header[Idx] != 0; ++Idx) {
+        if (Header[Idx] >= '0' && Header[Idx] <= '7') {
+          Size = (Size << 3) | (Header[Idx] - '0');
+        }
+      }
+    }
+    std::size_t Padding = (BLOCK_SIZE - Size % BLOCK_SIZE) % BLOCK_SIZE;
+    char Type = Header[156];
+
+    if (Type == 'L' || Type == 'x') {
+      // gnu long name or pax extended header for the next entry
+      std::string Data(Size, '\0');
+      ReadFully(&Data[0], Size);
+      Skip(Padding);
+      if (Type == 'L') {
+        LongName = Data.c_str();
+      } else {
+        // pax records have the format "length key=value\n"
+        for (std::size_t Pos = 0; Pos < Data.size(); ) {
+          std::size_t Length = std::strtoul(Data.c_str() + Pos, NULL, 10);
+          if (Length == 0) {
+            break;
+          }
+          std::size_t KeyPos = Data.find(' ', Pos) + 1;
+          if (Data.compare(KeyPos, 5, "path=") == 0) {
+            LongName = Data.substr(KeyPos + 5, Pos + Length - KeyPos - 6);
+          }
+          Pos += Length;
+        }
+      }
+    } else if (Type == '0' || Type == '\0' || Type == '7') {
+      // regular file
+      if (!LongName.empty()) {
+        *Name = LongName;
+      } else {
+        *Name = std::string(Header, strnlen(Header, 100));
+        if (std::memcmp(Header + 257, "ustar", 5) == 0 && Header[345] != 0) {
+          *Name = std::string(Header + 345, strnlen(Header + 345, 155)) +
+                  "/" + *Name;
+        }
+      }
+      Contents->resize(Size);
+      ReadFully(&(*Contents)[0], Size);
+      Skip(Padding);
+      return true;
+    } else {
+      // directories, links, global headers, ...
+      Skip(Size + Padding);
+      LongName.clear();
+    }
+  }
+}
+
+
+InputSource::InputSource(const std::vector<std::string> &Files) :
+  Files(Files),
+  NextFile(0)
+{
+}
+
+bool InputSource::NextBlock(std::size_t MaxItems,
+                            std::vector<InputItem> *Items)
+{
+  Items->clear();
+  while (Items->size() < MaxItems) {
+    if (Archive) {
+      InputItem Item;
+      std::string MemberName;
+      if (Archive->Next(&MemberName, &Item.Contents)) {
+        Item.Path = ArchiveName + ":" + MemberName;
+        Item.Name = StripCompressionSuffix(
+          boost::filesystem::path(MemberName).filename().string());
+        Item.InMemory = true;
+        Items->push_back(std::move(Item));
+      } else {
+        Archive.reset();
+      }
+    } else if (NextFile < Files.size()) {
+      const std::string &FileName = Files[NextFile++];
+      if (IsTarArchive(FileName)) {
+        ArchiveName = FileName;
+        Archive.reset(new TarReader(FileName));
+      } else {
+        InputItem Item;
+        Item.Path = FileName;
+        Item.Name = StripCompressionSuffix(
+          boost::filesystem::path(FileName).filename().string());
+        Item.InMemory = false;
+        Items->push_back(std::move(Item));
+      }
+    } else {
+      break;
+    }
+  }
+  return !Items->empty();
+}
+
+bool InputSource::IsTarArchive(const std::string &FileName)
+{
+  for (const char *Suffix : {".tar", ".tar.gz", ".tgz", ".tar.bz2", ".tbz2",
+                             ".tbz", ".tar.xz", ".txz"}) {
+    std::size_t Length = std::strlen(Suffix);
+    if (FileName.size() >= Length &&
+        FileName.compare(FileName.size() - Length, Length, Suffix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string InputSource::StripCompressionSuffix(const std::string &FileName)
+{
+  for (const char *Suffix : {".gz", ".bz2", ".xz"}) {
+    std::size_t Length = std::strlen(Suffix);
+    if (FileName.size() > Length &&
+        FileName.compare(FileName.size() - Length, Length, Suffix) == 0) {
+      return FileName.substr(0, FileName.size() - Length);
+    }
+  }
+  return FileName;
+}
+
+
+InputItemData::InputItemData(const InputItem &Item) :
+  Data(NULL),
+  Size(0),
+  Stream(&Buffer)
+{
+  if (Item.InMemory) {
+    Data = Item.Contents.data();
+    Size = Item.Contents.size();
+  } else {
+    File.reset(new MappedFile(Item.Path));
+    Data = File->GetData();
+    Size = File->GetSize();
+  }
+
+  // decompress into memory if necessary (tar members are checked by the
+  // suffix of their name at the end of the path)
+  CompressionTypes Compression = DetectCompression(Data, Size, Item.Path);
+  if (Compression != UNCOMPRESSED) {
+    DecompressingReader Reader(Data, Size, Compression);
+    Reader.ReadAll(&Decompressed);
+    File.reset();
+    Data = Decompressed.data();
+    Size = Decompressed.size();
+  }
+  Buffer.Set(Data, Size);
+}
@@ -0,0 +1,236 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CompressedInput.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: reading of gzip, bzip2 and xz compressed input files and tar archives
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _COMPRESSEDINPUT_HPP_
+#define _COMPRESSEDINPUT_HPP_
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../Utils/MappedFile.hpp"
+
+enum CompressionTypes {UNCOMPRESSED, GZIP, BZIP2, XZ}; // supported compressions
+
+// detect the compression of a buffer from its magic bytes
+CompressionTypes DetectCompression(
+  const char *Data,
+  std::size_t Size
+);
+
+// detect the compression of the contents of file FileName, the magic bytes
+// have to agree with the suffix (.gz, .bz2, .xz, .tgz, ...), otherwise the
+// contents are uncompressed (e.g. a text file starting with "BZh")
+CompressionTypes DetectCompression(
+  const char *Data,
+  std::size_t Size,
+  const std::string &FileName
+);
+
+// decoder for a specific compression (defined in CompressedInput.cpp)
+struct StreamDecoder;
+
+/* streaming decompression of a gzip, bzip2 or xz compressed buffer,
+ * concatenated streams (e.g. from pigz or pbzip2) are supported */
+class DecompressingReader {
+  std::unique_ptr<StreamDecoder> Decoder; // decoder for detected compression
+
+public:
+  /* constructor */
+  // decompress the Size bytes at Data (has to stay valid while reading),
+  // the compression is detected from the magic bytes
+  DecompressingReader(
+    const char *Data,
+    std::size_t Size
+  );
+
+  // decompress the Size bytes at Data with the given compression
+  DecompressingReader(
+    const char *Data,
+    std::size_t Size,
+    CompressionTypes Compression
+  );
+
+  /* destructor */
+  ~DecompressingReader();
+
+  /* interface */
+  // read up to Size decompressed bytes into Buffer, returns the number of
+  // bytes read (0 at the end of the data), throws std::runtime_error on
+  // corrupted data
+  std::size_t Read(
+    char *Buffer,
+    std::size_t Size
+  );
+
+  // read all remaining decompressed data into Contents
+  void ReadAll(
+    std::string *Contents
+  );
+};
+
+/* sequential reader for the regular files of a (compressed) tar archive */
+class TarReader {
+  MappedFile File;                     // mapped archive
+  DecompressingReader Reader;          // decompressed archive data
+
+  // read exactly Size bytes, throws std::runtime_error at the end of data
+  void ReadFully(
+    char *Buffer,
+    std::size_t Size
+  );
+
+  // skip Size bytes
+  void Skip(
+    std::size_t Size
+  );
+
+public:
+  /* constructor */
+  // open archive FileName
+  TarReader(
+    const std::string &FileName
+  );
+
+  /* interface */
+  // read the next regular file, returns false at the end of the archive
+  bool Next(
+    std::string *Name,
+    std::string *Contents
+  );
+};
+
+// a single input file, either a (compressed) file on disk or a member of
+// a tar archive that has already been read into memory
+struct InputItem {
+  std::string Path;                    // path used in messages
+  std::string Name;                    // file name without compression suffix
+  bool InMemory;                       // contents have been read already
+  std::string Contents;                // contents if InMemory
+};
+
+/* sequence of input items for a list of input files in which tar archives
+ * are expanded into their members without unpacking them to disk */
+class InputSource {
+  const std::vector<std::string> Files; // input files and archives
+  std::size_t NextFile;                // index of next file in Files
+  std::string ArchiveName;             // name of the currently read archive
+  std::unique_ptr<TarReader> Archive;  // currently read archive
+
+public:
+  /* constructor */
+  // iterate over the items of Files
+  InputSource(
+    const std::vector<std::string> &Files
+  );
+
+  /* interface */
+  // get the next up to MaxItems items in input order, returns false if
+  // there are no more items
+  bool NextBlock(
+    std::size_t MaxItems,
+    std::vector<InputItem> *Items
+  );
+
+  // check if FileName is a (compressed) tar archive by its suffix
+  static bool IsTarArchive(
+    const std::string &FileName
+  );
+
+  // remove .gz, .bz2 or .xz from FileName
+  static std::string StripCompressionSuffix(
+    const std::string &FileName
+  );
+};
+
+/* decompressed contents of an input item, files on disk are mapped and
+ * only decompressed into memory if they are compressed */
+class InputItemData {
+  /* read only stream buffer over a memory range */
+  class MemoryStreamBuf : public std::streambuf {
+  public:
+    void Set(const char *Data, std::size_t Size) {
+      char *Begin = const_cast<char *>(Data);
+      setg(Begin, Begin, Begin + Size);
+    }
+  };
+
+  std::unique_ptr<MappedFile> File;    // mapped file if not in memory
+  std::string Decompressed;            // decompressed data if compressed
+  const char *Data;                    // begin of the data
+  std::size_t Size;                    // size of the data
+  MemoryStreamBuf Buffer;              // stream buffer over the data
+  std::istream Stream;                 // stream over the data
+
+public:
+  /* constructor */
+  // make the contents of Item available (Item has to outlive this object)
+  InputItemData(
+    const InputItem &Item
+  );
+
+  /* interface */
+  const char *GetData() const {
+    return Data;
+  }
+
+  std::size_t GetSize() const {
+    return Size;
+  }
+
+  // get an input stream over the data
+  std::istream &GetStream() {
+    return Stream;
+  }
+};
+
+#endif
@@ -0,0 +1,196 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CompressedOutput.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+#include "CompressedOutput.hpp"
+
+/* interface of the encoders for the different compressions */
+struct StreamEncoder {
+  virtual ~StreamEncoder()
+  {
+  }
+
+  // append the compressed Data to Output, finishing the stream if requested
+  virtual void Encode(const char *Data, std::size_t Size, bool FinishStream,
+                      std::string *Output) = 0;
+};
+
+namespace {
+
+/* zlib based gzip encoder */
+struct GzipEncoder : public StreamEncoder {
+  z_stream Stream;
+
+  GzipEncoder()
+  {
+    std::memset(&Stream, 0, sizeof(Stream));
+    // 15 + 16: maximum window size with gzip header
+    if (deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw std::runtime_error("Could not initialize gzip encoder");
+    }
+  }
+
+  ~GzipEncoder()
+  {
+    deflateEnd(&Stream);
+  }
+
+  void Encode(const char *Data, std::size_t Size, bool FinishStream,
+              std::string *Output)
+  {
+    char OutputChunk[1 << 16];
+    while (true) {
+      if (Stream.avail_in == 0 && Size > 0) {
+        std::size_t ChunkSize = std::min<std::size_t>(Size, UINT_MAX);
+        Stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(Data));
+        Stream.avail_in = ChunkSize;
+        Data += ChunkSize;
+        Size -= ChunkSize;
+      }
+      int Flush = (Size == 0 && FinishStream) ? Z_FINISH : Z_NO_FLUSH;
+      Stream.next_out = reinterpret_cast<Bytef *>(OutputChunk);
+      Stream.avail_out = sizeof(OutputChunk);
+      int Ret = deflate(&Stream, Flush);
+      if (Ret == Z_STREAM_ERROR) {
+        throw std::runtime_error("Gzip compression failed");
+      }
+      Output->append(OutputChunk, sizeof(OutputChunk) - Stream.avail_out);
+      if (Ret == Z_STREAM_END) {
+        // the next data starts a new gzip member
+        deflateReset(&Stream);
+        return;
+      }
+      if (Flush == Z_NO_FLUSH && Stream.avail_in == 0 && Size == 0 &&
+          Stream.avail_out > 0) {
+        return;
+      }
+    }
+  }
+};
+
+} // namespace
+
+
+CompressingWriter::CompressingWriter(const std::string &FileName, CompressionTypes Compression, std::size_t BufferSize_, bool Append) :
+  Out(FileName, Append ? std::ios::binary | std::ios::app : std::ios::binary),
+  BufferSize(BufferSize_),
+  HasUnfinishedStream(false)
+{
+  if (!Out) {
+    throw std::runtime_error("Could not open " + FileName + " for writing");
+  }
+  switch (Compression) {
+    case UNCOMPRESSED:
+      break;
+    case GZIP:
+      Encoder.reset(new GzipEncoder());
+      break;
+    default:
+      throw std::runtime_error("Only gzip compression is supported for writing " + FileName);
+  }
+  Buffer.reserve(BufferSize);
+}
+
+
+CompressingWriter::~CompressingWriter()
+{
+  if (Out.is_open()) {
+    Close();
+  }
+}
+
+
+void CompressingWriter::WriteBuffer(bool FinishStream)
+{
+  if (Encoder) {
+    // do not start an empty gzip member
+    if (!HasUnfinishedStream && Buffer.empty()) {
+      return;
+    }
+    HasUnfinishedStream = !FinishStream;
+    std::string Compressed;
+    Encoder->Encode(Buffer.data(), Buffer.size(), FinishStream, &Compressed);
+    Out.write(Compressed.data(), Compressed.size());
+  } else {
+    Out.write(Buffer.data(), Buffer.size());
+  }
+  Buffer.clear();
+}
+
+
+void CompressingWriter::Write(const char *Data, std::size_t Size)
+{
+  if (Buffer.size() + Size > BufferSize) {
+    WriteBuffer(false);
+  }
+  Buffer.append(Data, Size);
+}
+
+
+void CompressingWriter::Write(const std::string &Data)
+{
+  Write(Data.data(), Data.size());
+}
+
+
+bool CompressingWriter::Flush()
+{
+  WriteBuffer(true);
+  Out.flush();
+  return !Out.fail();
+}
+
+
+bool CompressingWriter::Close()
+{
+  Flush();
+  Out.close();
+  return !Out.fail();
+}
+
+
+std::string CompressingWriter::GetSuffix(CompressionTypes Compression)
+{
+  return Compression == GZIP ? ".gz" : "";
+}
@@ -0,0 +1,117 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CompressedOutput.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: buffered writing of plain or gzip compressed output files
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _COMPRESSEDOUTPUT_HPP_
+#define _COMPRESSEDOUTPUT_HPP_
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include "CompressedInput.hpp"
+
+// encoder for a specific compression (defined in CompressedOutput.cpp)
+struct StreamEncoder;
+
+/* writes a plain or gzip compressed file through a large buffer. Each
+ * flush finishes a gzip member, so the data written up to the last flush
+ * can be read by DecompressingReader even if the file is not closed */
+class CompressingWriter {
+  std::ofstream Out;                       // output file
+  std::unique_ptr<StreamEncoder> Encoder;  // encoder (NULL if uncompressed)
+  std::string Buffer;                      // data not yet written
+  std::size_t BufferSize;                  // size at which the buffer is written
+  bool HasUnfinishedStream;                // data has been compressed since the last flush
+
+  // compress (if necessary) and write the buffer
+  void WriteBuffer(
+    bool FinishStream
+  );
+
+public:
+  /* constructor */
+  // open FileName for writing, only UNCOMPRESSED and GZIP are supported,
+  // throws std::runtime_error on failure. With Append the data is appended
+  // to an existing file (as new gzip members if compressed)
+  CompressingWriter(
+    const std::string &FileName,
+    CompressionTypes Compression,
+    std::size_t BufferSize_ = 1 << 22,
+    bool Append = false
+  );
+
+  /* destructor */
+  ~CompressingWriter();
+
+  /* interface */
+  // append data
+  void Write(
+    const char *Data,
+    std::size_t Size
+  );
+
+  void Write(
+    const std::string &Data
+  );
+
+  // write all buffered data and finish the current gzip member, returns
+  // false if a write failed
+  bool Flush();
+
+  // flush, close the file and check if all writes were successful
+  bool Close();
+
+  // get the file name suffix of a compression (".gz" for GZIP)
+  static std::string GetSuffix(
+    CompressionTypes Compression
+  );
+};
+
+#endif
@@ -41,6 +41,8 @@
    Author: Thomas Glarner
 */
 // ----------------------------------------------------------------------------
+#include <iostream>
+#include <utility>
 #include "FileData.hpp"
 
 FileData::FileData(StringToIntMapper GlobalStringToInt,
@@ -53,33 +55,22 @@ FileData::FileData(StringToIntMapper GlobalStringToInt,
                    std::vector<ArcInfo> InputArcInfos,
                    StringToIntMapper ReferenceStringToInt,
                    std::vector<LogVectorFst> ReferenceFsts,
-                   std::vector<std::string> ReferenceFileNames):
-  GlobalStringToInt(GlobalStringToInt),
-  InitStringToInt(InitStringToInt),
-  InitFsts(InitFsts),
-  InitFileNames(InitFileNames),
-  InputStringToInt(InputStringToInt),
-  InputFsts(InputFsts),
-  InputFileNames(InputFileNames),
-  InputArcInfos(InputArcInfos),
-  ReferenceStringToInt(ReferenceStringToInt),
-  ReferenceFsts(ReferenceFsts),
-  ReferenceFileNames(ReferenceFileNames)
-{
-}
-
-FileData::FileData(const FileData& lhs):
-  GlobalStringToInt(lhs.GlobalStringToInt),
-  InitStringToInt(lhs.InitStringToInt),
-  InitFsts(lhs.InitFsts),
-  InitFileNames(lhs.InitFileNames),
-  InputStringToInt(lhs.InputStringToInt),
-  InputFsts(lhs.InputFsts),
-  InputFileNames(lhs.InputFileNames),
-  InputArcInfos(lhs.InputArcInfos),
-  ReferenceStringToInt(lhs.ReferenceStringToInt),
-  ReferenceFsts(lhs.ReferenceFsts),
-  ReferenceFileNames(lhs.ReferenceFileNames)
+                   std::vector<std::string> ReferenceFileNames,
+                   std::shared_ptr<LatticeStore> InputLatticeStore,
+                   std::vector<CharacterNGrams> InputCharacterNGrams):
+  GlobalStringToInt(std::move(GlobalStringToInt)),
+  InitStringToInt(std::move(InitStringToInt)),
+  InitFsts(std::move(InitFsts)),
+  InitFileNames(std::move(InitFileNames)),
+  InputStringToInt(std::move(InputStringToInt)),
+  InputFsts(std::move(InputFsts)),
+  InputFileNames(std::move(InputFileNames)),
+  InputArcInfos(std::move(InputArcInfos)),
+  InputLatticeStore(std::move(InputLatticeStore)),
+  InputCharacterNGrams(std::move(InputCharacterNGrams)),
+  ReferenceStringToInt(std::move(ReferenceStringToInt)),
+  ReferenceFsts(std::move(ReferenceFsts)),
+  ReferenceFileNames(std::move(ReferenceFileNames))
 {
 }
 
@@ -101,9 +92,112 @@ const std::vector<std::string> &FileData::GetInitIntToStringVector() const
 }
 
 
-const std::vector<LogVectorFst> &FileData::GetInputFsts() const
+std::size_t FileData::GetNumBytes(const LogVectorFst &Fst)
+{
+  // every state is allocated separately and holds its arcs in a vector
+  std::size_t NumBytes = 0;
+  for (LogStateIterator siter(Fst); !siter.Done(); siter.Next()) {
+    NumBytes += sizeof(void *) + sizeof(fst::LogArc::Weight) +
+                2 * sizeof(std::size_t) + sizeof(std::vector<fst::LogArc>) +
+                Fst.NumArcs(siter.Value()) * sizeof(fst::LogArc);
+  }
+  return NumBytes;
+}
+
+
+std::size_t FileData::GetNumBytes(const LogConstFst &Fst)
+{
+  // one array of states (final weight, arc offset and three counts) and
+  // one array of arcs
+  std::size_t NumBytes = 0;
+  for (fst::StateIterator<LogConstFst> siter(Fst); !siter.Done(); siter.Next()) {
+    NumBytes += sizeof(fst::LogArc::Weight) + 4 * sizeof(uint32_t) +
+                Fst.NumArcs(siter.Value()) * sizeof(fst::LogArc);
+  }
+  return NumBytes;
+}
+
+
+void FileData::ConvertToConstFsts()
 {
-  return InputFsts;
+  std::size_t NumVectorBytes = 0;
+  std::size_t NumConstBytes = 0;
+
+  ConstInputFsts.reserve(ConstInputFsts.size() + InputFsts.size());
+  for (LogVectorFst &InputFst : InputFsts) {
+    NumVectorBytes += GetNumBytes(InputFst);
+    ConstInputFsts.emplace_back(InputFst);
+    NumConstBytes += GetNumBytes(ConstInputFsts.back());
+    // release each converted fst right away to keep the peak memory low
+    InputFst = LogVectorFst();
+  }
+  std::vector<LogVectorFst>().swap(InputFsts);
+
+  ConstInitFsts.reserve(ConstInitFsts.size() + InitFsts.size());
+  for (LogVectorFst &InitFst : InitFsts) {
+    NumVectorBytes += GetNumBytes(InitFst);
+    ConstInitFsts.emplace_back(InitFst);
+    NumConstBytes += GetNumBytes(ConstInitFsts.back());
+    InitFst = LogVectorFst();
+  }
+  std::vector<LogVectorFst>().swap(InitFsts);
+
+  std::cout << " Converted " << ConstInputFsts.size() << " input and "
+            << ConstInitFsts.size() << " initialization fsts to ConstFsts: "
+            << NumVectorBytes / (1024 * 1024) << " MB -> "
+            << NumConstBytes / (1024 * 1024) << " MB" << std::endl;
+}
+
+
+std::size_t FileData::GetNumInputFsts() const
+{
+  if (InputLatticeStore) {
+    return InputLatticeStore->GetNumFsts();
+  }
+  return ConstInputFsts.empty() ? InputFsts.size() : ConstInputFsts.size();
+}
+
+
+std::shared_ptr<const LogExpandedFst> FileData::GetInputFst(std::size_t Idx) const
+{
+  if (InputLatticeStore) {
+    return InputLatticeStore->Get(Idx);
+  }
+  // non-owning pointer to the fst held in memory
+  if (!ConstInputFsts.empty()) {
+    return std::shared_ptr<const LogExpandedFst>(
+      std::shared_ptr<const LogExpandedFst>(), &ConstInputFsts.at(Idx));
+  }
+  return std::shared_ptr<const LogExpandedFst>(
+    std::shared_ptr<const LogExpandedFst>(), &InputFsts.at(Idx));
+}
+
+
+CharacterNGrams FileData::GetInputCharacterNGrams(std::size_t Idx) const
+{
+  if (!InputCharacterNGrams.empty()) {
+    return InputCharacterNGrams.at(Idx);
+  }
+  CharacterNGrams NGrams;
+  NGrams.Collect(*GetInputFst(Idx));
+  return NGrams;
+}
+
+
+void FileData::PrefetchInputFsts(const std::vector<int> &Indices,
+                                 std::size_t Begin, std::size_t End) const
+{
+  if (InputLatticeStore) {
+    InputLatticeStore->Prefetch(Indices, Begin, End);
+  }
+}
+
+
+void FileData::PrintInputFstStatistics() const
+{
+  if (InputLatticeStore) {
+    InputLatticeStore->PrintStatistics();
+  }
 }
 
 
@@ -113,9 +207,18 @@ const std::vector<LogVectorFst> &FileData::GetReferenceFsts() const
 }
 
 
-const std::vector<LogVectorFst> &FileData::GetInitFsts() const
+std::size_t FileData::GetNumInitFsts() const
+{
+  return ConstInitFsts.empty() ? InitFsts.size() : ConstInitFsts.size();
+}
+
+
+const LogExpandedFst &FileData::GetInitFst(std::size_t Idx) const
 {
-  return InitFsts;
+  if (!ConstInitFsts.empty()) {
+    return ConstInitFsts.at(Idx);
+  }
+  return InitFsts.at(Idx);
 }
 
 
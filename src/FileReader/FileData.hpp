@@ -60,9 +60,12 @@
 #ifndef _FILEDATA_HPP_
 #define _FILEDATA_HPP_
 
+#include <memory>
 #include <fst/vector-fst.h>
 #include "definitions.hpp"
 #include "StringToIntMapper.hpp"
+#include "LatticeStore.hpp"
+#include "CharacterNGrams.hpp"
 
 class FileData{
   // a global string to int mapper which is updated with each reading process
@@ -71,22 +74,41 @@ class FileData{
   // members for initialization fsts
   StringToIntMapper InitStringToInt;
   std::vector<LogVectorFst> InitFsts;
+  // compact replacement of InitFsts after ConvertToConstFsts()
+  std::vector<LogConstFst> ConstInitFsts;
   // filename of read initialization files
   std::vector<std::string> InitFileNames;
 
   // membersf for input fsts
   StringToIntMapper InputStringToInt;
   std::vector<LogVectorFst> InputFsts;
+  // compact replacement of InputFsts after ConvertToConstFsts()
+  std::vector<LogConstFst> ConstInputFsts;
   std::vector<std::string> InputFileNames;
   std::vector<ArcInfo> InputArcInfos; // ArcInfo members: {label, start, end}
+  // on-disk store holding the input fsts in out-of-core mode (else NULL)
+  std::shared_ptr<LatticeStore> InputLatticeStore;
+  // character n-grams of the input fsts, collected while writing the
+  // lattice store (out-of-core mode with input lexicon cache, else empty)
+  std::vector<CharacterNGrams> InputCharacterNGrams;
 
   // members for reference fsts
   StringToIntMapper ReferenceStringToInt;
   std::vector<LogVectorFst> ReferenceFsts;
   std::vector<std::string> ReferenceFileNames;
 
+  // approximate number of bytes used by a fst
+  static std::size_t GetNumBytes(
+    const LogVectorFst &Fst
+  );
+
+  static std::size_t GetNumBytes(
+    const LogConstFst &Fst
+  );
+
 public:
-  /* Constructor */
+  /* Constructor (moves the corpus into the object, pass arguments with
+     std::move to avoid copies) */
   FileData(
     StringToIntMapper GlobalStringToInt,
     StringToIntMapper InitStringToInt,
@@ -98,12 +120,17 @@ public:
     std::vector<ArcInfo> InputArcInfos,
     StringToIntMapper ReferenceStringToInt,
     std::vector<LogVectorFst> ReferenceFsts,
-    std::vector<std::string> ReferenceFileNames
+    std::vector<std::string> ReferenceFileNames,
+    std::shared_ptr<LatticeStore> InputLatticeStore = nullptr,
+    std::vector<CharacterNGrams> InputCharacterNGrams = std::vector<CharacterNGrams>()
   );
 
 
-  /* Copy Constructor */
-  FileData(const FileData& lhs);
+  /* Copy Constructor (deleted, the corpus is only held once) */
+  FileData(const FileData& lhs) = delete;
+
+  /* Move Constructor */
+  FileData(FileData&& rhs) = default;
 
 
   /* interface */
@@ -116,11 +143,45 @@ public:
   // integer to string mapping for the init transcription (characters)
   const std::vector<std::string> &GetInitIntToStringVector() const;
 
-  const std::vector<LogVectorFst> &GetInputFsts() const;
+  // replace the in-memory input and initialization fsts by immutable
+  // ConstFsts with contiguous storage and print the memory savings
+  void ConvertToConstFsts();
+
+  // get number of input fsts (in memory or in the lattice store)
+  std::size_t GetNumInputFsts() const;
+
+  // get input fst Idx, read from the lattice store in out-of-core mode
+  // (thread safe)
+  std::shared_ptr<const LogExpandedFst> GetInputFst(
+    std::size_t Idx
+  ) const;
+
+  // get the character n-grams of input fst Idx (collected from the fst
+  // if they were not collected while writing the lattice store)
+  CharacterNGrams GetInputCharacterNGrams(
+    std::size_t Idx
+  ) const;
+
+  // request background loading of input fsts Indices[Begin, End) in
+  // out-of-core mode
+  void PrefetchInputFsts(
+    const std::vector<int> &Indices,
+    std::size_t Begin,
+    std::size_t End
+  ) const;
+
+  // print statistics of the lattice store in out-of-core mode
+  void PrintInputFstStatistics() const;
 
   const std::vector<LogVectorFst> &GetReferenceFsts() const;
 
-  const std::vector<LogVectorFst> &GetInitFsts() const;
+  // get number of initialization fsts
+  std::size_t GetNumInitFsts() const;
+
+  // get initialization fst Idx (VectorFst or ConstFst)
+  const LogExpandedFst &GetInitFst(
+    std::size_t Idx
+  ) const;
 
   const std::vector<std::string> &GetInputFileNames() const;
 
@@ -41,20 +41,36 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <atomic>
 #include <unordered_map>
+#include <memory>
+#include <utility>
+#include <cstdio>
+#include <iomanip>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <fst/rmepsilon.h>
 #include <fst/arcsort.h>
 #include <fst/compose.h>
 #include "FileReader.hpp"
+#include "LatticePruner.hpp"
+#include "FstBinaryIO.hpp"
+#include "CompressedInput.hpp"
+#include "../Utils/MappedFile.hpp"
 #include <CustomArcMappers.hpp>
+#include <FNV1aHash.hpp>
+#include <ParallelFor.hpp>
 #include <cstdlib>
 #include "definitions.hpp"
 #include "../DebugLib.hpp"
 #include "../EditDistanceCalculator/LPERCalculator.hpp"
 
+const uint64_t FileReader::CORPUS_CACHE_MAGIC;
+const uint32_t FileReader::CORPUS_CACHE_VERSION;
+
 FileReader::FileReader(ParameterStruct Params) :
-  Params(Params)
+  Params(Params),
+  NumStoredInputFsts(0)
 {
   GlobalStringToInt.Insert(EPS_SYMBOL);
   GlobalStringToInt.Insert(PHI_SYMBOL);
@@ -63,6 +79,20 @@ FileReader::FileReader(ParameterStruct Params) :
   GlobalStringToInt.Insert(SENTSTART_SYMBOL);
   GlobalStringToInt.Insert(SENTEND_SYMBOL);
 
+  // in out-of-core mode the preprocessed input lattices are written to
+  // the lattice store block by block instead of being kept in memory
+  bool OutOfCore = !Params.LatticeStoreFile.empty();
+  bool UseCorpusCache = !Params.CorpusCacheFile.empty() && !OutOfCore;
+  if (!Params.CorpusCacheFile.empty() && OutOfCore) {
+    std::cout << "Warning: The corpus cache is not used in out-of-core mode!"
+              << std::endl;
+  }
+
+  // a matching corpus cache already contains the preprocessed data
+  if (UseCorpusCache && ReadCorpusCache()) {
+    return;
+  }
+
   // read the initialization, input and reference data,
   // export data if specified and do some prepocessing
   // of the input lattices (acoustic model scaling and
@@ -83,32 +113,209 @@ FileReader::FileReader(ParameterStruct Params) :
     ReadInitTranscription();
   }
 
+  if (OutOfCore) {
+    std::cout << "  Writing preprocessed input lattices to "
+              << Params.LatticeStoreFile << std::endl;
+    InputStoreWriter.reset(new LatticeStoreWriter(Params.LatticeStoreFile));
+  }
+
   ReadInputFilesFromList();
 
-  if (Params.ExportLattices) {
+  if (Params.ExportLattices && !OutOfCore) {
     WriteOpenFSTLattices();
   }
 
   if (Params.UseReferenceTranscription) {
     ReadReferenceTranscription();
-    if (Params.CalculateLPER) {
+    if (Params.CalculateLPER && OutOfCore) {
+      std::cout << "Warning: LPER calculation is not supported in out-of-core"
+                << " mode!" << std::endl;
+    } else if (Params.CalculateLPER) {
       CalculateLatticePhonemeErrorRate();
     }
   }
 
-  if (Params.AmScale != 1) {
-    ApplyAcousticModelScalingFactor();
+  if (OutOfCore) {
+    InputStoreWriter->Close();
+    InputStoreWriter.reset();
+    InputLatticeStore = std::make_shared<LatticeStore>(
+      Params.LatticeStoreFile,
+      static_cast<std::size_t>(Params.LatticeCacheSize) * 1024 * 1024);
+  } else {
+    if (Params.AmScale != 1) {
+      ApplyAcousticModelScalingFactor();
+    }
+    ApplyWordEndAndSentEndTransducer();
+  }
+
+  if (UseCorpusCache) {
+    WriteCorpusCache();
+  }
+}
+
+FileData FileReader::ReleaseInputFileData()
+{
+  // move instead of copy, so that the corpus is held only once
+  FileData InputFileData(std::move(GlobalStringToInt),
+                         std::move(InitStringToInt),
+                         std::move(InitFsts),
+                         std::move(InitFileNames),
+                         std::move(InputStringToInt),
+                         std::move(InputFsts),
+                         std::move(InputFileNames),
+                         std::move(InputArcInfos),
+                         std::move(ReferenceStringToInt),
+                         std::move(ReferenceFsts),
+                         std::move(ReferenceFileNames),
+                         std::move(InputLatticeStore),
+                         std::move(InputCharacterNGrams));
+  if (Params.CompactFsts) {
+    InputFileData.ConvertToConstFsts();
+  }
+  DebugLib::PrintPeakMemoryUsage("Peak memory usage after loading");
+  return InputFileData;
+}
+
+
+uint64_t FileReader::GetCorpusCacheHash() const
+{
+  // describe everything the preprocessing depends on, including size and
+  // modification time of all files read, so that changed files invalidate
+  // the cache
+  std::ostringstream Description;
+  Description << std::setprecision(17)
+              << Params.LatticeFileType << " " << Params.PruneFactor << " "
+              << Params.AmScale << " " << Params.HTKLMScale << " "
+              << Params.ReadNodeTimes << " " << Params.PosteriorPruning << " "
+              << Params.UseDictFile << " "
+              << Params.InitLM << " " << Params.UseReferenceTranscription
+              << "\n";
+
+  // the LPER calculation leaves the input lattices pruned with the last
+  // pruning factor of its sweep
+  if (Params.UseReferenceTranscription && Params.CalculateLPER) {
+    Description << "LPER " << Params.PruningStart << " "
+                << Params.PruningStep << " " << Params.PruningEnd << "\n";
+  }
+
+  std::vector<std::string> Files(Params.InputFiles);
+  Files.push_back(Params.SymbolFile);
+  Files.push_back(Params.InputArcInfosFile);
+  Files.push_back(Params.UseDictFile ? Params.DictFile : "");
+  Files.push_back(Params.InitLM ? Params.InitTranscription : "");
+  Files.push_back(Params.UseReferenceTranscription ?
+                  Params.ReferenceTranscription : "");
+  for (const auto &File : Files) {
+    Description << File;
+    boost::system::error_code Error;
+    boost::uintmax_t Size = boost::filesystem::file_size(File, Error);
+    if (!Error) {
+      Description << " " << Size << " "
+                  << boost::filesystem::last_write_time(File, Error);
+    }
+    Description << "\n";
   }
-  ApplyWordEndTransducer();
-  ApplySentEndTransducer();
 
+  FNV1aHash Hash;
+  Hash.Update(Description.str());
+  return Hash.GetHash();
 }
 
-FileData FileReader::GetInputFileData()
+
+bool FileReader::ReadCorpusCache()
 {
-  return FileData(GlobalStringToInt, InitStringToInt, InitFsts, InitFileNames,
-                  InputStringToInt, InputFsts, InputFileNames, InputArcInfos,
-                  ReferenceStringToInt, ReferenceFsts, ReferenceFileNames);
+  if (!boost::filesystem::exists(Params.CorpusCacheFile)) {
+    return false;
+  }
+
+  MappedFile File(Params.CorpusCacheFile);
+  BinaryReader Reader(File.GetData(), File.GetSize());
+  bool Matches = false;
+  try {
+    Matches = Reader.Read<uint64_t>() == CORPUS_CACHE_MAGIC &&
+              Reader.Read<uint32_t>() == CORPUS_CACHE_VERSION &&
+              Reader.Read<uint64_t>() == GetCorpusCacheHash();
+  } catch (const std::runtime_error &) {
+  }
+  if (!Matches) {
+    std::cout << "  Corpus cache " << Params.CorpusCacheFile
+              << " does not match the current parameters, ignoring it"
+              << std::endl;
+    return false;
+  }
+
+  std::cout << "  Reading preprocessed corpus from "
+            << Params.CorpusCacheFile << std::endl;
+  std::vector<std::string> Symbols;
+  for (StringToIntMapper *Mapper : {&GlobalStringToInt, &InitStringToInt,
+                                    &InputStringToInt,
+                                    &ReferenceStringToInt}) {
+    Reader.ReadStringVector(&Symbols);
+    *Mapper = StringToIntMapper();
+    for (const auto &Symbol : Symbols) {
+      Mapper->Insert(Symbol);
+    }
+  }
+
+  ReadFstVector(&Reader, &InitFsts);
+  Reader.ReadStringVector(&InitFileNames);
+  ReadFstVector(&Reader, &InputFsts);
+  Reader.ReadStringVector(&InputFileNames);
+  std::size_t NumInputArcInfos = Reader.Read<uint64_t>();
+  InputArcInfos.clear();
+  InputArcInfos.reserve(NumInputArcInfos);
+  for (std::size_t Idx = 0; Idx < NumInputArcInfos; ++Idx) {
+    int32_t Label = Reader.Read<int32_t>();
+    float Start = Reader.Read<float>();
+    InputArcInfos.push_back(ArcInfo(Label, Start, Reader.Read<float>()));
+  }
+  ReadFstVector(&Reader, &ReferenceFsts);
+  Reader.ReadStringVector(&ReferenceFileNames);
+
+  std::cout << "  Read " << InputFsts.size() << " input, "
+            << ReferenceFsts.size() << " reference and "
+            << InitFsts.size() << " initialization fsts" << std::endl;
+  return true;
+}
+
+
+void FileReader::WriteCorpusCache() const
+{
+  std::cout << "  Writing preprocessed corpus to "
+            << Params.CorpusCacheFile << std::endl;
+
+  // write to a temporary file first so that an interrupted run does not
+  // leave a truncated cache behind
+  std::string TmpFileName = Params.CorpusCacheFile + ".tmp";
+  BinaryWriter Writer(TmpFileName);
+  Writer.Write<uint64_t>(CORPUS_CACHE_MAGIC);
+  Writer.Write<uint32_t>(CORPUS_CACHE_VERSION);
+  Writer.Write<uint64_t>(GetCorpusCacheHash());
+
+  Writer.WriteStringVector(GlobalStringToInt.GetIntToStringVector());
+  Writer.WriteStringVector(InitStringToInt.GetIntToStringVector());
+  Writer.WriteStringVector(InputStringToInt.GetIntToStringVector());
+  Writer.WriteStringVector(ReferenceStringToInt.GetIntToStringVector());
+
+  WriteFstVector(InitFsts, &Writer);
+  Writer.WriteStringVector(InitFileNames);
+  WriteFstVector(InputFsts, &Writer);
+  Writer.WriteStringVector(InputFileNames);
+  Writer.Write<uint64_t>(InputArcInfos.size());
+  for (const auto &InputArcInfo : InputArcInfos) {
+    Writer.Write<int32_t>(InputArcInfo.label);
+    Writer.Write<float>(InputArcInfo.start);
+    Writer.Write<float>(InputArcInfo.end);
+  }
+  WriteFstVector(ReferenceFsts, &Writer);
+  Writer.WriteStringVector(ReferenceFileNames);
+
+  if (!Writer.Close() ||
+      std::rename(TmpFileName.c_str(), Params.CorpusCacheFile.c_str()) != 0) {
+    std::cout << "Warning: Could not write corpus cache "
+              << Params.CorpusCacheFile << std::endl;
+    std::remove(TmpFileName.c_str());
+  }
 }
 
 
@@ -217,297 +424,246 @@ void FileReader::ReadInputFilesFromList()
 }
 
 
-void FileReader::ReadHTKLattices()
+std::size_t FileReader::GetNumWorkerThreads(std::size_t NumItems) const
 {
-  for (std::size_t InputFileId = 0;
-       InputFileId < Params.InputFiles.size(); InputFileId++) {
-    std::cout << "Reading nBest file [" << InputFileId << "/"
-              << Params.InputFiles.size() << "] from HTK FST "
-              << Params.InputFiles.at(InputFileId) << std::endl;
-
-    // some variables
-    float lmscale = Params.HTKLMScale;
-    int debug_ = 0;
-    std::string line;
-    std::string utterance;
+  return ::GetNumWorkerThreads(Params.NoThreads, NumItems);
+}
 
-    // open file
-    std::ifstream in(Params.InputFiles[InputFileId]);
 
-    //get Version (first line)
-    std::getline(in, line);
+void FileReader::ParallelFor(
+  std::size_t NumItems,
+  const std::function<void(std::size_t)> &Function) const
+{
+  ::ParallelFor(Params.NoThreads, NumItems, Function);
+}
 
-    //get Utterance
-    std::getline(in, line);
-    std::size_t pos = line.find("=");
-    utterance = line.substr(pos + 1);
-    if (debug_) {
-      std::cout << "Reading utterance: " << utterance << std::endl;
-    }
 
-    //get LM factor
-    while (std::getline(in, line) &&
-        line.substr(0, 7) != "lmscale" && line.substr(0, 1) != "N") {
-      std::getline(in, line);
-    }
+void FileReader::ParallelForWithThreadIdx(
+  std::size_t NumItems,
+  const std::function<void(std::size_t, std::size_t)> &Function) const
+{
+  ::ParallelForWithThreadIdx(Params.NoThreads, NumItems, Function);
+}
 
-    if (line.substr(0, 7) == "lmscale") {
-      std::istringstream iss(line);
-      string lmScaleString;
-      iss >> lmScaleString;
-      pos = lmScaleString.find("=");
-      lmscale = std::stof(lmScaleString.substr(pos + 1));
-    }
 
-    //get Nodes and Links
-    while (in.good() && line.substr(0, 1) != "N") {
-      std::getline(in, line);
+void FileReader::PruneAndLogLattice(LogVectorFst *Fst, std::ostream &Log) const
+{
+  int arcCnt = 0;
+  for (LogStateIterator StateIter(*Fst); !StateIter.Done(); StateIter.Next()) {
+    arcCnt += Fst->NumArcs(StateIter.Value());
+  }
+  Log << Fst->NumStates() << " States | " << arcCnt << " Arcs";
+
+  //Pruning
+  if (Params.PruneFactor != std::numeric_limits<double>::infinity() &&
+      Params.PosteriorPruning) {
+    LogVectorFst PrunedFst;
+    LatticePruner(*Fst, true).Prune(Params.PruneFactor, &PrunedFst);
+    *Fst = PrunedFst;
+  } else if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
+    LogToStdMapFst InStdArcFst(*Fst, fst::LogToStdMapper());
+    StdVectorFst OutStdArcFst;
+    fst::Prune(InStdArcFst, &OutStdArcFst, Params.PruneFactor);
+    fst::ArcMap(OutStdArcFst, Fst, fst::StdToLogMapper());
+    fst::ArcSort(Fst, fst::OLabelCompare<fst::LogArc>());
+  }
+  if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
+    arcCnt = 0;
+    for (LogStateIterator StateIter(*Fst);
+         !StateIter.Done(); StateIter.Next()) {
+      arcCnt += Fst->NumArcs(StateIter.Value());
     }
+    Log << " (" << Fst->NumStates()
+        << " States | " << arcCnt << " Arcs after pruning)";
+  }
+  Log << std::endl;
+}
 
-    std::istringstream iss(line);
-    string nodeStr;
-    iss >> nodeStr;
-    pos = nodeStr.find("=");
-    std::size_t nodes = std::stoull(nodeStr.substr(pos + 1));
-    string linksStr;
-    iss >> linksStr;
-    pos = linksStr.find("=");
-    int linksLeft = std::stoi(linksStr.substr(pos + 1));
-
-    // prepare the fst -> it gets a unique start and end state
-    LogVectorFst latticeFst;
-    latticeFst.AddState();
-    latticeFst.SetStart(0);
 
-    // create the nodes
-    latticeFst.ReserveStates(nodes);
-    for (std::size_t s = 1; s < nodes; s++) {
-      latticeFst.AddState();
-    }
-    // latticeFst.SetFinal(nodes - 1, 0);
-
-    // read node times
-    std::vector<float> NodeTimes;
-    if (Params.ReadNodeTimes) {
-
-      // read nodes
-      NodeTimes.resize(nodes, -1);
-      for (std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
-        // find next node entry
-        std::getline(in, line);
-        while (in.good() && line.substr(0, 1) != "I") {
-          std::getline(in, line);
-        }
-        std::istringstream iss(line);
-        string nodeStr;
-        iss >> nodeStr; // discard node number
-        iss >> nodeStr;
-        pos = nodeStr.find("=");
-        NodeTimes[NodeId] = std::stof(nodeStr.substr(pos + 1));
-        if (debug_) {
-          std::cout << "Reading Node " << NodeId << " at time "
-                    << NodeTimes[NodeId] << std::endl;
-        }
-      }
-      InputArcInfos.push_back(ArcInfo(EPS_SYMBOLID, -1, -1));
+void FileReader::ReadHTKLattices()
+{
+  // files are processed in blocks of three phases: parsing (parallel),
+  // symbol interning (serial in file order, so that the symbol ids and
+  // arc infos are identical to reading the files one by one) and
+  // building the fsts (parallel)
+  InputSource Source(Params.InputFiles);
+  HTKLatticeParser Parser(Params.HTKLMScale, Params.ReadNodeTimes);
+  std::vector<InputItem> Items;
+  std::size_t InputFileId = 0;
+  while (Source.NextBlock(INGESTION_BLOCK_SIZE, &Items)) {
+    std::vector<HTKLattice> Lattices(Items.size());
+
+    ParallelFor(Lattices.size(), [&](std::size_t Idx) {
+      InputItemData Data(Items[Idx]);
+      Parser.Parse(Data.GetData(), Data.GetSize(), &Lattices[Idx]);
+    });
+
+    for (auto &Lattice : Lattices) {
+      InternHTKLattice(&Lattice);
     }
 
-    //  read segment list
-    bool ReadSegList = false;
-    if (ReadSegList) {
-      ReadSegmentList(InputFileId, line, debug_);
-    }
+    ParallelFor(Lattices.size(), [&](std::size_t Idx) {
+      BuildHTKLattice(&Lattices[Idx]);
+    });
 
-    //read the path
-    std::vector<bool> IsFinal(nodes, true);
-
-    while (std::getline(in, line)) {
-      if (line.substr(0, 1) == "J") {       //only evaluate the links
-        //Format example: J=5 S=0 E=5 W="zh"  v=0 a=-273.284  l=-3.80666
-        // J: link no; S: start node; E: end node; W: phone;
-        // v: ???; a: acoustic model score; l: lm score
-
-        //variables
-        CharId ilab;
-        CharId olab;
-        fst::LogArc arc;
-        string cur;
-        string phone;
-        std::istringstream iss(line);
+    for (std::size_t Idx = 0; Idx < Lattices.size(); ++Idx, ++InputFileId) {
+      std::cout << "Reading nBest file [" << InputFileId << "/"
+                << Params.InputFiles.size() << "] from HTK FST "
+                << Items[Idx].Path << std::endl;
+      std::cout << Lattices[Idx].Log;
 
-        //discard link number
-        iss >> cur;
+      if (Lattices[Idx].Fst.NumStates() == 0) {
+        std::cout << "Error: no states for utterance "
+                  << Lattices[Idx].Utterance << std::endl;
+        throw std::runtime_error("Exiting");
+      }
+      InputFsts.push_back(Lattices[Idx].Fst);
+      InputFileNames.push_back(Items[Idx].Name);
+    }
+    StoreInputBlock();
+  }
+}
 
-        //start
-        int start;
-        if (!(iss >> cur)) {
-          break;
-        }
-        pos = cur.find("=");
-        start = std::stoi(cur.substr(pos + 1));
-        IsFinal.at(start) = false;
-
-        //end
-        int end;
-        if (!(iss >> cur)) {
-          break;
-        }
-        pos = cur.find("=");
-        end = std::stoi(cur.substr(pos + 1));
 
-        // phone
-        if (!(iss >> cur)) {
-          break;
-        }
-        pos = cur.find("=");
-        int off = 0; //RASR quotes the phones. We only want the phone
-        if (cur.substr(pos + 1, 1) == "\"") {
-          off = 1;
-        }
-        phone = cur.substr(pos + 1 + off, cur.length() - pos - 1 - (2 * off));
+void FileReader::StoreInputBlock()
+{
+  if (!InputStoreWriter) {
+    return;
+  }
 
-        //discard v
-        iss >> cur;
-        if (cur.substr(0, 2) == "v=") {
-          iss >> cur;
-        }
+  // the preprocessing of a block only needs the symbols read so far
+  InputStringToInt = GlobalStringToInt;
+  if (Params.ExportLattices) {
+    WriteOpenFSTLattices();
+  }
+  if (Params.AmScale != 1) {
+    ApplyAcousticModelScalingFactor();
+  }
+  ApplyWordEndAndSentEndTransducer();
 
-        //acoustic model score
-        float amScore;
-        pos = cur.find("=");
-        amScore = -std::stof(cur.substr(pos + 1));
-
-        //lm score
-        iss >> cur;
-        float lmScore;
-        pos = cur.find("=");
-        lmScore = -std::stof(cur.substr(pos + 1));
-        amScore = amScore / log(10);
-        amScore += lmscale * lmScore / log(10);
-
-        //replace silence with eps
-        if (IsSilence(phone)) {
-          olab = EPS_SYMBOLID;
-          ilab = EPS_SYMBOLID;
-        } else {
-          olab = GlobalStringToInt.Insert(phone);
-          if (Params.ReadNodeTimes) {
-            InputArcInfos.push_back(
-              ArcInfo(olab, NodeTimes[start], NodeTimes[end]));
-            ilab = InputArcInfos.size() - 1;
-          } else {
-            ilab = olab;
-          }
-        }
+  if (Params.InputLexiconCacheSize > 0) {
+    InputCharacterNGrams.resize(NumStoredInputFsts + InputFsts.size());
+    ParallelFor(InputFsts.size(), [&](std::size_t Idx) {
+      InputCharacterNGrams[NumStoredInputFsts + Idx].Collect(InputFsts[Idx]);
+    });
+  }
+  for (const auto &InputFst : InputFsts) {
+    InputStoreWriter->Add(InputFst);
+  }
+  NumStoredInputFsts += InputFsts.size();
+  InputFsts.clear();
+}
 
-        //Add arc
-        fst::MutableArcIterator< LogVectorFst > ArcIter(&latticeFst, start);
-        while (!ArcIter.Done() && !(ArcIter.Value().olabel == olab &&
-                                    ArcIter.Value().nextstate == end)) {
-          ArcIter.Next();
-        }
-        if (!ArcIter.Done()) {
-          fst::LogArc arc = ArcIter.Value();
-          if (debug_ > 2) {
-            std::cout << "Found arc: Old: " << start << "->" << arc.nextstate
-                      << "[" << arc.weight.Value() << "] new: " << start
-                      << "->" << end << "[" << amScore << "]" << std::endl;
-          }
-          arc.weight = fst::Plus(arc.weight, fst::LogWeight(amScore));
-          ArcIter.SetValue(arc);
-          if (debug_ > 2) {
-            std::cout << "Modified phone: " << phone << "[" << olab << "]"
-                      << " start: " << start << " end: " << end
-                      << " score: " << arc.weight.Value() << " | "
-                      << linksLeft << " left" << std::endl;
-          }
-        } else {
-          latticeFst.AddArc(start, fst::LogArc(ilab, olab, amScore, end));
-          if (debug_ > 2) {
-            std::cout << "Added: phone: " << phone << "[" << olab << "]"
-                      << " start: " << start << " end: " << end
-                      << " score: " << amScore << " | "
-                      << linksLeft << " left" << std::endl;
-          }
-        }
-        linksLeft--;
-      } //end if
-    } //end read line
-
-    // set final nodes
-    if (!IsFinal.at(nodes - 1)){
-      std::cout << "Warning: The last node is not a final node!"
-                << std::endl;
-    }
 
-    for(std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
-      if (IsFinal.at(NodeId)) {
-        latticeFst.SetFinal(NodeId, 0);
-        if (NodeId != nodes - 1) {
-          std::cout << "Warning: Final node " << NodeId
-                    << " is not the last node!" << std::endl;
-        }
-      }
-    }
+void FileReader::InternHTKLattice(HTKLattice *Lattice)
+{
+  if (Params.ReadNodeTimes) {
+    InputArcInfos.push_back(ArcInfo(EPS_SYMBOLID, -1, -1));
+  }
 
-    // rmepsilon
-    if (debug_ > 2) {
-      std::cout << "RmEpsilon";
+  for (auto &Link : Lattice->Links) {
+    //replace silence with eps
+    if (IsSilence(Link.Phone)) {
+      Link.OLabel = EPS_SYMBOLID;
+      Link.ILabel = EPS_SYMBOLID;
+    } else {
+      Link.OLabel = GlobalStringToInt.Insert(Link.Phone);
+      if (Params.ReadNodeTimes) {
+        InputArcInfos.push_back(
+          ArcInfo(Link.OLabel, Lattice->NodeTimes[Link.Start],
+                  Lattice->NodeTimes[Link.End]));
+        Link.ILabel = InputArcInfos.size() - 1;
+      } else {
+        Link.ILabel = Link.OLabel;
+      }
     }
-    fst::RmEpsilon(&latticeFst);
+  }
+}
 
-    // topsort
-    if (debug_ > 2) {
-      std::cout << " | TopSort";
-    }
-    fst::TopSort(&latticeFst);
 
-    // arcsort
-    if (debug_ > 2) {
-      std::cout << " | ArcSort";
-    }
-    fst::ArcSort(&latticeFst, fst::OLabelCompare<fst::LogArc>());
+void FileReader::BuildHTKLattice(HTKLattice *Lattice) const
+{
+  int debug_ = 0;
+  std::size_t nodes = Lattice->NumNodes;
+  std::ostringstream Log;
+  Log << Lattice->Log;
+
+  // prepare the fst -> it gets a unique start and end state
+  LogVectorFst &latticeFst = Lattice->Fst;
+  latticeFst.AddState();
+  latticeFst.SetStart(0);
+
+  // create the nodes
+  latticeFst.ReserveStates(nodes);
+  for (std::size_t s = 1; s < nodes; s++) {
+    latticeFst.AddState();
+  }
 
-    // print number of states
-    if (debug_ > 2) {
-      std::cout << std::endl;
-    }
-    int arcCnt = 0;
-    for (LogStateIterator siter(latticeFst); !siter.Done(); siter.Next()) {
-      arcCnt += latticeFst.NumArcs(siter.Value());
-    }
-    std::cout << latticeFst.NumStates() << " States | " << arcCnt << " Arcs";
-
-    //Pruning
-    if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
-      LogToStdMapFst InStdArcFst(latticeFst, fst::LogToStdMapper());
-      StdVectorFst OutStdArcFst;
-      fst::Prune(InStdArcFst, &OutStdArcFst, Params.PruneFactor);
-      fst::ArcMap(OutStdArcFst, &latticeFst, fst::StdToLogMapper());
-      fst::ArcSort(&latticeFst, fst::OLabelCompare<fst::LogArc>());
-      arcCnt = 0;
-      for (LogStateIterator StateIter(latticeFst);
-           !StateIter.Done(); StateIter.Next()) {
-        arcCnt += latticeFst.NumArcs(StateIter.Value());
+  // merge links with identical start, end and output label by adding
+  // their weights, the position of each arc is kept in a hash map
+  std::vector<bool> IsFinal(nodes, true);
+  std::unordered_map<HTKArcKey, std::size_t, HTKArcKeyHash> ArcPositions;
+  ArcPositions.reserve(Lattice->Links.size());
+  for (const auto &Link : Lattice->Links) {
+    IsFinal.at(Link.Start) = false;
+
+    //Add arc
+    auto ArcPosition = ArcPositions.insert(std::make_pair(
+      HTKArcKey{Link.Start, Link.OLabel, Link.End},
+      latticeFst.NumArcs(Link.Start)));
+    if (!ArcPosition.second) {
+      fst::MutableArcIterator< LogVectorFst > ArcIter(&latticeFst, Link.Start);
+      ArcIter.Seek(ArcPosition.first->second);
+      fst::LogArc arc = ArcIter.Value();
+      arc.weight = fst::Plus(arc.weight, fst::LogWeight(Link.Score));
+      ArcIter.SetValue(arc);
+      if (debug_ > 2) {
+        Log << "Modified phone: " << Link.Phone << "[" << Link.OLabel << "]"
+            << " start: " << Link.Start << " end: " << Link.End
+            << " score: " << arc.weight.Value() << std::endl;
+      }
+    } else {
+      latticeFst.AddArc(Link.Start, fst::LogArc(Link.ILabel, Link.OLabel,
+                                                Link.Score, Link.End));
+      if (debug_ > 2) {
+        Log << "Added: phone: " << Link.Phone << "[" << Link.OLabel << "]"
+            << " start: " << Link.Start << " end: " << Link.End
+            << " score: " << Link.Score << std::endl;
       }
-      std::cout << " (" << latticeFst.NumStates()
-                << " States | " << arcCnt << " Arcs after pruning)";
     }
-    std::cout << std::endl;
+  }
+
+  // the parsed links are not needed anymore
+  std::vector<HTKLink>().swap(Lattice->Links);
+  std::vector<float>().swap(Lattice->NodeTimes);
 
-    if (latticeFst.NumStates() == 0) {
-      std::cout << "Error: no states for utterance " << utterance << std::endl;
-      std::runtime_error("Exiting");
+  // set final nodes
+  if (!IsFinal.at(nodes - 1)){
+    Log << "Warning: The last node is not a final node!" << std::endl;
+  }
+
+  for(std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
+    if (IsFinal.at(NodeId)) {
+      latticeFst.SetFinal(NodeId, 0);
+      if (NodeId != nodes - 1) {
+        Log << "Warning: Final node " << NodeId
+            << " is not the last node!" << std::endl;
+      }
     }
-    InputFsts.push_back(latticeFst);
-    InputFileNames.push_back(
-      boost::filesystem::path(
-        Params.InputFiles.at(InputFileId)).filename().string());
   }
+
+  // rmepsilon, topsort and arcsort
+  fst::RmEpsilon(&latticeFst);
+  fst::TopSort(&latticeFst);
+  fst::ArcSort(&latticeFst, fst::OLabelCompare<fst::LogArc>());
+
+  // print number of states and prune
+  PruneAndLogLattice(&latticeFst, Log);
+  Lattice->Log = Log.str();
 }
 
 void FileReader::ReadSegmentList(std::size_t InputFileId,
-                                 std::string line, int debug_){
+                                 std::string line, int debug_) const {
   std::size_t NumSegments;
   std::vector<float> SegmentStart;
   std::vector<float> SegmentEnd;
@@ -548,45 +704,46 @@ void FileReader::ReadSegmentList(std::size_t InputFileId,
 }
 void FileReader::ReadOpenFSTLattices()
 {
-  for (std::size_t i = 0; i < Params.InputFiles.size(); i++) {
-    std::cout << "Reading lattice file [" << i << "/"
-              << Params.InputFiles.size() << "] from OpenFst FST "
-              << Params.InputFiles.at(i) << std::endl;
-    LogVectorFst LogArcVectorFst(*LogVectorFst::Read(Params.InputFiles.at(i)));
-    int arcCnt = 0;
-    for (LogStateIterator StateIter(LogArcVectorFst);
-         !StateIter.Done(); StateIter.Next()) {
-      arcCnt += LogArcVectorFst.NumArcs(StateIter.Value());
-    }
-    std::cout << LogArcVectorFst.NumStates()
-              << " States | " << arcCnt << " Arcs";
-
-    //Pruning
-    if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
-      LogToStdMapFst InStdArcFst(LogArcVectorFst, fst::LogToStdMapper());
-      StdVectorFst OutStdArcFst;
-      fst::Prune(InStdArcFst, &OutStdArcFst, Params.PruneFactor);
-      fst::ArcMap(OutStdArcFst, &LogArcVectorFst, fst::StdToLogMapper());
-      fst::ArcSort(&LogArcVectorFst, fst::OLabelCompare<fst::LogArc>());
-      arcCnt = 0;
-      for (LogStateIterator StateIter(LogArcVectorFst);
-           !StateIter.Done(); StateIter.Next()) {
-        arcCnt += LogArcVectorFst.NumArcs(StateIter.Value());
+  InputSource Source(Params.InputFiles);
+  std::vector<InputItem> Items;
+  std::size_t InputFileId = 0;
+  while (Source.NextBlock(INGESTION_BLOCK_SIZE, &Items)) {
+    std::vector<LogVectorFst> Lattices(Items.size());
+    std::vector<std::string> Logs(Items.size());
+
+    // no symbols are interned here, so the files can be read and pruned
+    // completely in parallel
+    ParallelFor(Lattices.size(), [&](std::size_t Idx) {
+      InputItemData Data(Items[Idx]);
+      std::unique_ptr<LogVectorFst> ReadFst(LogVectorFst::Read(
+        Data.GetStream(), fst::FstReadOptions(Items[Idx].Path)));
+      if (!ReadFst) {
+        throw std::runtime_error("Could not read lattice file " +
+                                 Items[Idx].Path);
+      }
+      Lattices[Idx] = *ReadFst;
+      std::ostringstream Log;
+      PruneAndLogLattice(&Lattices[Idx], Log);
+      Logs[Idx] = Log.str();
+    });
+
+    for (std::size_t Idx = 0; Idx < Lattices.size(); ++Idx, ++InputFileId) {
+      std::cout << "Reading lattice file [" << InputFileId << "/"
+                << Params.InputFiles.size() << "] from OpenFst FST "
+                << Items[Idx].Path << std::endl;
+      std::cout << Logs[Idx];
+
+      if (Lattices[Idx].NumStates() == 0) {
+        std::cout << "Error: no states for utterance " << Items[Idx].Name
+                  << std::endl;
+        throw std::runtime_error("Exiting");
       }
-      std::cout << " (" << LogArcVectorFst.NumStates()
-                << " States | " << arcCnt << " Arcs after pruning)";
-    }
-    std::cout << std::endl;
-
-    if (LogArcVectorFst.NumStates() == 0) {
-      std::cout << "Error: no states for utterance " << i << std::endl;
-      std::runtime_error("Exiting");
-    }
 
-    InputFsts.push_back(LogArcVectorFst);
+      InputFsts.push_back(Lattices[Idx]);
 
-    InputFileNames.push_back(
-      boost::filesystem::path(Params.InputFiles.at(i)).filename().string());
+      InputFileNames.push_back(Items[Idx].Name);
+    }
+    StoreInputBlock();
   }
 }
 
@@ -672,53 +829,81 @@ void FileReader::ReadTextFiles(
   std::vector<std::string> *FileNames,
   bool ParseReferences)
 {
-  for(auto& InputFile: InputFiles) {
-    std::ifstream in(InputFile);
+  bool LookUpPronunciations = ParseReferences && Params.UseDictFile;
+
+  InputSource Source(InputFiles);
+  std::vector<InputItem> Items;
+  while (Source.NextBlock(1, &Items)) {
+    const InputItem &InputFile = Items.front();
+    InputItemData Data(InputFile);
+    std::istream &in = Data.GetStream();
 
     int SentenceIndex = 0;
-    for (std::string line; std::getline(in, line); ) {
-      std::istringstream iss(line);
-      LogVectorFst latticeFst;
-      latticeFst.AddState();
-      latticeFst.SetStart(0);
-      StateId State = 0;
-
-      // Read sentence and create Transducer
-      if (ParseReferences && Params.UseDictFile) {
-        // Dict file present: read words from file and look up pronunciation
-        for (std::string Word; iss >> Word; ) {
-          std::vector<std::string>& Pronunciation = PronDict.at(Word);
-          for(std::string phone: Pronunciation) {
-            State = AddPhoneToFst(latticeFst, State, phone);
-          }
-          // explicitly add word end marker
-          State = AddPhoneToFst(latticeFst, State, UNKEND_SYMBOL);
+    std::string line;
+    while (in) {
+      // read a block of lines and intern the phones in file order, so that
+      // the symbol ids are identical to reading the lines one by one
+      std::vector<std::string> Lines;
+      while (Lines.size() < INGESTION_BLOCK_SIZE && std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string phone;
+        if (!(iss >> phone)) {
+          std::cout << "Empty line found in " << InputFile.Path << std::endl;
+          std::cout << "Please ensure that each line in the training file "
+                    << "contains at least one symbol." << std::endl;
+          std::exit(1);
         }
-      } else {
-        // Sentence as sequence of phones separated by word end markers
-        for (std::string phone; iss >> phone; ) {
-          GlobalStringToInt.Insert(phone);
-          State = AddPhoneToFst(latticeFst, State, phone);
+        if (!LookUpPronunciations) {
+          do {
+            GlobalStringToInt.Insert(phone);
+          } while (iss >> phone);
         }
+        Lines.push_back(line);
       }
-      latticeFst.SetFinal(State, 0);
 
-      if (State == 0) {
-        std::cout << "Empty line found in " << InputFile << std::endl;
-        std::cout << "Please ensure that each line in the training file "
-                  << "contains at least one symbol." << std::endl;
-        std::exit(1);
+      // create the transducers in parallel, GlobalStringToInt is only read
+      std::vector<LogVectorFst> LatticeFsts(Lines.size());
+      ParallelFor(Lines.size(), [&](std::size_t Idx) {
+        std::istringstream iss(Lines[Idx]);
+        LogVectorFst &latticeFst = LatticeFsts[Idx];
+        latticeFst.AddState();
+        latticeFst.SetStart(0);
+        StateId State = 0;
+
+        // Read sentence and create Transducer
+        if (LookUpPronunciations) {
+          // Dict file present: read words from file and look up pronunciation
+          for (std::string Word; iss >> Word; ) {
+            const std::vector<std::string>& Pronunciation = PronDict.at(Word);
+            for(const std::string &phone: Pronunciation) {
+              State = AddPhoneToFst(latticeFst, State, phone);
+            }
+            // explicitly add word end marker
+            State = AddPhoneToFst(latticeFst, State, UNKEND_SYMBOL);
+          }
+        } else {
+          // Sentence as sequence of phones separated by word end markers
+          for (std::string phone; iss >> phone; ) {
+            State = AddPhoneToFst(latticeFst, State, phone);
+          }
+        }
+        latticeFst.SetFinal(State, 0);
+      });
+
+      for (auto &latticeFst: LatticeFsts) {
+        InputFsts->push_back(latticeFst);
+        FileNames->push_back(
+          InputFile.Name + "_Line_" + std::to_string(++SentenceIndex));
+      }
+      if (InputFsts == &this->InputFsts) {
+        StoreInputBlock();
       }
-      InputFsts->push_back(latticeFst);
-      FileNames->push_back(
-        boost::filesystem::path(InputFile).filename().string() +
-        "_Line_" + std::to_string(++SentenceIndex));
     }
   }
 }
 
 StateId FileReader::AddPhoneToFst(LogVectorFst& LatticeFst, StateId State,
-                                  const std::string& phone)
+                                  const std::string& phone) const
 {
   CharId OutLab = GlobalStringToInt.GetInt(PHONE_PREFIX+phone);
   CharId InLab = OutLab;
@@ -727,29 +912,6 @@ StateId FileReader::AddPhoneToFst(LogVectorFst& LatticeFst, StateId State,
   return nextState;
 }
 
-void FileReader::PruneLattices(double PruningFactor)
-{
-  if (PruningFactor != std::numeric_limits<double>::infinity()) {
-    for (auto& currentInputFst: InputFsts) {
-      LogToStdMapFst InStdArcFst(currentInputFst, fst::LogToStdMapper());
-      StdVectorFst OutStdArcFst;
-      fst::Prune(InStdArcFst, &OutStdArcFst, PruningFactor);
-      fst::ArcMap(OutStdArcFst, &currentInputFst, fst::StdToLogMapper());
-      fst::ArcSort(&currentInputFst, fst::OLabelCompare<fst::LogArc>());
-
-//       int arcCnt = 0;
-//       for (fst::StateIterator<LogVectorFst> siter(InputFsts.at(InputFstIdx));
-//            !siter.Done(); siter.Next()) {
-//         arcCnt += InputFsts.at(InputFstIdx).NumArcs(siter.Value());
-//       }
-//       std::cout << " (" << InputFsts.at(InputFstIdx).NumStates()
-//                 << " States | " << arcCnt << " Arcs after pruning)"
-//                 << std::endl;
-    }
-  }
-}
-
-
 void FileReader::ReadReferenceTranscription()
 {
   ReadTextFiles(std::vector<std::string>(1, Params.ReferenceTranscription),
@@ -765,10 +927,11 @@ void FileReader::ReadReferenceTranscription()
 
 void FileReader::WriteOpenFSTLattices() const
 {
-  for (std::size_t FileIdx = 0; FileIdx < InputFileNames.size(); FileIdx++) {
+  for (std::size_t FileIdx = 0; FileIdx < InputFsts.size(); FileIdx++) {
     DebugLib::WriteOpenFSTLattice(InputFsts.at(FileIdx),
                                   Params.ExportLatticesDirectoryName +
-                                  InputFileNames.at(FileIdx) + "_" +
+                                  InputFileNames.at(NumStoredInputFsts +
+                                                    FileIdx) + "_" +
                                   std::to_string(Params.PruneFactor));
   }
   DebugLib::WriteSymbols(Params.ExportLatticesDirectoryName + "symbols.txt",
@@ -781,69 +944,88 @@ void FileReader::WriteOpenFSTLattices() const
 
 void FileReader::ApplyAcousticModelScalingFactor()
 {
-  fst::WeightedMapper AcousticModelScalingFactorMapper(Params.AmScale);
-  for (auto& currentInputFst: InputFsts) {
-    fst::Map(&currentInputFst, AcousticModelScalingFactorMapper);
-//     std::cout << "Scaling FST: " << InputFstIdx << " with factor: "
+  ParallelFor(InputFsts.size(), [&](std::size_t Idx) {
+    fst::WeightedMapper AcousticModelScalingFactorMapper(Params.AmScale);
+    fst::Map(&InputFsts[Idx], AcousticModelScalingFactorMapper);
+//     std::cout << "Scaling FST: " << Idx << " with factor: "
 //               << Params.AmScale << std::endl;
-  }
+  });
 }
 
 
-void FileReader::ApplyWordEndTransducer()
+void FileReader::BuildWordEndTransducer(LogVectorFst *WordEndTransducer) const
 {
-  LogVectorFst WordEndTransducer;
-  StateId UNKState = WordEndTransducer.AddState();
-  StateId CharacterState = WordEndTransducer.AddState();
+  StateId UNKState = WordEndTransducer->AddState();
+  StateId CharacterState = WordEndTransducer->AddState();
 
-  WordEndTransducer.SetStart(UNKState);
-  WordEndTransducer.SetFinal(UNKState, 0);
-  WordEndTransducer.AddArc(CharacterState,
+  WordEndTransducer->SetStart(UNKState);
+  WordEndTransducer->SetFinal(UNKState, 0);
+  WordEndTransducer->AddArc(CharacterState,
     fst::LogArc(EPS_SYMBOLID, UNKEND_SYMBOLID, 0, UNKState));
-  WordEndTransducer.AddArc(CharacterState,
+  WordEndTransducer->AddArc(CharacterState,
     fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, UNKState));
   for (std::size_t k = CHARACTERSBEGIN;
        k < InputStringToInt.GetIntToStringVector().size(); k++) {
 
-    WordEndTransducer.AddArc(UNKState,
+    WordEndTransducer->AddArc(UNKState,
       fst::LogArc(k, k, 0, CharacterState));
 
-    WordEndTransducer.AddArc(CharacterState,
+    WordEndTransducer->AddArc(CharacterState,
       fst::LogArc(k, k, 0, CharacterState));
   }
-
-  for (auto& currentInputFst: InputFsts) {
-    currentInputFst = LogComposeFst(currentInputFst, WordEndTransducer);
-  }
 }
 
-void FileReader::ApplySentEndTransducer()
+
+void FileReader::BuildSentEndTransducer(LogVectorFst *SentEndTransducer) const
 {
-  LogVectorFst SentEndTransducer;
-  StateId CharacterState = SentEndTransducer.AddState();
-  StateId SentEndState = SentEndTransducer.AddState();
-  StateId FinalUNKState = SentEndTransducer.AddState();
+  StateId CharacterState = SentEndTransducer->AddState();
+  StateId SentEndState = SentEndTransducer->AddState();
+  StateId FinalUNKState = SentEndTransducer->AddState();
 
-  SentEndTransducer.SetStart(CharacterState);
-  SentEndTransducer.SetFinal(FinalUNKState, 0);
-  SentEndTransducer.AddArc(CharacterState,
+  SentEndTransducer->SetStart(CharacterState);
+  SentEndTransducer->SetFinal(FinalUNKState, 0);
+  SentEndTransducer->AddArc(CharacterState,
     fst::LogArc(EPS_SYMBOLID, SENTEND_SYMBOLID, 0, SentEndState));
-  SentEndTransducer.AddArc(CharacterState,
+  SentEndTransducer->AddArc(CharacterState,
     fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, CharacterState));
 
   for (std::size_t k = CHARACTERSBEGIN;
        k < InputStringToInt.GetIntToStringVector().size(); k++) {
 
-    SentEndTransducer.AddArc(CharacterState,
+    SentEndTransducer->AddArc(CharacterState,
       fst::LogArc(k, k, 0, CharacterState));
   }
-  SentEndTransducer.AddArc(SentEndState,
+  SentEndTransducer->AddArc(SentEndState,
     fst::LogArc(EPS_SYMBOLID, UNKEND_SYMBOLID, 0, FinalUNKState));
+}
+
 
-  for (auto& currentInputFst: InputFsts) {
-    currentInputFst = LogComposeFst(currentInputFst, SentEndTransducer);
-    fst::Connect(&currentInputFst);
+void FileReader::ApplyWordEndAndSentEndTransducer()
+{
+  LogVectorFst WordEndTransducer;
+  LogVectorFst SentEndTransducer;
+  BuildWordEndTransducer(&WordEndTransducer);
+  BuildSentEndTransducer(&SentEndTransducer);
+
+  // every thread composes with its own copies of the transducers
+  std::vector<LogVectorFst> WordEndTransducers;
+  std::vector<LogVectorFst> SentEndTransducers;
+  std::size_t NumThreads = GetNumWorkerThreads(InputFsts.size());
+  WordEndTransducers.reserve(NumThreads);
+  SentEndTransducers.reserve(NumThreads);
+  for (std::size_t IdxThread = 0; IdxThread < NumThreads; ++IdxThread) {
+    WordEndTransducers.push_back(DeepCopyFst(WordEndTransducer));
+    SentEndTransducers.push_back(DeepCopyFst(SentEndTransducer));
   }
+
+  ParallelForWithThreadIdx(InputFsts.size(),
+                           [&](std::size_t Idx, std::size_t IdxThread) {
+    InputFsts[Idx] = LogComposeFst(InputFsts[Idx],
+                                   WordEndTransducers[IdxThread]);
+    InputFsts[Idx] = LogComposeFst(InputFsts[Idx],
+                                   SentEndTransducers[IdxThread]);
+    fst::Connect(&InputFsts[Idx]);
+  });
 }
 
 void FileReader::CalculateLatticePhonemeErrorRate()
@@ -854,49 +1036,113 @@ void FileReader::CalculateLatticePhonemeErrorRate()
             << Params.PruningEnd << "!"
             << std::endl << std::endl;
 
+  std::vector<double> PruningFactors;
   for (double PruningFactor = Params.PruningStart;
        PruningFactor >= Params.PruningEnd;
        PruningFactor -= Params.PruningStep) {
-    PruneLattices(PruningFactor);
-    std::cout << "  Pruning factor: " << PruningFactor << std::endl;
+    PruningFactors.push_back(PruningFactor);
+    if (Params.PruningStart == std::numeric_limits<double>::infinity()) {
+      break;
+    }
+  }
+  if (PruningFactors.empty()) {
+    return;
+  }
+
+  // the arc scores are calculated once per lattice, the lattices for each
+  // pruning factor are derived from them by filtering the arcs
+  std::vector<std::unique_ptr<LatticePruner> > Pruners(InputFsts.size());
+  if (PruningFactors.back() != std::numeric_limits<double>::infinity()) {
+    ParallelFor(InputFsts.size(), [&](std::size_t Idx) {
+      Pruners[Idx].reset(new LatticePruner(InputFsts[Idx],
+                                           Params.PosteriorPruning));
+    });
+  }
 
-    std:: string prefix =
-      Params.OutputDirectoryBasename + "KnownN_" +
-      std::to_string(Params.KnownN) + "_UnkN_" +
-      std::to_string(Params.UnkN) + "/" +
-      Params.OutputFilesBasename + "LPER_";
+  std:: string prefix =
+    Params.OutputDirectoryBasename + "KnownN_" +
+    std::to_string(Params.KnownN) + "_UnkN_" +
+    std::to_string(Params.UnkN) + "/" +
+    Params.OutputFilesBasename + "LPER_";
+
+  // the pruning factors are evaluated in parallel, the remaining threads are
+  // used by the lper calculation of each pruning factor. The lattices are
+  // pruned sentence by sentence while aligning, so every thread only holds
+  // the pruned lattice it is working on. Only the last pruning factor
+  // writes the edit operations, as the files would be overwritten by the
+  // following pruning factors otherwise
+  std::size_t NumThreadsPerFactor = std::max<std::size_t>(
+    1, Params.NoThreads / GetNumWorkerThreads(PruningFactors.size()));
+  std::vector<std::vector<int> > Statistics(PruningFactors.size());
+  std::vector<std::size_t> NumArcs(PruningFactors.size(), 0);
+  ParallelFor(PruningFactors.size(), [&](std::size_t IdxFactor) {
+    double PruningFactor = PruningFactors[IdxFactor];
+    // the arcs of the connected pruned lattices are counted by the threads
+    // of the lper calculation
+    std::atomic<std::size_t> NumPrunedArcs(0);
+    std::function<void(std::size_t, LogVectorFst *)> PruneInputFst;
+    if (PruningFactor != std::numeric_limits<double>::infinity()) {
+      PruneInputFst = [&](std::size_t Idx, LogVectorFst *PrunedFst) {
+        Pruners[Idx]->Prune(PruningFactor, PrunedFst);
+        std::size_t NumFstArcs = 0;
+        for (LogStateIterator StateIter(*PrunedFst);
+             !StateIter.Done(); StateIter.Next()) {
+          NumFstArcs += PrunedFst->NumArcs(StateIter.Value());
+        }
+        NumPrunedArcs += NumFstArcs;
+      };
+    }
 
     LPERCalculator InputLatticeStatistics(
       InputFsts,
       ReferenceFsts,
       ReferenceStringToInt.GetIntToStringVector(),
-      Params.NoThreads,
+      NumThreadsPerFactor,
       InputFileNames,
       prefix,
-      Params.OutputEditOperations,
-      InputArcInfos
+      Params.OutputEditOperations && IdxFactor + 1 == PruningFactors.size(),
+      InputArcInfos,
+      Params.ConsolidateEditOperations,
+      PruneInputFst
     );
+    Statistics[IdxFactor] = InputLatticeStatistics.GetInsDelSubCorrNFoundNRef();
+    NumArcs[IdxFactor] = NumPrunedArcs;
+  });
+
+  for (std::size_t IdxFactor = 0;
+       IdxFactor < PruningFactors.size(); ++IdxFactor) {
+    std::cout << "  Pruning factor: " << PruningFactors[IdxFactor];
+    if (PruningFactors[IdxFactor] != std::numeric_limits<double>::infinity()) {
+      std::cout << " (" << NumArcs[IdxFactor] << " Arcs)";
+    }
+    std::cout << std::endl;
 
     DebugLib::PrintEditDistanceStatistics(
-      InputLatticeStatistics.GetInsDelSubCorrNFoundNRef(),
+      Statistics[IdxFactor],
       "Lattice phoneme error rate",
       "PER"
     );
+  }
 
-    if (Params.PruningStart == std::numeric_limits<double>::infinity()) {
-      break;
-    }
+  // as before the input lattices keep the pruning of the last pruning factor
+  if (PruningFactors.back() != std::numeric_limits<double>::infinity()) {
+    ParallelFor(InputFsts.size(), [&](std::size_t Idx) {
+      LogVectorFst PrunedFst;
+      Pruners[Idx]->Prune(PruningFactors.back(), &PrunedFst);
+      Pruners[Idx].reset();
+      InputFsts[Idx] = PrunedFst;
+    });
   }
 }
 
-bool FileReader::IsSilence(std::string phone)
+bool FileReader::IsSilence(std::string phone) const
 {
   return phone == "!SENT_START" || phone == "!SENT_END" || phone == "!NULL" ||
          phone == "sil" || phone == "!ENTER" || phone == "!EXIT" ||
          phone == "NSN" || phone == "<s>" || phone == "</s>";
 }
 
-std::string FileReader::GetSubstrAfterSep(std::string inStr, char sep)
+std::string FileReader::GetSubstrAfterSep(std::string inStr, char sep) const
 {
   return inStr.substr(inStr.find(sep)+1);
 }
@@ -60,10 +60,14 @@
 #ifndef _FILEREADER_HPP_
 #define _FILEREADER_HPP_
 
+#include <cstdint>
+#include <functional>
 #include <fst/vector-fst.h>
 #include "StringToIntMapper.hpp"
 #include "../ParameterParser/ParameterParser.hpp"
 #include "FileData.hpp"
+#include "HTKLatticeParser.hpp"
+#include "LatticeStore.hpp"
 
 /* class to read input files */
 class FileReader {
@@ -85,6 +89,14 @@ class FileReader {
   std::vector<std::string> InputFileNames;
   std::vector<ArcInfo> InputArcInfos; // ArcInfo members: {label, start, end}
 
+  // members for out-of-core mode: writer for the preprocessed input fsts,
+  // number of fsts already written and the finished store
+  std::unique_ptr<LatticeStoreWriter> InputStoreWriter;
+  std::size_t NumStoredInputFsts;
+  std::shared_ptr<LatticeStore> InputLatticeStore;
+  // character n-grams of the stored input fsts for the input lexicon cache
+  std::vector<CharacterNGrams> InputCharacterNGrams;
+
   // members for reference fsts
   StringToIntMapper ReferenceStringToInt;
   std::vector<LogVectorFst> ReferenceFsts;
@@ -92,14 +104,64 @@ class FileReader {
 
   static const bool PARSE_REFERENCES = true;
 
+  // identification and format version of the binary corpus cache
+  static const uint64_t CORPUS_CACHE_MAGIC = 0x5355504f4353574cULL;
+  static const uint32_t CORPUS_CACHE_VERSION = 1;
+
+  // number of files read, interned and processed at once during parallel
+  // ingestion (bounds the memory used for parsed but unprocessed files)
+  static const std::size_t INGESTION_BLOCK_SIZE = 4096;
+
   PronDictType PronDict;
   /* internal functions: input */
+  // run Function(Idx) for Idx in [0, NumItems) using Params.NoThreads
+  // threads, rethrowing the first exception thrown by any of the calls
+  void ParallelFor(
+    std::size_t NumItems,
+    const std::function<void(std::size_t)> &Function
+  ) const;
+
+  // like ParallelFor, but call Function(Idx, IdxThread) with the index
+  // IdxThread < GetNumWorkerThreads(NumItems) of the calling worker thread
+  void ParallelForWithThreadIdx(
+    std::size_t NumItems,
+    const std::function<void(std::size_t, std::size_t)> &Function
+  ) const;
+
+  // number of threads used by ParallelFor for NumItems items
+  std::size_t GetNumWorkerThreads(
+    std::size_t NumItems
+  ) const;
+
+  // print the number of states and arcs of Fst to Log and prune Fst
+  // if a pruning factor was specified (by best path scores or posteriors)
+  void PruneAndLogLattice(
+    LogVectorFst *Fst,
+    std::ostream &Log
+  ) const;
+
+  // in out-of-core mode preprocess the input fsts read so far, append
+  // them to the lattice store and release them. The character n-grams
+  // for the input lexicon cache are collected before releasing them
+  void StoreInputBlock();
+
   void ReadHTKLattices();
 
+  // intern the phones of Lattice into GlobalStringToInt and append
+  // the arc infos (has to be called serially in file order)
+  void InternHTKLattice(
+    HTKLattice *Lattice
+  );
+
+  // build, optimize and prune the fst of an interned htk lattice
+  void BuildHTKLattice(
+    HTKLattice *Lattice
+  ) const;
+
   void ReadSegmentList(
     std::size_t InputFileId,
     std::string line, int debug_
-  );
+  ) const;
 
   void ReadOpenFSTLattices();
 
@@ -124,17 +186,38 @@ class FileReader {
   void ReadInputArcInfos();
 
 
-  /* Modifications */
-  void PruneLattices(
-    double PruningFactor
-  );
+  /* binary corpus cache */
+  // hash of the parameters and input file attributes the preprocessed
+  // corpus depends on
+  uint64_t GetCorpusCacheHash() const;
+
+  // read the preprocessed corpus from Params.CorpusCacheFile, returns false
+  // if the file does not exist or does not match the current parameters
+  bool ReadCorpusCache();
+
+  // write the preprocessed corpus to Params.CorpusCacheFile
+  void WriteCorpusCache() const;
 
+
+  /* Modifications */
   void ApplyAcousticModelScalingFactor();
 
-  void ApplyWordEndTransducer();
+  // transducer inserting </unk> after each character sequence
+  void BuildWordEndTransducer(
+    LogVectorFst *WordEndTransducer
+  ) const;
 
-  void ApplySentEndTransducer();
+  // transducer appending </s> </unk> to the sentence
+  void BuildSentEndTransducer(
+    LogVectorFst *SentEndTransducer
+  ) const;
 
+  // compose the input fsts in parallel with the word end transducer and
+  // then with the sentence end transducer
+  void ApplyWordEndAndSentEndTransducer();
+
+  // calculate the lattice phoneme error rate for all pruning factors from
+  // Params.PruningStart to Params.PruningEnd in parallel
   void CalculateLatticePhonemeErrorRate();
 
   /* internal functions: output */
@@ -144,19 +227,19 @@ class FileReader {
 
   bool IsSilence(
     std::string phone
-  );
+  ) const;
 
   std::string GetSubstrAfterSep(
     std::string inStr,
     char sep
-  );
+  ) const;
 
   void ReadPronDict();
 
   StateId AddPhoneToFst(
     LogVectorFst& LatticeFst, StateId State,
     const std::string& phone
-  );
+  ) const;
 
 public:
   /* constructor */
@@ -165,8 +248,9 @@ public:
     ParameterStruct Params
   );
 
-  // return class for input file handling
-  FileData GetInputFileData();
+  // return class for input file handling. The read data is moved into the
+  // returned object, so this can only be called once
+  FileData ReleaseInputFileData();
 };
 
 #endif
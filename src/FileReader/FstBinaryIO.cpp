@@ -0,0 +1,108 @@
+// ----------------------------------------------------------------------------
+/**
+   File: FstBinaryIO.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <stdexcept>
+#include "FstBinaryIO.hpp"
+
+void WriteFst(const LogVectorFst &Fst, BinaryWriter *Writer)
+{
+  Writer->Write<int64_t>(Fst.NumStates());
+  Writer->Write<int64_t>(Fst.Start());
+  Writer->Write<uint64_t>(Fst.Properties(fst::kCopyProperties, false));
+  for (StateId State = 0; State < Fst.NumStates(); ++State) {
+    Writer->Write<float>(Fst.Final(State).Value());
+    Writer->Write<uint64_t>(Fst.NumArcs(State));
+    for (fst::ArcIterator<LogVectorFst> ArcIter(Fst, State);
+         !ArcIter.Done(); ArcIter.Next()) {
+      const fst::LogArc &Arc = ArcIter.Value();
+      Writer->Write<int32_t>(Arc.ilabel);
+      Writer->Write<int32_t>(Arc.olabel);
+      Writer->Write<float>(Arc.weight.Value());
+      Writer->Write<int32_t>(Arc.nextstate);
+    }
+  }
+}
+
+void WriteFstVector(const std::vector<LogVectorFst> &Fsts, BinaryWriter *Writer)
+{
+  Writer->Write<uint64_t>(Fsts.size());
+  for (const auto &Fst : Fsts) {
+    WriteFst(Fst, Writer);
+  }
+}
+
+void ReadFst(BinaryReader *Reader, LogVectorFst *Fst)
+{
+  Fst->DeleteStates();
+  StateId NumStates = Reader->Read<int64_t>();
+  StateId Start = Reader->Read<int64_t>();
+  uint64_t Properties = Reader->Read<uint64_t>();
+  Fst->ReserveStates(NumStates);
+  for (StateId State = 0; State < NumStates; ++State) {
+    Fst->AddState();
+  }
+  for (StateId State = 0; State < NumStates; ++State) {
+    Fst->SetFinal(State, Reader->Read<float>());
+    std::size_t NumArcs = Reader->Read<uint64_t>();
+    if (Reader->GetNumBytesLeft() / (3 * sizeof(int32_t) + sizeof(float)) < NumArcs) {
+      throw std::runtime_error("Unexpected end of binary data");
+    }
+    Fst->ReserveArcs(State, NumArcs);
+    for (std::size_t ArcIdx = 0; ArcIdx < NumArcs; ++ArcIdx) {
+      int32_t ILabel = Reader->Read<int32_t>();
+      int32_t OLabel = Reader->Read<int32_t>();
+      float Weight = Reader->Read<float>();
+      int32_t NextState = Reader->Read<int32_t>();
+      Fst->AddArc(State, fst::LogArc(ILabel, OLabel, Weight, NextState));
+    }
+  }
+  if (Start != fst::kNoStateId) {
+    Fst->SetStart(Start);
+  }
+  Fst->SetProperties(Properties, fst::kCopyProperties);
+}
+
+void ReadFstVector(BinaryReader *Reader, std::vector<LogVectorFst> *Fsts)
+{
+  Fsts->resize(Reader->Read<uint64_t>());
+  for (auto &Fst : *Fsts) {
+    ReadFst(Reader, &Fst);
+  }
+}
@@ -0,0 +1,282 @@
+// ----------------------------------------------------------------------------
+/**
+   File: HTKLatticeParser.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "HTKLatticeParser.hpp"
+#include "../Utils/MappedFile.hpp"
+
+namespace {
+
+/* a [Begin, End) range in the parsed buffer */
+struct Token {
+  const char *Begin;
+  const char *End;
+
+  bool StartsWith(const char *Prefix) const {
+    std::size_t Length = std::strlen(Prefix);
+    return static_cast<std::size_t>(End - Begin) >= Length &&
+           std::memcmp(Begin, Prefix, Length) == 0;
+  }
+
+  // the part after the first '=' (the whole token if there is none)
+  Token Value() const {
+    const char *Sep = static_cast<const char *>(
+      std::memchr(Begin, '=', End - Begin));
+    return Token{Sep == NULL ? Begin : Sep + 1, End};
+  }
+
+  std::string String() const {
+    return std::string(Begin, End);
+  }
+};
+
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// get the next line (without '\n') starting at Pos and advance Pos
+bool NextLine(const char **Pos, const char *End, Token *Line)
+{
+  if (*Pos >= End) {
+    return false;
+  }
+  const char *LineEnd = static_cast<const char *>(
+    std::memchr(*Pos, '\n', End - *Pos));
+  if (LineEnd == NULL) {
+    LineEnd = End;
+  }
+  *Line = Token{*Pos, LineEnd};
+  *Pos = LineEnd == End ? End : LineEnd + 1;
+  return true;
+}
+
+// get the next whitespace separated token of a line, Tok is left
+// untouched if there are no more tokens (like std::istream >> std::string)
+bool NextToken(const char **Pos, const char *End, Token *Tok)
+{
+  const char *Begin = *Pos;
+  while (Begin < End && IsSpace(*Begin)) {
+    ++Begin;
+  }
+  if (Begin == End) {
+    *Pos = End;
+    return false;
+  }
+  const char *TokEnd = Begin;
+  while (TokEnd < End && !IsSpace(*TokEnd)) {
+    ++TokEnd;
+  }
+  *Tok = Token{Begin, TokEnd};
+  *Pos = TokEnd;
+  return true;
+}
+
+// integer conversion with the semantics of std::stoi
+long long ParseInteger(const Token &Tok)
+{
+  const char *Pos = Tok.Begin;
+  bool Negative = false;
+  if (Pos < Tok.End && (*Pos == '-' || *Pos == '+')) {
+    Negative = *Pos == '-';
+    ++Pos;
+  }
+  if (Pos == Tok.End || *Pos < '0' || *Pos > '9') {
+    throw std::invalid_argument("Invalid integer " + Tok.String());
+  }
+  long long Value = 0;
+  for (; Pos < Tok.End && *Pos >= '0' && *Pos <= '9'; ++Pos) {
+    Value = 10 * Value + (*Pos - '0');
+  }
+  return Negative ? -Value : Value;
+}
+
+// float conversion with the semantics of std::stof
+float ParseFloat(const Token &Tok)
+{
+  // strtof needs a terminated string, tokens are short
+  char Buffer[64];
+  std::string LongBuffer;
+  const char *Str = Buffer;
+  std::size_t Length = Tok.End - Tok.Begin;
+  if (Length < sizeof(Buffer)) {
+    std::memcpy(Buffer, Tok.Begin, Length);
+    Buffer[Length] = '\0';
+  } else {
+    LongBuffer = Tok.String();
+    Str = LongBuffer.c_str();
+  }
+  char *ParsedEnd;
+  float Value = std::strtof(Str, &ParsedEnd);
+  if (ParsedEnd == Str) {
+    throw std::invalid_argument("Invalid float " + Tok.String());
+  }
+  return Value;
+}
+
+} // namespace
+
+HTKLatticeParser::HTKLatticeParser(float LMScale, bool ReadNodeTimes) :
+  LMScale(LMScale),
+  ReadNodeTimes(ReadNodeTimes)
+{
+}
+
+std::size_t HTKLatticeParser::Parse(const std::string &FileName,
+                                    HTKLattice *Lattice) const
+{
+  MappedFile File(FileName);
+  Parse(File.GetData(), File.GetSize(), Lattice);
+  return File.GetSize();
+}
+
+void HTKLatticeParser::Parse(const char *Data, std::size_t Size,
+                             HTKLattice *Lattice) const
+{
+  float lmscale = LMScale;
+  const char *Pos = Data;
+  const char *End = Data + Size;
+  Token Line{Pos, Pos};
+  Token Tok{Pos, Pos};
+
+  //get Version (first line)
+  NextLine(&Pos, End, &Line);
+
+  //get Utterance
+  NextLine(&Pos, End, &Line);
+  Lattice->Utterance = Line.Value().String();
+
+  //get LM factor, Nodes and Links
+  while (NextLine(&Pos, End, &Line) && !Line.StartsWith("N")) {
+    if (Line.StartsWith("lmscale")) {
+      const char *LinePos = Line.Begin;
+      NextToken(&LinePos, Line.End, &Tok);
+      lmscale = ParseFloat(Tok.Value());
+    }
+  }
+
+  const char *LinePos = Line.Begin;
+  NextToken(&LinePos, Line.End, &Tok);
+  Lattice->NumNodes = ParseInteger(Tok.Value());
+  NextToken(&LinePos, Line.End, &Tok);
+  Lattice->Links.reserve(ParseInteger(Tok.Value()));
+
+  // read node times
+  if (ReadNodeTimes) {
+    Lattice->NodeTimes.resize(Lattice->NumNodes, -1);
+    for (std::size_t NodeId = 0; NodeId < Lattice->NumNodes; NodeId++) {
+      // find next node entry
+      bool Found = false;
+      while (NextLine(&Pos, End, &Line)) {
+        if (Line.StartsWith("I")) {
+          Found = true;
+          break;
+        }
+      }
+      if (!Found) {
+        break;
+      }
+      LinePos = Line.Begin;
+      NextToken(&LinePos, Line.End, &Tok); // discard node number
+      NextToken(&LinePos, Line.End, &Tok);
+      Lattice->NodeTimes[NodeId] = ParseFloat(Tok.Value());
+    }
+  }
+
+  //read the path
+  while (NextLine(&Pos, End, &Line)) {
+    if (!Line.StartsWith("J")) {       //only evaluate the links
+      continue;
+    }
+    //Format example: J=5 S=0 E=5 W="zh"  v=0 a=-273.284  l=-3.80666
+    // J: link no; S: start node; E: end node; W: phone;
+    // v: ???; a: acoustic model score; l: lm score
+    HTKLink Link;
+    LinePos = Line.Begin;
+
+    //discard link number
+    NextToken(&LinePos, Line.End, &Tok);
+
+    //start
+    if (!NextToken(&LinePos, Line.End, &Tok)) {
+      break;
+    }
+    Link.Start = ParseInteger(Tok.Value());
+
+    //end
+    if (!NextToken(&LinePos, Line.End, &Tok)) {
+      break;
+    }
+    Link.End = ParseInteger(Tok.Value());
+
+    // phone, RASR quotes the phones. We only want the phone
+    if (!NextToken(&LinePos, Line.End, &Tok)) {
+      break;
+    }
+    Token Phone = Tok.Value();
+    if (Phone.Begin < Phone.End && *Phone.Begin == '"') {
+      ++Phone.Begin;
+      Phone.End = std::max(Phone.Begin, Phone.End - 1);
+    }
+    Link.Phone = Phone.String();
+
+    //discard v
+    NextToken(&LinePos, Line.End, &Tok);
+    if (Tok.StartsWith("v=")) {
+      NextToken(&LinePos, Line.End, &Tok);
+    }
+
+    //acoustic model score
+    float amScore = -ParseFloat(Tok.Value());
+
+    //lm score
+    NextToken(&LinePos, Line.End, &Tok);
+    float lmScore = -ParseFloat(Tok.Value());
+    amScore = amScore / log(10);
+    amScore += lmscale * lmScore / log(10);
+    Link.Score = amScore;
+
+    Lattice->Links.push_back(Link);
+  } //end read line
+}
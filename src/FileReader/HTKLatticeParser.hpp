@@ -0,0 +1,128 @@
+// ----------------------------------------------------------------------------
+/**
+   File: HTKLatticeParser.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: zero-copy parser for htk standard lattice format (slf) files
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _HTKLATTICEPARSER_HPP_
+#define _HTKLATTICEPARSER_HPP_
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "definitions.hpp"
+
+// a single link of a htk lattice as read from file
+struct HTKLink {
+  int Start;                           // start node
+  int End;                             // end node
+  float Score;                         // combined am and lm score
+  std::string Phone;                   // phone label
+  CharId ILabel;                       // input label (set while interning)
+  CharId OLabel;                       // output label (set while interning)
+};
+
+// key of an arc used to merge links with identical start, label and end
+struct HTKArcKey {
+  int Start;                           // start node
+  CharId OLabel;                       // output label
+  int End;                             // end node
+
+  bool operator==(const HTKArcKey &Other) const {
+    return Start == Other.Start && OLabel == Other.OLabel && End == Other.End;
+  }
+};
+
+// hash function for HTKArcKey
+struct HTKArcKeyHash {
+  std::size_t operator()(const HTKArcKey &Key) const {
+    std::size_t Hash = std::hash<int>()(Key.Start);
+    Hash = Hash * 1000003 ^ std::hash<int>()(Key.OLabel);
+    return Hash * 1000003 ^ std::hash<int>()(Key.End);
+  }
+};
+
+// a htk lattice as read from file before its symbols have been interned
+struct HTKLattice {
+  std::string Utterance;               // utterance name
+  std::size_t NumNodes;                // number of nodes
+  std::vector<float> NodeTimes;        // node times if read
+  std::vector<HTKLink> Links;          // links in file order
+  LogVectorFst Fst;                    // resulting lattice fst
+  std::string Log;                     // messages printed in file order
+};
+
+/* parser for htk lattice files working directly on the mmap'd file */
+class HTKLatticeParser {
+  const float LMScale;                 // default lm scale if not in file
+  const bool ReadNodeTimes;            // read node times of the I= lines
+
+public:
+  /* constructor */
+  // set the default lm scale and whether node times are read
+  HTKLatticeParser(
+    float LMScale,
+    bool ReadNodeTimes
+  );
+
+  /* interface */
+  // parse file FileName into Lattice, returns the file size in bytes
+  std::size_t Parse(
+    const std::string &FileName,
+    HTKLattice *Lattice
+  ) const;
+
+  // parse the size Size buffer Data into Lattice
+  void Parse(
+    const char *Data,
+    std::size_t Size,
+    HTKLattice *Lattice
+  ) const;
+};
+
+#endif
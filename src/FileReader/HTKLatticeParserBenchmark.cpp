@@ -0,0 +1,99 @@
+// ----------------------------------------------------------------------------
+/**
+   File: HTKLatticeParserBenchmark.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include "HTKLatticeParser.hpp"
+
+// measure the throughput of the htk lattice parser on a list of files
+// usage: HTKLatticeParserBenchmark FileList [NumRepetitions] [-ReadNodeTimes]
+int main(int argc, const char **argv)
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " FileList [NumRepetitions] [-ReadNodeTimes]" << std::endl;
+    return 1;
+  }
+
+  // -ReadNodeTimes may be given at any position after the file list
+  int NumRepetitions = 1;
+  bool ReadNodeTimes = false;
+  for (int IdxArg = 2; IdxArg < argc; IdxArg++) {
+    if (std::string(argv[IdxArg]) == "-ReadNodeTimes") {
+      ReadNodeTimes = true;
+    } else {
+      NumRepetitions = std::atoi(argv[IdxArg]);
+    }
+  }
+
+  std::ifstream FileList(argv[1]);
+  if (!FileList) {
+    std::cerr << "Could not open file list " << argv[1] << std::endl;
+    return 1;
+  }
+  std::vector<std::string> InputFiles;
+  for (std::string InputFile; std::getline(FileList, InputFile); ) {
+    if (!InputFile.empty()) {
+      InputFiles.push_back(InputFile);
+    }
+  }
+
+  HTKLatticeParser Parser(0, ReadNodeTimes);
+  std::size_t NumBytes = 0;
+  std::size_t NumLinks = 0;
+  auto StartTime = std::chrono::steady_clock::now();
+  for (int Repetition = 0; Repetition < NumRepetitions; Repetition++) {
+    for (const auto &InputFile : InputFiles) {
+      HTKLattice Lattice;
+      NumBytes += Parser.Parse(InputFile, &Lattice);
+      NumLinks += Lattice.Links.size();
+    }
+  }
+  double Seconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - StartTime).count();
+
+  std::cout << "Parsed " << InputFiles.size() * NumRepetitions << " files ("
+            << NumBytes / 1e6 << " MB, " << NumLinks << " links) in "
+            << Seconds << " s: " << NumBytes / 1e6 / Seconds << " MB/s, "
+            << NumLinks / Seconds << " links/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,119 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LatticePruner.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <limits>
+#include <fst/arcsort.h>
+#include <fst/connect.h>
+#include <fst/shortest-distance.h>
+#include "LatticePruner.hpp"
+
+LatticePruner::LatticePruner(const LogVectorFst &Fst_, bool UsePosteriors) :
+  Fst(Fst_)
+{
+  if (UsePosteriors) {
+    CalculateScores(Fst);
+  } else {
+    LogToStdMapFst StdArcFst(Fst, fst::LogToStdMapper());
+    CalculateScores(StdArcFst);
+  }
+}
+
+
+template<class Arc>
+void LatticePruner::CalculateScores(const fst::Fst<Arc> &ScoreFst)
+{
+  std::vector<typename Arc::Weight> Alpha;
+  std::vector<typename Arc::Weight> Beta;
+  fst::ShortestDistance(ScoreFst, &Alpha);
+  fst::ShortestDistance(ScoreFst, &Beta, true);
+
+  const float Infinity = std::numeric_limits<float>::infinity();
+  StateId NumStates = Fst.NumStates();
+  Alpha.resize(NumStates, Arc::Weight::Zero());
+  Beta.resize(NumStates, Arc::Weight::Zero());
+  // total weight of all paths (log) or weight of the best path (tropical)
+  float Total = (Fst.Start() == fst::kNoStateId) ?
+                Infinity : Beta[Fst.Start()].Value();
+
+  ArcOffsets.resize(NumStates + 1);
+  FinalScores.resize(NumStates);
+  ArcScores.clear();
+  for (StateId State = 0; State < NumStates; ++State) {
+    ArcOffsets[State] = ArcScores.size();
+    float AlphaState = Alpha[State].Value();
+    FinalScores[State] = AlphaState + Fst.Final(State).Value() - Total;
+    for (fst::ArcIterator<LogVectorFst> ArcIter(Fst, State);
+         !ArcIter.Done(); ArcIter.Next()) {
+      const fst::LogArc &LatticeArc = ArcIter.Value();
+      ArcScores.push_back(AlphaState + LatticeArc.weight.Value() +
+                          Beta[LatticeArc.nextstate].Value() - Total);
+    }
+  }
+  ArcOffsets[NumStates] = ArcScores.size();
+}
+
+
+void LatticePruner::Prune(double Threshold, LogVectorFst *PrunedFst) const
+{
+  PrunedFst->DeleteStates();
+  StateId NumStates = Fst.NumStates();
+  if (Fst.Start() == fst::kNoStateId) {
+    return;
+  }
+  PrunedFst->ReserveStates(NumStates);
+  for (StateId State = 0; State < NumStates; ++State) {
+    PrunedFst->AddState();
+  }
+  PrunedFst->SetStart(Fst.Start());
+  for (StateId State = 0; State < NumStates; ++State) {
+    if (FinalScores[State] <= Threshold) {
+      PrunedFst->SetFinal(State, Fst.Final(State));
+    }
+    std::size_t IdxArc = ArcOffsets[State];
+    for (fst::ArcIterator<LogVectorFst> ArcIter(Fst, State);
+         !ArcIter.Done(); ArcIter.Next(), ++IdxArc) {
+      if (ArcScores[IdxArc] <= Threshold) {
+        PrunedFst->AddArc(State, ArcIter.Value());
+      }
+    }
+  }
+  fst::Connect(PrunedFst);
+  fst::ArcSort(PrunedFst, fst::OLabelCompare<fst::LogArc>());
+}
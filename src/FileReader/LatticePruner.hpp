@@ -0,0 +1,98 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LatticePruner.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: pruning of lattices by arc scores calculated once per lattice
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _LATTICEPRUNER_HPP_
+#define _LATTICEPRUNER_HPP_
+
+#include <vector>
+#include "definitions.hpp"
+
+/* prunes a lattice by the scores of its arcs. The forward and backward
+   scores are calculated once, lattices for any pruning threshold are then
+   derived by filtering the arcs without recalculating them. In the tropical
+   semiring the score of an arc is the weight of the best path through it
+   relative to the best path (same result as fst::Prune), in the log
+   semiring it is its negative log posterior */
+class LatticePruner {
+  const LogVectorFst &Fst;          // lattice to prune (has to outlive the pruner)
+  std::vector<std::size_t> ArcOffsets; // index of the first arc of each state in ArcScores
+  std::vector<float> ArcScores;     // score of each arc
+  std::vector<float> FinalScores;   // score of the final weight of each state
+
+
+  /* internal functions */
+  // calculate the forward and backward scores in the semiring of Arc
+  // and from those the arc and final scores
+  template<class Arc>
+  void CalculateScores(
+    const fst::Fst<Arc> &ScoreFst
+  );
+
+public:
+  /* constructor */
+  // calculate the scores of all arcs of Fst in the log (posteriors) or in
+  // the tropical semiring
+  LatticePruner(
+    const LogVectorFst &Fst_,
+    bool UsePosteriors
+  );
+
+
+  /* interface */
+  // write the lattice keeping only arcs and final weights with a score of
+  // at most Threshold to PrunedFst (connected and sorted by output label)
+  void Prune(
+    double Threshold,
+    LogVectorFst *PrunedFst
+  ) const;
+};
+
+#endif
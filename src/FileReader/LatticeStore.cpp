@@ -0,0 +1,262 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LatticeStore.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <sys/mman.h>
+#include "LatticeStore.hpp"
+
+namespace {
+
+const uint64_t LATTICE_STORE_MAGIC = 0x45524f5453534c4cULL;
+const uint32_t LATTICE_STORE_VERSION = 1;
+
+// estimated memory of a decoded vector fst
+std::size_t EstimateNumBytes(const LogVectorFst &Fst)
+{
+  std::size_t NumArcs = 0;
+  for (StateId State = 0; State < Fst.NumStates(); ++State) {
+    NumArcs += Fst.NumArcs(State);
+  }
+  return sizeof(LogVectorFst) + Fst.NumStates() * 64 +
+         NumArcs * sizeof(fst::LogArc);
+}
+
+} // namespace
+
+
+LatticeStoreWriter::LatticeStoreWriter(const std::string &FileName) :
+  FileName(FileName),
+  Writer(FileName)
+{
+  Writer.Write<uint64_t>(LATTICE_STORE_MAGIC);
+  Writer.Write<uint32_t>(LATTICE_STORE_VERSION);
+}
+
+void LatticeStoreWriter::Add(const LogVectorFst &Fst)
+{
+  Offsets.push_back(Writer.GetPosition());
+  WriteFst(Fst, &Writer);
+}
+
+void LatticeStoreWriter::Close()
+{
+  // offset table with end offset, followed by number of lattices and
+  // position of the table
+  uint64_t NumFsts = Offsets.size();
+  Offsets.push_back(Writer.GetPosition());
+
+  // align the table so that it can be used directly from the mapping
+  while (Writer.GetPosition() % sizeof(uint64_t) != 0) {
+    Writer.Write<char>(0);
+  }
+  uint64_t TableOffset = Writer.GetPosition();
+  for (uint64_t Offset : Offsets) {
+    Writer.Write<uint64_t>(Offset);
+  }
+  Writer.Write<uint64_t>(NumFsts);
+  Writer.Write<uint64_t>(TableOffset);
+  if (!Writer.Close()) {
+    throw std::runtime_error("Could not write lattice store " + FileName);
+  }
+}
+
+
+LatticeStore::LatticeStore(const std::string &FileName,
+                           std::size_t MaxNumBytes) :
+  File(FileName),
+  Offsets(NULL),
+  NumFsts(0),
+  MaxNumBytes(MaxNumBytes),
+  NumBytes(0),
+  Stop(false),
+  NumHits(0),
+  NumLoads(0),
+  NumPrefetches(0)
+{
+  const std::size_t HeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+  const std::size_t FooterSize = 2 * sizeof(uint64_t);
+  if (File.GetSize() < HeaderSize + FooterSize) {
+    throw std::runtime_error("Invalid lattice store " + FileName);
+  }
+  BinaryReader Header(File.GetData(), HeaderSize);
+  BinaryReader Footer(File.GetData() + File.GetSize() - FooterSize,
+                      FooterSize);
+  uint64_t Magic = Header.Read<uint64_t>();
+  uint32_t Version = Header.Read<uint32_t>();
+  NumFsts = Footer.Read<uint64_t>();
+  uint64_t TableOffset = Footer.Read<uint64_t>();
+  if (Magic != LATTICE_STORE_MAGIC || Version != LATTICE_STORE_VERSION ||
+      TableOffset + (NumFsts + 1) * sizeof(uint64_t) + FooterSize !=
+      File.GetSize() || TableOffset % sizeof(uint64_t) != 0) {
+    throw std::runtime_error("Invalid lattice store " + FileName);
+  }
+  Offsets = reinterpret_cast<const uint64_t *>(File.GetData() + TableOffset);
+
+  // lattices are visited in random order
+  madvise(const_cast<char *>(File.GetData()), File.GetSize(), MADV_RANDOM);
+
+  PrefetchThread = std::thread(&LatticeStore::PrefetchLoop, this);
+}
+
+LatticeStore::~LatticeStore()
+{
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stop = true;
+  }
+  Requested.notify_all();
+  PrefetchThread.join();
+}
+
+LatticeStore::FstPtr LatticeStore::Decode(std::size_t Idx) const
+{
+  BinaryReader Reader(File.GetData() + Offsets[Idx],
+                      Offsets[Idx + 1] - Offsets[Idx]);
+  std::shared_ptr<LogVectorFst> Fst = std::make_shared<LogVectorFst>();
+  ReadFst(&Reader, Fst.get());
+  return Fst;
+}
+
+LatticeStore::FstPtr LatticeStore::Load(std::size_t Idx,
+                                        std::unique_lock<std::mutex> *Lock,
+                                        bool IsPrefetch)
+{
+  for (;;) {
+    auto CacheIt = Cache.find(Idx);
+    if (CacheIt != Cache.end()) {
+      if (!IsPrefetch) {
+        NumHits++;
+        LruList.splice(LruList.begin(), LruList, CacheIt->second.LruPosition);
+      }
+      return CacheIt->second.Fst;
+    }
+    if (InFlight.count(Idx) == 0) {
+      break;
+    }
+    // the other thread is decoding this lattice already
+    Loaded.wait(*Lock);
+  }
+
+  // decode without holding the lock
+  InFlight.insert(Idx);
+  Lock->unlock();
+  FstPtr Fst;
+  try {
+    Fst = Decode(Idx);
+  } catch (...) {
+    Lock->lock();
+    InFlight.erase(Idx);
+    Loaded.notify_all();
+    throw;
+  }
+  std::size_t FstNumBytes = EstimateNumBytes(*Fst);
+  Lock->lock();
+  InFlight.erase(Idx);
+
+  // insert and evict least recently used lattices
+  LruList.push_front(Idx);
+  Cache[Idx] = CacheEntry{Fst, FstNumBytes, LruList.begin()};
+  NumBytes += FstNumBytes;
+  while (NumBytes > MaxNumBytes && LruList.size() > 1) {
+    auto EvictIt = Cache.find(LruList.back());
+    NumBytes -= EvictIt->second.NumBytes;
+    Cache.erase(EvictIt);
+    LruList.pop_back();
+  }
+  if (IsPrefetch) {
+    NumPrefetches++;
+  } else {
+    NumLoads++;
+  }
+  Loaded.notify_all();
+  return Fst;
+}
+
+LatticeStore::FstPtr LatticeStore::Get(std::size_t Idx)
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+  return Load(Idx, &Lock, false);
+}
+
+void LatticeStore::Prefetch(const std::vector<int> &Indices,
+                            std::size_t Begin, std::size_t End)
+{
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    PrefetchQueue.assign(Indices.begin() + std::min(Begin, Indices.size()),
+                         Indices.begin() + std::min(End, Indices.size()));
+  }
+  Requested.notify_all();
+}
+
+void LatticeStore::PrefetchLoop()
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+  for (;;) {
+    Requested.wait(Lock, [this]() { return Stop || !PrefetchQueue.empty(); });
+    if (Stop) {
+      return;
+    }
+    std::size_t Idx = PrefetchQueue.front();
+    PrefetchQueue.pop_front();
+    try {
+      Load(Idx, &Lock, true);
+    } catch (const std::exception &) {
+      // errors are reported when the lattice is actually requested
+    }
+  }
+}
+
+void LatticeStore::PrintStatistics()
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  std::ostringstream CacheSize;
+  CacheSize << std::fixed << std::setprecision(1)
+            << NumBytes / (1024.0 * 1024.0);
+  std::cout << " Lattice store: " << NumHits << " hits, " << NumLoads
+            << " loads, " << NumPrefetches << " prefetched, "
+            << CacheSize.str() << " MB in cache" << std::endl;
+  NumHits = 0;
+  NumLoads = 0;
+  NumPrefetches = 0;
+}
@@ -0,0 +1,177 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LatticeStore.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: memory mapped on-disk store of input lattices with lru cache and read-ahead
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _LATTICESTORE_HPP_
+#define _LATTICESTORE_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "definitions.hpp"
+#include "FstBinaryIO.hpp"
+#include "../Utils/MappedFile.hpp"
+
+/* writes lattices to a lattice store file */
+class LatticeStoreWriter {
+  std::string FileName;                // name of the store file
+  BinaryWriter Writer;                 // binary output
+  std::vector<uint64_t> Offsets;       // file offset of each lattice
+
+public:
+  /* constructor */
+  // create store file FileName
+  LatticeStoreWriter(
+    const std::string &FileName
+  );
+
+  /* interface */
+  // append Fst to the store
+  void Add(
+    const LogVectorFst &Fst
+  );
+
+  // write the offset table, throws std::runtime_error on write errors
+  void Close();
+};
+
+/* read only access to the lattices of a lattice store file, decoded
+ * lattices are kept in a lru cache with a memory budget and a background
+ * thread decodes lattices that will be needed soon */
+class LatticeStore {
+  typedef std::shared_ptr<const LogVectorFst> FstPtr;
+
+  // cached lattice and its position in the lru list
+  struct CacheEntry {
+    FstPtr Fst;
+    std::size_t NumBytes;
+    std::list<std::size_t>::iterator LruPosition;
+  };
+
+  MappedFile File;                     // mapped store file
+  const uint64_t *Offsets;             // offset table in the mapping
+  std::size_t NumFsts;                 // number of stored lattices
+  std::size_t MaxNumBytes;             // memory budget of the cache
+
+  std::mutex Mutex;                    // guards all following members
+  std::condition_variable Loaded;      // signaled when a lattice was decoded
+  std::condition_variable Requested;   // signaled when prefetching requested
+  std::unordered_map<std::size_t, CacheEntry> Cache; // decoded lattices
+  std::list<std::size_t> LruList;      // most recently used first
+  std::size_t NumBytes;                // estimated memory of cached lattices
+  std::unordered_set<std::size_t> InFlight; // lattices being decoded
+  std::deque<std::size_t> PrefetchQueue; // lattices to decode in background
+  bool Stop;                           // stop the prefetch thread
+  std::thread PrefetchThread;          // background decoding thread
+
+  // statistics since last call to PrintStatistics
+  std::size_t NumHits;
+  std::size_t NumLoads;
+  std::size_t NumPrefetches;
+
+  // get lattice Idx, decoding it if necessary (Lock has to hold Mutex)
+  FstPtr Load(
+    std::size_t Idx,
+    std::unique_lock<std::mutex> *Lock,
+    bool IsPrefetch
+  );
+
+  // decode lattice Idx from the mapped file
+  FstPtr Decode(
+    std::size_t Idx
+  ) const;
+
+  // main loop of the prefetch thread
+  void PrefetchLoop();
+
+public:
+  /* constructor */
+  // open store file FileName with a cache of MaxNumBytes bytes
+  LatticeStore(
+    const std::string &FileName,
+    std::size_t MaxNumBytes
+  );
+
+  /* destructor */
+  ~LatticeStore();
+
+  LatticeStore(const LatticeStore &) = delete;
+  LatticeStore &operator=(const LatticeStore &) = delete;
+
+  /* interface */
+  // get number of stored lattices
+  std::size_t GetNumFsts() const {
+    return NumFsts;
+  }
+
+  // get lattice Idx (thread safe)
+  FstPtr Get(
+    std::size_t Idx
+  );
+
+  // replace the pending prefetch requests by Indices[Begin, End)
+  void Prefetch(
+    const std::vector<int> &Indices,
+    std::size_t Begin,
+    std::size_t End
+  );
+
+  // print and reset cache statistics
+  void PrintStatistics();
+};
+
+#endif
@@ -0,0 +1,188 @@
+// ----------------------------------------------------------------------------
+/**
+   File: InputLexiconCache.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include "InputLexiconCache.hpp"
+
+InputLexiconCache::InputLexiconCache(const FileData &InputFileData, std::size_t MaxNumBytes_) :
+  MaxNumBytes(MaxNumBytes_),
+  SentenceNGrams(InputFileData.GetNumInputFsts()),
+  UnigramIndex(),
+  BigramIndex(),
+  Entries(),
+  LruList(),
+  NumBytes(0),
+  NumHits(0),
+  NumMisses(0),
+  NumInvalidations(0),
+  NumEvictions(0)
+{
+  for (std::size_t IdxSentence = 0; IdxSentence < SentenceNGrams.size(); ++IdxSentence) {
+    SentenceNGrams[IdxSentence] = InputFileData.GetInputCharacterNGrams(IdxSentence);
+    for (CharId Unigram : SentenceNGrams[IdxSentence].Unigrams) {
+      UnigramIndex[Unigram].push_back(IdxSentence);
+    }
+    for (uint64_t Bigram : SentenceNGrams[IdxSentence].Bigrams) {
+      BigramIndex[Bigram].push_back(IdxSentence);
+    }
+  }
+}
+
+std::shared_ptr<const LogVectorFst> InputLexiconCache::Get(int SentenceIdx)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  auto Entry = Entries.find(SentenceIdx);
+  if (Entry == Entries.end()) {
+    NumMisses++;
+    return std::shared_ptr<const LogVectorFst>();
+  }
+  NumHits++;
+  LruList.splice(LruList.begin(), LruList, Entry->second.LruPosition);
+  return Entry->second.InputLexiconFst;
+}
+
+void InputLexiconCache::Put(int SentenceIdx, const std::shared_ptr<const LogVectorFst> &InputLexiconFst)
+{
+  // estimate memory size of composition (arcs and state data)
+  std::size_t NumArcs = 0;
+  for (StateId s = 0; s < InputLexiconFst->NumStates(); ++s) {
+    NumArcs += InputLexiconFst->NumArcs(s);
+  }
+  std::size_t EntryNumBytes = NumArcs * sizeof(fst::LogArc) +
+    InputLexiconFst->NumStates() * (sizeof(std::vector<fst::LogArc>) + sizeof(fst::LogArc::Weight) + 3 * sizeof(std::size_t));
+  if (EntryNumBytes > MaxNumBytes) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  auto Entry = Entries.find(SentenceIdx);
+  if (Entry != Entries.end()) {
+    RemoveEntry(Entry);
+  }
+  while (NumBytes + EntryNumBytes > MaxNumBytes) {
+    RemoveEntry(Entries.find(LruList.back()));
+    NumEvictions++;
+  }
+  LruList.push_front(SentenceIdx);
+  Entries[SentenceIdx] = CacheEntry{InputLexiconFst, EntryNumBytes, LruList.begin()};
+  NumBytes += EntryNumBytes;
+}
+
+void InputLexiconCache::Invalidate(const std::vector<std::vector<CharId> > &ChangedPrefixes)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  for (const std::vector<CharId> &Prefix : ChangedPrefixes) {
+    if (Entries.empty()) {
+      return;
+    }
+    if (Prefix.empty()) {
+      continue;
+    }
+
+    // candidate sentences contain the first character or bigram of the prefix
+    const std::vector<int> *Candidates;
+    if (Prefix.size() == 1) {
+      auto Unigram = UnigramIndex.find(Prefix[0]);
+      if (Unigram == UnigramIndex.end()) {
+        continue;
+      }
+      Candidates = &Unigram->second;
+    } else {
+      auto Bigram = BigramIndex.find(CharacterNGrams::BigramKey(Prefix[0], Prefix[1]));
+      if (Bigram == BigramIndex.end()) {
+        continue;
+      }
+      Candidates = &Bigram->second;
+    }
+
+    // invalidate cached sentences which contain all bigrams of the prefix,
+    // checking the cached entries directly if there are fewer of them than
+    // candidates (the candidates of common bigrams cover most of the corpus)
+    if (Entries.size() < Candidates->size()) {
+      for (auto Entry = Entries.begin(); Entry != Entries.end();) {
+        auto NextEntry = std::next(Entry);
+        if (SentenceNGrams[Entry->first].MayContain(Prefix)) {
+          RemoveEntry(Entry);
+          NumInvalidations++;
+        }
+        Entry = NextEntry;
+      }
+    } else {
+      for (int SentenceIdx : *Candidates) {
+        auto Entry = Entries.find(SentenceIdx);
+        if ((Entry != Entries.end()) && SentenceNGrams[SentenceIdx].MayContain(Prefix)) {
+          RemoveEntry(Entry);
+          NumInvalidations++;
+        }
+      }
+    }
+  }
+}
+
+void InputLexiconCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  NumInvalidations += Entries.size();
+  Entries.clear();
+  LruList.clear();
+  NumBytes = 0;
+}
+
+void InputLexiconCache::PrintStatistics()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  std::cout << " Input*Lexicon cache: " << NumHits << " hits, " << NumMisses << " misses, "
+            << NumInvalidations << " invalidated, " << NumEvictions << " evicted, "
+            << Entries.size() << " entries (" << std::fixed << std::setprecision(2)
+            << NumBytes / (1024.0 * 1024.0) << " MB)" << std::endl;
+  NumHits = 0;
+  NumMisses = 0;
+  NumInvalidations = 0;
+  NumEvictions = 0;
+}
+
+void InputLexiconCache::RemoveEntry(std::unordered_map<int, CacheEntry>::iterator Entry)
+{
+  NumBytes -= Entry->second.NumBytes;
+  LruList.erase(Entry->second.LruPosition);
+  Entries.erase(Entry);
+}
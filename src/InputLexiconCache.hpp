@@ -0,0 +1,127 @@
+// ----------------------------------------------------------------------------
+/**
+   File: InputLexiconCache.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: cache for the compositions of input and lexicon fst
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _INPUTLEXICONCACHE_HPP_
+#define _INPUTLEXICONCACHE_HPP_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include "definitions.hpp"
+#include "FileReader/FileData.hpp"
+
+/* per sentence cache for the compositions of input and lexicon fst with
+ * least recently used eviction. Entries are invalidated if a word prefix
+ * changed in the lexicon fst may occur in the input of the sentence
+ * (checked using the character unigrams and bigrams of the input) */
+class InputLexiconCache {
+  /* a cached composition */
+  struct CacheEntry {
+    std::shared_ptr<const LogVectorFst> InputLexiconFst; // composition of input and lexicon
+    std::size_t NumBytes;                                // estimated memory size of composition
+    std::list<int>::iterator LruPosition;                // position in least recently used list
+  };
+
+  const std::size_t MaxNumBytes;                                 // memory budget for cached compositions
+  std::vector<CharacterNGrams> SentenceNGrams;                   // character unigrams and bigrams of input for every sentence
+  std::unordered_map<CharId, std::vector<int> > UnigramIndex;    // sentences containing a character
+  std::unordered_map<uint64_t, std::vector<int> > BigramIndex;   // sentences containing a character bigram
+  std::unordered_map<int, CacheEntry> Entries;                   // cached compositions
+  std::list<int> LruList;                                        // sentence indices of entries, most recently used first
+  std::size_t NumBytes;                                          // estimated memory size of all entries
+  std::size_t NumHits;                                           // number of cache hits
+  std::size_t NumMisses;                                         // number of cache misses
+  std::size_t NumInvalidations;                                  // number of invalidated entries
+  std::size_t NumEvictions;                                      // number of evicted entries
+  std::mutex mtx;                                                // lock for entries and statistics
+
+
+  /* internal functions */
+  // remove an entry from the cache (lock has to be held)
+  void RemoveEntry(
+    std::unordered_map<int, CacheEntry>::iterator Entry
+  );
+
+public:
+  /* constructor */
+  // setup the cache for the input fsts and memory budget in bytes (uses
+  // the character n-grams collected when the input fsts were stored)
+  InputLexiconCache(
+    const FileData &InputFileData,
+    std::size_t MaxNumBytes_
+  );
+
+
+  /* interface */
+  // return cached composition for sentence (NULL if not cached)
+  std::shared_ptr<const LogVectorFst> Get(
+    int SentenceIdx
+  );
+
+  // add composition for sentence to cache (evicts least recently used entries if necessary)
+  void Put(
+    int SentenceIdx,
+    const std::shared_ptr<const LogVectorFst> &InputLexiconFst
+  );
+
+  // invalidate all entries whose input may contain one of the changed word prefixes
+  void Invalidate(
+    const std::vector<std::vector<CharId> > &ChangedPrefixes
+  );
+
+  // remove all entries
+  void Clear();
+
+  // print hits, misses, invalidations, evictions and memory size and reset the counters
+  void PrintStatistics();
+};
+
+#endif
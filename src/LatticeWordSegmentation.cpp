@@ -45,6 +45,8 @@
 #include <iomanip>
 #include <numeric>
 #include <chrono>
+#include <sstream>
+#include <boost/filesystem/operations.hpp>
 #include <fst/compose.h>
 #include "LatticeWordSegmentation.hpp"
 #include "SampleLib.hpp"
@@ -53,6 +55,12 @@
 #include "NHPYLMFst.hpp"
 #include "WordLengthProbCalculator.hpp"
 #include "Evaluate/Evaluate.hpp"
+#include "Utils/BinaryIO.hpp"
+#include "Utils/MappedFile.hpp"
+#include "NHPYLM/MappedNHPYLM.hpp"
+
+const uint64_t LatticeWordSegmentation::CHECKPOINT_MAGIC;
+const uint32_t LatticeWordSegmentation::CHECKPOINT_VERSION;
 
 std::default_random_engine LatticeWordSegmentation::RandomGenerator(
   std::chrono::system_clock::now().time_since_epoch().count()
@@ -65,18 +73,22 @@ LatticeWordSegmentation::LatticeWordSegmentation(const ParameterStruct& Params,
   InputFileData(InputFileData),
   MaxNumThreads(Params.NoThreads),
   Threads(MaxNumThreads - 1),
-  Timer(MaxNumThreads, 4)
+  Timer(MaxNumThreads, 4),
+  NumInputLexiconTransitions(MaxNumThreads, std::vector<std::size_t>(2, 0)),
+  InputLexiconFstCache(NULL)
 {
 }
 
 /*****************************************************************************
  * Main functions to perform word segmentation
  * - Entry function: DoWordSegmentation
- *   - Do initializations of language model and output variables and run outer
- *     loop over iterations. Also reinitialized lexicon transducer before each
- *     iteration and upddates languge model after iteration (possibly changes
- *     language model orders). Outputs results and statistics after each
- *     iteration
+ *   - Do initializations of language model, lexicon transducer and output
+ *     variables and run outer loop over iterations. Also updates the length
+ *     scaling of the lexicon transducer before each iteration and upddates
+ *     languge model after iteration (possibly changes language model orders).
+ *     Outputs results and statistics after each iteration. Optionally
+ *     resumes from a checkpoint and writes checkpoints of the sampler state.
+ *     Finally exports the language model, if specified
  * - Perform main segmentation and inference steps:
  *   DoWordSegmentationSentenceIterations
  *   - Remove sentences from dictionary, language model and fsts
@@ -89,29 +101,97 @@ void LatticeWordSegmentation::DoWordSegmentation()
 {
   std::cout << " Starting word segmentation!" << std::endl;
 
-  // initialize empty language model and dictionary and perform
-  // language model initialization from initialization sentences
-  // (parse reference fsts, add to language model and retrain)
-  InitializeLanguageModel(Params.UnkN, Params.KnownN);
+  NumSampledSentences = InputFileData.GetNumInputFsts();
 
-  // initialize output vector for sampled sentences and fsts
-  NumSampledSentences = InputFileData.GetInputFsts().size();
-  SampledSentences.resize(
-    NumSampledSentences,
-    std::vector<int>(WHPYLMContextLength, SentEndWordId)
-  );
+  // create index vector of shuffled sentence indices
+  std::vector<int> ShuffledIndices(NumSampledSentences);
+  std::iota(ShuffledIndices.begin(), ShuffledIndices.end(), 0);
+
+  // restore language model, dictionary and sampled sentences from the
+  // checkpoint if resuming. Otherwise initialize empty language model and
+  // dictionary and perform language model initialization from
+  // initialization sentences (parse reference fsts, add to language model
+  // and retrain)
+  std::size_t NumCompletedIterations = 0;
+  if (Params.Resume && Params.CheckpointFile.empty()) {
+    std::cout << "Warning: -Resume needs a checkpoint file given by "
+              << "-Checkpoint, starting from scratch!" << std::endl;
+  }
+  bool IsResumed = Params.Resume && !Params.CheckpointFile.empty() &&
+                   ReadCheckpoint(&ShuffledIndices, &NumCompletedIterations);
+  if (!IsResumed) {
+    InitializeLanguageModel(Params.UnkN, Params.KnownN);
+    SampledSentences.resize(
+      NumSampledSentences,
+      std::vector<int>(WHPYLMContextLength, SentEndWordId)
+    );
+  }
+
+  // initialize output vector for sampled fsts (the timed sentences and
+  // fsts of all sentences are sampled again in every iteration, so they
+  // are not part of a checkpoint)
   TimedSampledSentences.resize(NumSampledSentences);
   SampledFsts.resize(NumSampledSentences);
 
+  // sample text input without fsts, if specified. The number of states per
+  // position grows exponentially with the word lm order
+  unsigned int MaxKnownN = (Params.SwitchIter > 0) ?
+    std::max(Params.KnownN, Params.NewKnownN) : Params.KnownN;
+  if ((Params.StringSegmentation > 0) && (Params.LatticeFileType != TEXT)) {
+    std::cout << "Warning: -StringSegmentation is only supported for text "
+              << "input, sampling from fsts!" << std::endl;
+  } else if ((Params.StringSegmentation > 0) &&
+             (StringSampleLib::GetNumStates(MaxKnownN, Params.StringSegmentation) >
+              StringSampleLib::MAX_NUM_STATES)) {
+    std::cout << "Warning: -StringSegmentation " << Params.StringSegmentation
+              << " with -KnownN " << MaxKnownN << " needs more than "
+              << StringSampleLib::MAX_NUM_STATES << " states per character, "
+              << "sampling from fsts!" << std::endl;
+  } else if (Params.StringSegmentation > 0) {
+    StringSamplingBuffers.resize(MaxNumThreads);
+    InputCharacterSequences.resize(NumSampledSentences);
+    for (std::size_t IdxSentence = 0; IdxSentence < NumSampledSentences;
+         ++IdxSentence) {
+      InputCharacterSequences[IdxSentence] =
+        StringSampleLib::ParseCharacterSequence(
+          *InputFileData.GetInputFst(IdxSentence));
+    }
+  }
+
   //Create Evaluate object to perform measurements
-  Evaluate Eval(Params, InputFileData, Timer, LanguageModel);
+  Evaluate Eval(Params, InputFileData, Timer, LanguageModel, IsResumed);
 
-  // create index vector of shuffled sentence indices
-  std::vector<int> ShuffledIndices(NumSampledSentences);
-  std::iota(ShuffledIndices.begin(), ShuffledIndices.end(), 0);
+  // start writer for checkpoints of the sampler state, if specified
+  std::unique_ptr<CheckpointWriter> Checkpoints;
+  if (!Params.CheckpointFile.empty()) {
+    Checkpoints.reset(new CheckpointWriter(Params.CheckpointFile));
+  }
+
+  // initialize lexicon transducer (updated on the fly when words are added
+  // to or removed from the dictionary)
+  Timer.tLexFst.SetStart();
+  LexFst LexiconTransducer(
+    Params.Debug,
+    InputFileData.GetInputIntToStringVector(),
+    CHARACTERSBEGIN,
+    LanguageModel->GetWHPYLMBaseProbabilitiesScale()
+  );
+  LexiconTransducer.BuildLexiconTansducer(LanguageModel->GetWord2Id());
+  Timer.tLexFst.AddTimeSinceStartToDuration();
+
+  // initialize cache for compositions of input and lexicon, entries are
+  // invalidated using the word prefixes changed in the lexicon transducer
+  if (Params.InputLexiconCacheSize > 0) {
+    InputLexiconFstCache = new InputLexiconCache(
+      InputFileData,
+      static_cast<std::size_t>(Params.InputLexiconCacheSize) * 1024 * 1024
+    );
+    LexiconTransducer.SetTrackChanges(true);
+  }
 
   // run the actual iterations
-  for (std::size_t IdxIter = 0; IdxIter < Params.NumIter; ++IdxIter) {
+  for (std::size_t IdxIter = NumCompletedIterations;
+       IdxIter < Params.NumIter; ++IdxIter) {
     std::cout << "  Iteration: " << IdxIter + 1
               << " of " << Params.NumIter << std::endl;
 
@@ -119,20 +199,48 @@ void LatticeWordSegmentation::DoWordSegmentation()
     std::shuffle(ShuffledIndices.begin(), ShuffledIndices.end(),
                  RandomGenerator);
 
-    // initialize lexicon transducer
+    // update character sequence length scaling of lexicon transducer
+    // (changes all compositions with the lexicon) and compact it if too
+    // many states are unused
     Timer.tLexFst.SetStart();
-    LexFst LexiconTransducer(
-      Params.Debug,
-      InputFileData.GetInputIntToStringVector(),
-      CHARACTERSBEGIN,
-      LanguageModel->GetWHPYLMBaseProbabilitiesScale()
-    );
-    LexiconTransducer.BuildLexiconTansducer(LanguageModel->GetWord2Id());
+    if (LexiconTransducer.GetCharacterSequenceProbabilityScale() !=
+        LanguageModel->GetWHPYLMBaseProbabilitiesScale()) {
+      LexiconTransducer.SetCharacterSequenceProbabilityScale(
+        LanguageModel->GetWHPYLMBaseProbabilitiesScale());
+      if (InputLexiconFstCache != NULL) {
+        InputLexiconFstCache->Clear();
+      }
+    }
+    if ((Params.LexFstCompaction > 0) &&
+        (LexiconTransducer.GetNumFreeStates() >
+         Params.LexFstCompaction * LexiconTransducer.GetNumStates())) {
+      LexiconTransducer.Compact();
+    }
     Timer.tLexFst.AddTimeSinceStartToDuration();
 
     // iterate over every sentence
     DoWordSegmentationSentenceIterations(
       ShuffledIndices, &LexiconTransducer, IdxIter);
+    std::cout << " Lexicon FST: " << LexiconTransducer.GetNumStates()
+              << " states (" << LexiconTransducer.GetNumFreeStates()
+              << " unused)" << std::endl;
+    if (Params.TrimInputLexicon) {
+      std::size_t NumTransitions = 0;
+      std::size_t NumCutTransitions = 0;
+      for (auto &NumThreadTransitions : NumInputLexiconTransitions) {
+        NumTransitions += NumThreadTransitions[0];
+        NumCutTransitions += NumThreadTransitions[1];
+        std::fill(NumThreadTransitions.begin(), NumThreadTransitions.end(), 0);
+      }
+      std::cout << " Input*Lexicon FSTs: " << NumTransitions
+                << " transitions, " << NumCutTransitions
+                << " dead end transitions cut by lookahead" << std::endl;
+    }
+    if (InputLexiconFstCache != NULL) {
+      InputLexiconFstCache->PrintStatistics();
+    }
+    InputFileData.PrintInputFstStatistics();
+    std::cout << std::endl;
 
     // calculate and update word length statistics
     WordLengthProbCalculator::UpdateWHPYLMBaseProbabilitiesScale(
@@ -153,16 +261,44 @@ void LatticeWordSegmentation::DoWordSegmentation()
     }
 
     // Evaluation of current iteration
-    Eval.WriteSentencesToOutputFiles(
-          SampledSentences, TimedSampledSentences, IdxIter);
-    Eval.OutputMeasureStatistics(SampledSentences, SampledFsts, IdxIter);
+    Eval.EvaluateIteration(
+          SampledSentences, TimedSampledSentences, SampledFsts, IdxIter);
 
     // switch language model order, if specified
+    // (word ids change, so the lexicon transducer has to be rebuilt)
     if ((IdxIter + 1) == Params.SwitchIter) {
       SwitchLanguageModelOrders(Params.NewUnkN, Params.NewKnownN);
+      Timer.tLexFst.SetStart();
+      LexiconTransducer.BuildLexiconTansducer(LanguageModel->GetWord2Id());
+      if (InputLexiconFstCache != NULL) {
+        InputLexiconFstCache->Clear();
+      }
+      Timer.tLexFst.AddTimeSinceStartToDuration();
+    }
+
+    // write checkpoint every CheckpointInterval iterations and after the
+    // last iteration (serialized here, written in the background)
+    if (Checkpoints &&
+        (((Params.CheckpointInterval > 0) &&
+          ((IdxIter + 1) % Params.CheckpointInterval == 0)) ||
+         ((IdxIter + 1) == Params.NumIter))) {
+      WriteCheckpoint(IdxIter, ShuffledIndices, Checkpoints.get());
     }
   }
+  Eval.FinishEvaluation();
+  if (Checkpoints) {
+    Checkpoints->Flush();
+  }
+  if (!Params.ExportLMFile.empty()) {
+    ExportLanguageModel();
+  } else if (!Params.ExportARPAFile.empty()) {
+    std::cout << "Warning: -ExportARPA needs a language model file given by "
+              << "-ExportLM, no arpa file written!" << std::endl;
+  }
+
   // cleanup
+  delete InputLexiconFstCache;
+  InputLexiconFstCache = NULL;
   delete LanguageModel;
 }
 
@@ -180,6 +316,14 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
     std::cout << "\r   Sentence: " << IdxSentence + 1
               << " of " << NumSampledSentences;
 
+    // load the input lattices of this and the next batches in the
+    // background (out-of-core mode only)
+    if (InputCharacterSequences.empty()) {
+      InputFileData.PrefetchInputFsts(
+        ShuffledIndices, IdxSentence,
+        IdxSentence + (1 + LATTICE_READ_AHEAD_BATCHES) * MaxNumThreads);
+    }
+
     // remove words from lexicon, fst and lm
     Timer.tRemove.SetStart();
     for (std::size_t IdxThread = 0; IdxThread < NumThreads; ++IdxThread) {
@@ -194,6 +338,13 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
     }
     Timer.tRemove.AddTimeSinceStartToDuration();
 
+    // invalidate cached compositions affected by the lexicon changes of
+    // the last parsing and the removal
+    if (InputLexiconFstCache != NULL) {
+      InputLexiconFstCache->Invalidate(LexiconTransducer->GetChangedPrefixes());
+      LexiconTransducer->ClearChangedPrefixes();
+    }
+
     // start composing and sampling threads
     // the last thread will run in the main program since this is
     // more effective if running only one thread
@@ -203,15 +354,34 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
 
     auto SampleFn = [&](std::size_t IdxSentence, std::size_t IdxThread){
       std::size_t CurrentIndex = ShuffledIndices[IdxSentence + IdxThread];
+      if (!InputCharacterSequences.empty()) {
+        Timer.tInSamples[IdxThread][3].SetStart();
+        StringSampleLib::SampleFromCharacterSequence(
+                    InputCharacterSequences[CurrentIndex],
+                    LanguageModel,
+                    SentEndWordId,
+                    Params.StringSegmentation,
+                    UseViterby,
+                    &StringSamplingBuffers[IdxThread],
+                    &SampledFsts[CurrentIndex]);
+        Timer.tInSamples[IdxThread][3].AddTimeSinceStartToDuration();
+        return;
+      }
+      std::shared_ptr<const LogExpandedFst> InputFst =
+        InputFileData.GetInputFst(CurrentIndex);
       SampleLib::ComposeAndSampleFromInputLexiconAndLM(
-                    &InputFileData.GetInputFsts().at(CurrentIndex),
+                    InputFst.get(),
                     LexiconTransducer,
                     LanguageModel,
                     SentEndWordId,
                     &SampledFsts[CurrentIndex],
                     &Timer.tInSamples[IdxThread],
                     Params.BeamWidth,
-                    UseViterby);
+                    UseViterby,
+                    Params.TrimInputLexicon,
+                    &NumInputLexiconTransitions[IdxThread],
+                    InputLexiconFstCache,
+                    CurrentIndex);
     };
 
     for (std::size_t IdxThread = 0; IdxThread < (NumThreads - 1); ++IdxThread) {
@@ -246,6 +416,137 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
   std::cout << std::endl << std::endl;
 }
 
+/***********************************************************
+ * Functions for checkpoints of the sampler state:
+ * - WriteCheckpoint
+ * - ReadCheckpoint
+************************************************************/
+
+void LatticeWordSegmentation::WriteCheckpoint(
+  std::size_t IdxIter,
+  const std::vector<int> &ShuffledIndices,
+  CheckpointWriter *Checkpoints
+)
+{
+  std::cout << " Writing checkpoint after iteration " << IdxIter + 1
+            << " to " << Params.CheckpointFile << std::endl;
+
+  // the state of rand() (used for sampling from the fsts) cannot be read,
+  // so it is reseeded with a value drawn from it which is stored instead
+  unsigned int RandSeed = std::rand();
+  std::srand(RandSeed);
+
+  BinaryWriter Writer;
+  Writer.Write<uint64_t>(CHECKPOINT_MAGIC);
+  Writer.Write<uint32_t>(CHECKPOINT_VERSION);
+  Writer.Write<uint64_t>(NumSampledSentences);
+  Writer.Write<uint64_t>(InputFileData.GetInputIntToStringVector().size());
+  Writer.Write<uint64_t>(IdxIter + 1);
+
+  // random states
+  std::ostringstream RandomState;
+  RandomState << RandomGenerator;
+  Writer.WriteString(RandomState.str());
+  Writer.WriteString(HPYLM::GetRandomState());
+  Writer.WriteString(Restaurant::GetRandomState());
+  Writer.Write<uint32_t>(RandSeed);
+  Writer.WriteVector(ShuffledIndices);
+
+  // language model and sampled sentences
+  Writer.Write<uint32_t>(LanguageModel->GetCHPYLMOrder());
+  Writer.Write<uint32_t>(LanguageModel->GetWHPYLMOrder());
+  LanguageModel->Write(&Writer);
+  for (const auto &Sentence : SampledSentences) {
+    Writer.WriteVector(Sentence);
+  }
+
+  Checkpoints->Write(Writer.GetBuffer());
+}
+
+bool LatticeWordSegmentation::ReadCheckpoint(
+  std::vector<int> *ShuffledIndices,
+  std::size_t *NumCompletedIterations
+)
+{
+  if (!boost::filesystem::exists(Params.CheckpointFile)) {
+    std::cout << " No checkpoint " << Params.CheckpointFile
+              << " found, starting from scratch!" << std::endl;
+    return false;
+  }
+
+  std::cout << " Resuming from checkpoint " << Params.CheckpointFile
+            << std::endl;
+  MappedFile File(Params.CheckpointFile);
+  BinaryReader Reader(File.GetData(), File.GetSize());
+  if ((Reader.Read<uint64_t>() != CHECKPOINT_MAGIC) ||
+      (Reader.Read<uint32_t>() != CHECKPOINT_VERSION)) {
+    throw std::runtime_error(Params.CheckpointFile +
+                             " is not a checkpoint of this version");
+  }
+  if ((Reader.Read<uint64_t>() != NumSampledSentences) ||
+      (Reader.Read<uint64_t>() !=
+       InputFileData.GetInputIntToStringVector().size())) {
+    throw std::runtime_error("Checkpoint " + Params.CheckpointFile +
+                             " does not match the input data");
+  }
+  *NumCompletedIterations = Reader.Read<uint64_t>();
+
+  // random states
+  std::istringstream RandomState(Reader.ReadString());
+  if (!(RandomState >> RandomGenerator)) {
+    throw std::runtime_error("Invalid random state in checkpoint");
+  }
+  HPYLM::SetRandomState(Reader.ReadString());
+  Restaurant::SetRandomState(Reader.ReadString());
+  std::srand(Reader.Read<uint32_t>());
+  Reader.ReadVector(ShuffledIndices);
+  if (ShuffledIndices->size() != NumSampledSentences) {
+    throw std::runtime_error("Invalid sentence order in checkpoint");
+  }
+
+  // language model and sampled sentences
+  int UnkN = Reader.Read<uint32_t>();
+  int KnownN = Reader.Read<uint32_t>();
+  LanguageModel = new NHPYLM(UnkN, KnownN,
+                             InputFileData.GetInputIntToStringVector(),
+                             CHARACTERSBEGIN);
+  LanguageModel->Read(&Reader);
+  SentEndWordId = LanguageModel->GetWordId(
+                    std::vector<int>(1, SENTEND_SYMBOLID).begin(), 1);
+  WHPYLMContextLength = LanguageModel->GetWHPYLMOrder() - 1;
+  SampledSentences.resize(NumSampledSentences);
+  for (auto &Sentence : SampledSentences) {
+    Reader.ReadVector(&Sentence);
+  }
+
+  std::cout << "  Continuing after iteration " << *NumCompletedIterations
+            << " with KnownN=" << KnownN << ", UnkN=" << UnkN
+            << std::endl << std::endl;
+  return true;
+}
+
+/***********************************************************
+ * Functions for exporting the trained language model:
+ * - ExportLanguageModel
+************************************************************/
+
+void LatticeWordSegmentation::ExportLanguageModel() const
+{
+  std::cout << " Exporting language model to " << Params.ExportLMFile
+            << std::endl;
+  try {
+    LanguageModel->Export(Params.ExportLMFile);
+    if (!Params.ExportARPAFile.empty()) {
+      std::cout << " Writing arpa file " << Params.ExportARPAFile
+                << std::endl;
+      MappedNHPYLM(Params.ExportLMFile).WriteARPA(Params.ExportARPAFile);
+    }
+  } catch (const std::runtime_error &e) {
+    std::cerr << "Warning: Could not export language model: " << e.what()
+              << std::endl;
+  }
+}
+
 /***********************************************************
  * Functions for language  model modifications:
  * - SwitchLanguageModelOrders
@@ -334,10 +635,11 @@ ParseInitializationSentencesAndInitializeLanguageModel()
 
   // parse words in initialization sentences and add to new dictionary
   // and language model. Also update initialization sentences with new word ids
-  NumInitializationSentences = InputFileData.GetInitFsts().size();
+  NumInitializationSentences = InputFileData.GetNumInitFsts();
   InitializationSentences.resize(NumInitializationSentences);
-  std::size_t IdxInitFst = 0;
-  for (const LogVectorFst &InitializationFst : InputFileData.GetInitFsts()) {
+  for (std::size_t IdxInitFst = 0; IdxInitFst < NumInitializationSentences;
+       ++IdxInitFst) {
+    const LogExpandedFst &InitializationFst = InputFileData.GetInitFst(IdxInitFst);
     std::cout << "\r  Sentence: " << IdxInitFst + 1
               << " of " << NumInitializationSentences;
 
@@ -355,7 +657,6 @@ ParseInitializationSentencesAndInitializeLanguageModel()
                         WHPYLMContextLength, SentEndWordId);
 
     LanguageModel->AddWordSequenceToLm(InitializationSentence);
-    IdxInitFst++;
   }
   std::cout << std::endl << std::endl;
 
@@ -368,7 +669,8 @@ ParseInitializationSentencesAndInitializeLanguageModel()
   LanguageModel->ResampleHyperParameters();
 
   // get perplexity
-  DebugLib::PrintSentencesPerplexity(InitializationSentences, *LanguageModel);
+  DebugLib::PrintSentencesPerplexity(InitializationSentences, *LanguageModel,
+                                     Params.NoThreads);
 
   // output some language model stats
   DebugLib::PrintLanguageModelStats(*LanguageModel);
@@ -412,7 +714,8 @@ void LatticeWordSegmentation::TrainLanguageModel(
     LanguageModel->ResampleHyperParameters();
 
     // get perplexity
-    DebugLib::PrintSentencesPerplexity(Sentences, *LanguageModel);
+    DebugLib::PrintSentencesPerplexity(Sentences, *LanguageModel,
+                                     Params.NoThreads);
 
     // output some language model stats
     DebugLib::PrintLanguageModelStats(*LanguageModel);
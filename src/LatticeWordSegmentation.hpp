@@ -66,11 +66,17 @@
 #include "NHPYLM/NHPYLM.hpp"
 #include "LatticeWordSegmentationTimer.hpp"
 #include "LexFst.hpp"
+#include "InputLexiconCache.hpp"
+#include "CheckpointWriter.hpp"
+#include "StringSampleLib.hpp"
 
 /* main class for the word segmentation */
 class LatticeWordSegmentation {
 
   static std::default_random_engine RandomGenerator; // Uniform random generator
+  static const std::size_t LATTICE_READ_AHEAD_BATCHES = 4; // number of batches of input lattices loaded ahead in out-of-core mode
+  static const uint64_t CHECKPOINT_MAGIC = 0x54504b434353574cULL; // identification of checkpoint files ("LWSCCKPT")
+  static const uint32_t CHECKPOINT_VERSION = 1;                   // version of the checkpoint file format
 
   /* parameter and input data structures */
   const ParameterStruct& Params; // struct with parameters
@@ -80,6 +86,8 @@ class LatticeWordSegmentation {
   const std::size_t MaxNumThreads;    // Maximum number of thread to be used
   std::vector<std::thread> Threads;   // the thread objects
   LatticeWordSegmentationTimer Timer; // object to do some timing
+  std::vector<std::vector<std::size_t> > NumInputLexiconTransitions; // number of allowed and cut transitions of input lexicon composition (per thread)
+  InputLexiconCache *InputLexiconFstCache;                       // cache for compositions of input and lexicon (NULL if disabled)
 
   /* language model and dictionary */
   NHPYLM *LanguageModel;           // the language model
@@ -91,6 +99,8 @@ class LatticeWordSegmentation {
   std::vector<LogVectorFst > SampledFsts;                   // the sampled fsts
   std::vector<std::vector<int> > SampledSentences;          // the segmented sentences (parsed samples)
   std::vector<std::vector<ArcInfo> > TimedSampledSentences; // the segmented sentences (parsed samples with start/end times on word basis)
+  std::vector<std::vector<int> > InputCharacterSequences;   // character sequences of the text input (only for -StringSegmentation)
+  std::vector<StringSampleLib::SamplingBuffers> StringSamplingBuffers; // buffers for sampling from the character sequences (per thread)
 
   /* init data */
   std::size_t NumInitializationSentences;                 // number of sentences for initialization
@@ -123,6 +133,27 @@ class LatticeWordSegmentation {
   // switch to a new language  model order
   void SwitchLanguageModelOrders(int NewUnkN, int NewKnownN);
 
+  // serialize the sampler state after iteration IdxIter (language model,
+  // dictionary, sampled sentences and random states) and pass it to
+  // Checkpoints for writing in the background
+  void WriteCheckpoint(
+    std::size_t IdxIter,
+    const std::vector<int> &ShuffledIndices,
+    CheckpointWriter *Checkpoints
+  );
+
+  // restore the sampler state from the checkpoint file. Returns false if
+  // there is no checkpoint file, throws std::runtime_error if it does not
+  // match the input data
+  bool ReadCheckpoint(
+    std::vector<int> *ShuffledIndices,
+    std::size_t *NumCompletedIterations
+  );
+
+  // export the language model to the file given by -ExportLM and write the
+  // arpa file given by -ExportARPA (failures only produce a warning)
+  void ExportLanguageModel() const;
+
 public:
   /* constructor */
   LatticeWordSegmentation(
@@ -65,6 +65,11 @@ void LatticeWordSegmentationTimer::SimpleTimer::AddTimeSinceStartToDuration()
   Duration += std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::high_resolution_clock::now() - Start);
 }
 
+void LatticeWordSegmentationTimer::SimpleTimer::AddDuration(const SimpleTimer &Other)
+{
+  Duration += Other.Duration;
+}
+
 double LatticeWordSegmentationTimer::SimpleTimer::GetDuration() const
 {
   return Duration.count();
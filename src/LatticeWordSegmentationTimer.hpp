@@ -75,6 +75,7 @@ public:
     SimpleTimer();                      // initialize the simple timeing objects (set duration to zero)
     void SetStart();                    // set starting point of timer
     void AddTimeSinceStartToDuration(); // add elapsed time from starting pint to duration
+    void AddDuration(const SimpleTimer &Other); // add duration of another timer
     double GetDuration() const;         // return duration
   };
 
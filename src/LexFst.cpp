@@ -48,378 +48,507 @@ LexFst::LexFst(bool Debug_, const vector< string > &Symbols_, int CharactersBegi
   Symbols(Symbols_),
   CharactersBegin(CharactersBegin_),
   CharactersEnd(Symbols.size()),
-  CharacterSequenceProbabilityScale(CharacterSequenceProbabilityScale_)
+  FSTProperties(fst::kNotAcceptor | fst::kIEpsilons | fst::kOEpsilons | fst::kILabelSorted),
+  FSTType("vector"),
+  HomeState(0),
+  UnkState(fst::kNoStateId),
+  PhiState(fst::kNoStateId),
+  TrieStatesBegin(fst::kNoStateId),
+  CharacterSequenceProbabilityScale(CharacterSequenceProbabilityScale_),
+  Trie(),
+  TrackChanges(false),
+  ChangedPrefixes()
 {
+  ClearTrie();
   initializeArcs();
 }
 
+LexFst::LexFst(const LexFst &other) :
+  fst::Fst<fst::LogArc>(),
+  Debug(other.Debug),
+  Symbols(other.Symbols),
+  CharactersBegin(other.CharactersBegin),
+  CharactersEnd(other.CharactersEnd),
+  FSTProperties(other.FSTProperties),
+  FSTType(other.FSTType),
+  HomeState(other.HomeState),
+  UnkState(other.UnkState),
+  PhiState(other.PhiState),
+  TrieStatesBegin(other.TrieStatesBegin),
+  CharacterSequenceProbabilityScale(other.CharacterSequenceProbabilityScale),
+  Trie(other.Trie),
+  TrackChanges(false),
+  ChangedPrefixes(),
+  Arcs()
+{
+}
+
 void LexFst::initializeArcs()
 {
-  // initialize the states
-  HomeState = AddState();
-  SetStart(HomeState);
-  SetFinal(HomeState, 0);
-  if (CharacterSequenceProbabilityScale.empty()) {
-    UnkState = AddState();
-    AddArc(UnkState, fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, HomeState));   // end of unknown word
-    for (int i = CharactersBegin; i < CharactersEnd; i++) {
-      AddArc(UnkState, fst::LogArc(i, i, 0, UnkState));
-    }
-    AddArc(HomeState, fst::LogArc(PHI_SYMBOLID, EPS_SYMBOLID, 0, UnkState));
+  // the home state is followed by the states for unknown sequences,
+  // either a single loop state or a chain of states (one per length)
+  // to apply the character sequence probability scaling
+  if (CharacterSequenceProbabilityScale.size() < 3) {
+    PhiState = 1;
+    UnkState = 1;
+    TrieStatesBegin = 2;
   } else {
-    AddState();
-    UnkState = AddState();
-    AddArc(UnkState, fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, -log(CharacterSequenceProbabilityScale[2]), HomeState));   // end of unknown word
-    for (int i = CharactersBegin; i < CharactersEnd; i++) {
-      AddArc(UnkState - 1, fst::LogArc(i, i, 0, UnkState));
-    }
-    AddArc(HomeState, fst::LogArc(PHI_SYMBOLID, EPS_SYMBOLID, 0, UnkState - 1));
-    for (unsigned int WordLength = 3; WordLength < CharacterSequenceProbabilityScale.size(); WordLength++) {
-      AddState();
-      AddArc(WordLength, fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, -log(CharacterSequenceProbabilityScale[WordLength]), HomeState));   // end of unknown word
-      for (int i = CharactersBegin; i < CharactersEnd; i++) {
-        AddArc(WordLength - 1, fst::LogArc(i, i, 0, WordLength));
-      }
-    }
+    PhiState = 1;
+    UnkState = 2;
+    TrieStatesBegin = CharacterSequenceProbabilityScale.size();
   }
+  Arcs.clear();
+}
+
+void LexFst::SetCharacterSequenceProbabilityScale(const std::vector<double> &CharacterSequenceProbabilityScale_)
+{
+  CharacterSequenceProbabilityScale = CharacterSequenceProbabilityScale_;
+  initializeArcs();
+}
+
+const std::vector<double> &LexFst::GetCharacterSequenceProbabilityScale() const
+{
+  return CharacterSequenceProbabilityScale;
+}
+
+void LexFst::SetTrackChanges(bool TrackChanges_)
+{
+  TrackChanges = TrackChanges_;
+  ChangedPrefixes.clear();
+}
+
+const std::vector<std::vector<CharId> > &LexFst::GetChangedPrefixes() const
+{
+  return ChangedPrefixes;
+}
+
+void LexFst::ClearChangedPrefixes()
+{
+  ChangedPrefixes.clear();
 }
 
 
 void LexFst::BuildLexiconTansducer(const Word2IdHashmap &Word2Id)
 {
+  ClearTrie();
   for (Word2IdHashmap::const_iterator it = Word2Id.begin(); it != Word2Id.end(); ++it) {
     addWord(it->first.begin(), it->first.size(), it->second);
   }
+  ChangedPrefixes.clear();
 }
 
 
 void LexFst::addWord(std::vector< int >::const_iterator WordBegin, int WordLength, int WordId)
 {
-//     cout << "Lex: adding Word ";
-//     for ( unsigned c=0; c < WordLength; c++ )
-//         cout << *(WordBegin + c) << " ";
-//     cout << endl;
-
   if (WordLength == 0) {
     return;
   }
 
-  // Add the word to the transducer
-  // cout << "Add to transducer" << endl;
-  int curState = Start();
-  if (curState == fst::kNoStateId) {
-    cout << "Error: LexFst has no start state!" << endl;
-    return;
-  }
-
-  bool newEndState = false;
-  bool histFixed = false;
+  // follow the path of the word in the trie and add missing nodes
+  int NodeIdx = 0;
+  int ChangedPrefixLength = WordLength;
   for (std::vector<CharId>::const_iterator c_it = WordBegin; c_it != WordBegin + WordLength; ++c_it) {
-    CharId id = *c_it;
-    if (curState == fst::kNoStateId) {
-      cout << "Error: LexFst has an arc pointing to a null state (id: " << id << ")!" << endl;
-      exit(4);
-    }
-
-    //cout << "Pointer to lex: " << this << endl;
-    fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, curState);
-    for (; !aiter.Done() && (aiter.Value().ilabel != id); aiter.Next()) {
-      ;
-    }
-
-    if (!aiter.Done()) {  //The current state has a transition with the character
-      curState = aiter.Value().nextstate;
-      if (curState == fst::kNoStateId) {
-        cout << "Error: LexFst has an arc pointing to a null state (id: " << id << ")!" << endl;
-        exit(4);
-      }
-    } else { // The current state has no transition with the charcter -> we add it
-      int newState = AddState();
-      //Add arcs and sort them (saves the expensive SortArc)
+    int ChildIdx = FindChild(NodeIdx, *c_it);
+    if (ChildIdx < 0) {
+      ChangedPrefixLength = std::min(ChangedPrefixLength, Trie->Nodes[NodeIdx].Depth + 1);
+      ChildIdx = AddNode(NodeIdx, *c_it);
       if (Debug) {
-        cout << "Adding new State " << newState << " (<-" << curState << " [" << id << "])" << endl;
-      }
-      addArcSorted(curState, fst::LogArc(id, EPS_SYMBOLID, 0, newState));
-      //correct the history of current State by removing the transition to the unkState with the id  if a new state has been added
-      if (!histFixed && curState != Start() && !newEndState) {
-        int lastHistState = getLastHistState(curState);
-        rmArcWithId(lastHistState, id);
-        histFixed = true;
-      }
-      //Set the newState as current state and built a history for the state
-      newEndState = true;
-      curState = newState;
-      bool last = (c_it + 1 == (WordBegin + WordLength)) ? true : false; //The history of the last character of the word must not have the word end tag
-      //Build history
-      int skipId = EPS_SYMBOLID;
-      if (!last) {
-        skipId = *(c_it + 1);
-        if (Debug) {
-          cout << "SkipID: " << skipId << endl;
-        }
-      }
-      vector<CharId>::const_iterator h_c_it = WordBegin;
-      if (h_c_it != c_it) {
-        //History
-        int newHistState = AddState();
-        AddArc(curState, fst::LogArc(EPS_SYMBOLID, *h_c_it, 0, newHistState));
-        ++h_c_it;
-        for (; h_c_it != c_it; ++h_c_it) {
-          int next = AddState();
-          AddArc(newHistState, fst::LogArc(EPS_SYMBOLID, *h_c_it, 0, next));
-          newHistState = next;
-        }
-        //Current Character
-        int next = AddState();
-        AddArc(newHistState, fst::LogArc(EPS_SYMBOLID, id, 0, next));
-        //Transitions to unkState and to the homestate if it is not the last character of a word
-        if (!last) {
-          AddArc(next, fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, HomeState));
-        }
-        for (CharId c = CharactersBegin; c <  CharactersEnd; c++)
-          if (c != skipId) {
-            AddArc(next, fst::LogArc(c, c, 0, UnkState));
-          }
-      } else {
-        //Current Character
-        int next = AddState();
-        AddArc(curState, fst::LogArc(EPS_SYMBOLID, id, 0, next));
-        //Transitions to unkState and to the homestate if it is not the last character of a word
-        if (!last) {
-          AddArc(next, fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, HomeState));
-        }
-        for (CharId c = CharactersBegin; c < CharactersEnd; c++)
-          if (c != skipId) {
-            AddArc(next, fst::LogArc(c, c, 0, UnkState));
-          }
+        cout << "Adding new node " << ChildIdx << " (<-" << NodeIdx << " [" << *c_it << "])" << endl;
       }
     }
+    NodeIdx = ChildIdx;
   }
 
   //Add the wid
   if (Debug) {
-    cout << "Adding wid: " << WordId << " (state: " << curState << "| newEndState: " << newEndState << ")" << endl;
+    cout << "Adding wid: " << WordId << " (node: " << NodeIdx << ")" << endl;
+  }
+  if (Trie->Nodes[NodeIdx].WordId >= 0) {
+    cerr << "Warning: [addWord] node " << NodeIdx << " already has word id " << Trie->Nodes[NodeIdx].WordId << "!" << endl;
   }
-  addArcSorted(curState, fst::LogArc(UNKEND_SYMBOLID, WordId, 0, HomeState));
+  Trie->Nodes[NodeIdx].WordId = WordId;
+  InvalidateNode(NodeIdx);
 
-  if (!newEndState) { //If it is not a new end state we need to delete the word end tag at the end of the history
-//  cout << "No new end state" << endl;
-    int histState = getLastHistState(curState);
-    //Delete the </w> tag
-    rmArcWithId(histState, UNKEND_SYMBOLID);
+  if (TrackChanges) {
+    ChangedPrefixes.push_back(std::vector<CharId>(WordBegin, WordBegin + ChangedPrefixLength));
   }
 }
 
 
-void LexFst::addArcSorted(StateId s, const fst::LogArc &arc)
+void LexFst::rmWord(std::vector< int >::const_iterator WordBegin, int WordLength)
 {
-  //Add arcs and sort them (saves the epxensiv SortArc)
-  std::vector<fst::LogArc> arcs;
-  for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, s); !aiter.Done(); aiter.Next()) {
-    arcs.push_back(aiter.Value());
-    if (aiter.Value().ilabel == arc.ilabel) {
-      cerr << "Warning: [addArcSorted] arc with ilabel " << arc.ilabel << " already exists!" << endl;
+  if (Debug) {
+    cout << "Removing word ";
+    for (vector<CharId>::const_iterator cit = WordBegin; cit != (WordBegin + WordLength); ++cit) {
+      cout << Symbols[*cit] << " ";
     }
+    cout << endl;
   }
-  arcs.push_back(arc);
-  std::sort(arcs.begin(), arcs.end(), LexFst::iLabelSort);
-  DeleteArcs(s);
-  for (unsigned a = 0; a < arcs.size(); a++) {
-    AddArc(s, arcs.at(a));
+
+  // find the node of the word in the trie
+  int NodeIdx = 0;
+  for (vector<CharId>::const_iterator c_it = WordBegin; c_it != (WordBegin + WordLength); ++c_it) {
+    NodeIdx = FindChild(NodeIdx, *c_it);
+    if (NodeIdx < 0) {
+      cerr << "Warning: Should remove word ";
+      for (vector<CharId>::const_iterator cit = WordBegin; cit != (WordBegin + WordLength); ++cit) {
+        cerr << Symbols[*cit] << " ";
+      }
+      cerr << " but could not find it";
+      exit(5);
+    }
   }
-}
 
+  if ((NodeIdx == 0) || (Trie->Nodes[NodeIdx].WordId < 0)) {
+    cerr << "Warning: Should remove a word but there is no arc with the wid leading to the start state!";
+    exit(77);
+  }
 
-inline bool LexFst::iLabelSort(const fst::LogArc &i, const fst::LogArc &j)
-{
-  return i.ilabel < j.ilabel;
+  // remove the wid and cut the tree at the last node with a branch or a word end
+  Trie->Nodes[NodeIdx].WordId = -1;
+  InvalidateNode(NodeIdx);
+  int ChangedPrefixLength = WordLength;
+  while ((NodeIdx != 0) && (Trie->Nodes[NodeIdx].WordId < 0) && Trie->Nodes[NodeIdx].Children.empty()) {
+    int ParentIdx = Trie->Nodes[NodeIdx].Parent;
+    if (Debug) {
+      cout << "Removing node " << NodeIdx << " (<-" << ParentIdx << ")" << endl;
+    }
+    ChangedPrefixLength = Trie->Nodes[NodeIdx].Depth;
+    RemoveNode(NodeIdx);
+    NodeIdx = ParentIdx;
+  }
+
+  if (TrackChanges) {
+    ChangedPrefixes.push_back(std::vector<CharId>(WordBegin, WordBegin + ChangedPrefixLength));
+  }
 }
 
 
-int LexFst::getLastHistState(LexFst::StateId s) const
+void LexFst::Compact()
 {
-  int histState = s;
-  while (true) {
-    fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, histState);
-    for (; !aiter.Done() && (aiter.Value().ilabel != EPS_SYMBOLID) ; aiter.Next()) {
-      ;
+  std::shared_ptr<LexTrie> CompactTrie(new LexTrie());
+  CompactTrie->Nodes.reserve(Trie->Nodes.size() - Trie->FreeNodes.size());
+  CompactTrie->StateToNode.reserve(Trie->StateToNode.size() - Trie->NumFreeStates);
+  CompactTrie->Nodes.push_back(Trie->Nodes[0]);
+  CompactTrie->Nodes[0].Children.clear();
+  CompactTrie->NumFreeStates = 0;
+
+  // depth first traversal, the children of a node are numbered consecutively
+  std::vector<std::pair<int, int> > NodeStack(1, std::make_pair(0, 0)); // pairs of old and new node indices
+  while (!NodeStack.empty()) {
+    int OldNodeIdx = NodeStack.back().first;
+    int NewNodeIdx = NodeStack.back().second;
+    NodeStack.pop_back();
+    const std::vector<std::pair<CharId, int> > &OldChildren = Trie->Nodes[OldNodeIdx].Children;
+    for (const auto &OldChild : OldChildren) {
+      const TrieNode &OldChildNode = Trie->Nodes[OldChild.second];
+      int NewChildIdx = CompactTrie->Nodes.size();
+      StateId FirstState = CompactTrie->StateToNode.size();
+      CompactTrie->Nodes.push_back(TrieNode{NewNodeIdx, OldChildNode.Character, OldChildNode.Depth, OldChildNode.WordId, FirstState, {}});
+      CompactTrie->StateToNode.insert(CompactTrie->StateToNode.end(), OldChildNode.Depth + 1, NewChildIdx);
+      CompactTrie->Nodes[NewNodeIdx].Children.push_back(std::make_pair(OldChild.first, NewChildIdx));
     }
-    if (aiter.Done()) { //there is no <eps> transition so we are at the end of the history
-      break;
+    const std::vector<std::pair<CharId, int> > &NewChildren = CompactTrie->Nodes[NewNodeIdx].Children;
+    for (std::size_t IdxChild = OldChildren.size(); IdxChild > 0; --IdxChild) {
+      NodeStack.push_back(std::make_pair(OldChildren[IdxChild - 1].second, NewChildren[IdxChild - 1].second));
     }
-    histState = aiter.Value().nextstate;
   }
-  if (histState < 2) {
-    cerr << "Warning: [getLastHistState] The last history state for state " << s << " is " << histState << ". Something went wrong!" << endl;
+
+  // copies of the fst still hold the old trie
+  Trie = CompactTrie;
+  Arcs.clear();
+}
+
+std::size_t LexFst::GetNumStates() const
+{
+  return TrieStatesBegin + Trie->StateToNode.size();
+}
+
+std::size_t LexFst::GetNumFreeStates() const
+{
+  return Trie->NumFreeStates;
+}
+
+
+LexFst::StateId LexFst::Start() const
+{
+  return HomeState;
+}
+
+LexFst::Weight LexFst::Final(StateId s) const
+{
+  if (s == HomeState) {
+    return Weight::One();
+  } else {
+    return Weight::Zero();
   }
-  return histState;
 }
 
+size_t LexFst::NumArcs(StateId s) const
+{
+  GetArcs(s);
+  return Arcs.at(s).size();
+}
 
-void LexFst::rmArcWithId(StateId s, CharId id)
+size_t LexFst::NumInputEpsilons(StateId s) const
 {
-  vector<fst::LogArc> arcs;
-  bool deleted = false;
-  for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, s); !aiter.Done(); aiter.Next()) {
-    if (aiter.Value().ilabel != id) {
-      arcs.push_back(aiter.Value());
-    } else {
-      if (deleted) {
-        cerr << "Warning: [rmArcWithId]: The state " << s << " seems to have two transitions with id " << id << endl;
-      }
-      deleted = true;
-    }
+  if (s < TrieStatesBegin) {
+    return 0;
+  }
+  int NodeIdx = Trie->StateToNode.at(s - TrieStatesBegin);
+  if (NodeIdx < 0) {
+    return 0;
   }
 
-  if (!deleted) {
-    cerr << "Warning: [rmArcWithId]: The state " << s << " seems to have no transitions with id " << id << endl;
-    cerr << "Available ids are: ";
-    for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, s); !aiter.Done(); aiter.Next()) {
-      cerr << aiter.Value().olabel << " ";
-    }
-    cerr << endl;
+  // node state and all history states except the last one have an epsilon input arc
+  const TrieNode &Node = Trie->Nodes[NodeIdx];
+  if ((s - TrieStatesBegin - Node.FirstState) < Node.Depth) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+size_t LexFst::NumOutputEpsilons(StateId s) const
+{
+  if (s == HomeState) {
+    return Trie->Nodes[0].Children.size() + 1;
   }
-  DeleteArcs(s);
-  for (unsigned k = 0; k < arcs.size(); k++) {
-    AddArc(s, arcs.at(k));
+  if (s < TrieStatesBegin) {
+    return 0;
   }
+  int NodeIdx = Trie->StateToNode.at(s - TrieStatesBegin);
+  if (NodeIdx < 0) {
+    return 0;
+  }
+
+  // only the node state has arcs with epsilon output (to the child nodes)
+  const TrieNode &Node = Trie->Nodes[NodeIdx];
+  if ((s - TrieStatesBegin) == Node.FirstState) {
+    return Node.Children.size();
+  } else {
+    return 0;
+  }
+}
+
+uint64 LexFst::Properties(uint64 mask, bool) const
+{
+  return mask & FSTProperties;
 }
 
+const string &LexFst::Type() const
+{
+  return FSTType;
+}
 
-void LexFst::rmWord(std::vector< int >::const_iterator WordBegin, int WordLength)
+fst::Fst< fst::LogArc > *LexFst::Copy(bool) const
 {
-  if (Debug) {
-    cout << "Removing word ";
-    for (vector<CharId>::const_iterator cit = WordBegin; cit != (WordBegin + WordLength); ++cit) {
-      cout << Symbols[*cit] << " ";
+  return new LexFst(*this);
+}
+
+const fst::SymbolTable *LexFst::InputSymbols() const
+{
+  return NULL;
+}
+
+const fst::SymbolTable *LexFst::OutputSymbols() const
+{
+  return NULL;
+}
+
+void LexFst::InitStateIterator(fst::StateIteratorData< fst::LogArc > *data) const
+{
+  data->base = 0;
+  data->nstates = GetNumStates();
+}
+
+void LexFst::InitArcIterator(StateId s, fst::ArcIteratorData< fst::LogArc > *data) const
+{
+  data->base = NULL;
+  data->arcs = GetArcs(s);
+  data->narcs = Arcs.at(s).size();
+  data->ref_count = NULL;
+}
+
+
+const fst::LogArc *LexFst::GetArcs(StateId s) const
+{
+  auto State = Arcs.find(s);
+  if (State == Arcs.end()) {
+    State = Arcs.insert(std::make_pair(s, std::vector<fst::LogArc>())).first;
+    if (s < TrieStatesBegin) {
+      BuildUnkArcs(s, &State->second);
+    } else {
+      BuildTrieArcs(s, &State->second);
     }
-    cout << endl;
   }
+  return State->second.data();
+}
 
-  //Remove from Transducer
-  int curState = Start();
-  // Determine the last state with a branch
-  int lastDecideState = Start();
-  CharId lastDecideId = *WordBegin;
-  if (Debug) {
-    cout << "Num arcs - ";
-  }
-  for (vector<CharId>::const_iterator c_it = WordBegin; c_it != (WordBegin + WordLength); ++c_it) {
-    CharId id = *c_it;
-    if (Debug) {
-      cout << " [" << id << "]: " << NumArcs(curState);
+void LexFst::BuildUnkArcs(StateId s, std::vector<fst::LogArc> *StateArcs) const
+{
+  if (s == HomeState) {
+    // phi arc to the unknown sequences and arcs to the first characters of the words
+    StateArcs->push_back(fst::LogArc(PHI_SYMBOLID, EPS_SYMBOLID, 0, PhiState));
+    for (const auto &Child : Trie->Nodes[0].Children) {
+      StateArcs->push_back(fst::LogArc(Child.first, EPS_SYMBOLID, 0, TrieStatesBegin + Trie->Nodes[Child.second].FirstState));
     }
-    if (NumArcs(curState) > 2) {
-      lastDecideState = curState;
-      lastDecideId = id;
+  } else if (CharacterSequenceProbabilityScale.size() < 3) {
+    // loop over characters
+    StateArcs->push_back(fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, HomeState));   // end of unknown word
+    for (int i = CharactersBegin; i < CharactersEnd; i++) {
+      StateArcs->push_back(fst::LogArc(i, i, 0, UnkState));
     }
-
-    fst::ArcIterator<Fst<fst::LogArc> > aiter(*this, curState);
-    for (; !aiter.Done() && (aiter.Value().ilabel != id) ; aiter.Next()) {
-      ;
+  } else {
+    // chain of states, state s is reached after s characters
+    if (s > PhiState) {
+      StateArcs->push_back(fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, -log(CharacterSequenceProbabilityScale[s]), HomeState));   // end of unknown word
     }
-    if (!aiter.Done()) {
-      curState = aiter.Value().nextstate;
-    } else {
-      cerr << "Warning: Should remove word ";
-      for (vector<CharId>::const_iterator cit = WordBegin; cit != (WordBegin + WordLength); ++cit) {
-        cerr << Symbols[*cit] << " ";
+    if ((s + 1) < TrieStatesBegin) {
+      for (int i = CharactersBegin; i < CharactersEnd; i++) {
+        StateArcs->push_back(fst::LogArc(i, i, 0, s + 1));
       }
-      cerr << " but could not find it";
-      exit(5);
     }
   }
+}
 
-  if (Debug) {
-    cout << " [/]: " << NumArcs(curState);
+void LexFst::BuildTrieArcs(StateId s, std::vector<fst::LogArc> *StateArcs) const
+{
+  int NodeIdx = Trie->StateToNode.at(s - TrieStatesBegin);
+  if (NodeIdx < 0) {
+    return;
   }
+  const TrieNode &Node = Trie->Nodes[NodeIdx];
+  int HistIdx = s - TrieStatesBegin - Node.FirstState;
+
+  if (HistIdx == 0) {
+    // node state: start of history, word end and arcs to the child nodes
+    StateArcs->push_back(fst::LogArc(EPS_SYMBOLID, GetNodeCharacters(NodeIdx).front(), 0, s + 1));
+    if (Node.WordId >= 0) {
+      StateArcs->push_back(fst::LogArc(UNKEND_SYMBOLID, Node.WordId, 0, HomeState));
+    }
+    for (const auto &Child : Node.Children) {
+      StateArcs->push_back(fst::LogArc(Child.first, EPS_SYMBOLID, 0, TrieStatesBegin + Trie->Nodes[Child.second].FirstState));
+    }
+  } else if (HistIdx < Node.Depth) {
+    // history state: output the next character of the history
+    StateArcs->push_back(fst::LogArc(EPS_SYMBOLID, GetNodeCharacters(NodeIdx).at(HistIdx), 0, s + 1));
+  } else {
+    // last history state: transitions to the home state if the node is no
+    // word end and to the unkState for all characters without a child node
+    if (Node.WordId < 0) {
+      StateArcs->push_back(fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, HomeState));
+    }
+    auto Child = Node.Children.begin();
+    for (CharId c = CharactersBegin; c < CharactersEnd; c++) {
+      while ((Child != Node.Children.end()) && (Child->first < c)) {
+        ++Child;
+      }
+      if ((Child == Node.Children.end()) || (Child->first != c)) {
+        StateArcs->push_back(fst::LogArc(c, c, 0, UnkState));
+      }
+    }
+  }
+}
 
-  if (NumArcs(curState) > 2) {
-    lastDecideState = curState;
-    lastDecideId = 0;
+std::vector<CharId> LexFst::GetNodeCharacters(int NodeIdx) const
+{
+  std::vector<CharId> Characters(Trie->Nodes[NodeIdx].Depth);
+  for (; NodeIdx > 0; NodeIdx = Trie->Nodes[NodeIdx].Parent) {
+    Characters[Trie->Nodes[NodeIdx].Depth - 1] = Trie->Nodes[NodeIdx].Character;
   }
+  return Characters;
+}
 
-  if (Debug) {
-    cout << " => lastDecideState: " << lastDecideState << " ID: " << lastDecideId << endl;
-    cout << "Arc labels at current state: ";
-    for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, curState); !aiter.Done(); aiter.Next()) {
-      cout << aiter.Value().ilabel << "/" << aiter.Value().olabel << " ";
-    }
-    cout << endl;
+void LexFst::ClearTrie()
+{
+  Trie.reset(new LexTrie());
+  Trie->Nodes.push_back(TrieNode{-1, EPS_SYMBOLID, 0, -1, fst::kNoStateId, {}});
+  Trie->NumFreeStates = 0;
+  Arcs.clear();
+}
+
+int LexFst::AddNode(int ParentIdx, CharId Character)
+{
+  int Depth = Trie->Nodes[ParentIdx].Depth + 1;
+
+  // get node from free list or append a new one
+  int NodeIdx;
+  if (Trie->FreeNodes.empty()) {
+    NodeIdx = Trie->Nodes.size();
+    Trie->Nodes.push_back(TrieNode());
+  } else {
+    NodeIdx = Trie->FreeNodes.back();
+    Trie->FreeNodes.pop_back();
   }
 
-  //Check if there is the end of a word at the current state
-  bool isEndTag = false;
-  for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, curState); !aiter.Done(); aiter.Next()) {
-    if (aiter.Value().ilabel == UNKEND_SYMBOLID) {
-      isEndTag = true;
+  // get state block of same size from free list or append a new one
+  StateId FirstState;
+  if ((static_cast<int>(Trie->FreeStateBlocks.size()) > Depth) && !Trie->FreeStateBlocks[Depth].empty()) {
+    FirstState = Trie->FreeStateBlocks[Depth].back();
+    Trie->FreeStateBlocks[Depth].pop_back();
+    Trie->NumFreeStates -= Depth + 1;
+    for (StateId s = FirstState; s <= FirstState + Depth; ++s) {
+      Trie->StateToNode[s] = NodeIdx;
+      Arcs.erase(TrieStatesBegin + s);
     }
+  } else {
+    FirstState = Trie->StateToNode.size();
+    Trie->StateToNode.insert(Trie->StateToNode.end(), Depth + 1, NodeIdx);
   }
-  if (!isEndTag) {
-    cerr << "Warning: Should remove a word but there is no arc with the wid leading to the start state!";
-    exit(77);
-  }
+  Trie->Nodes[NodeIdx] = TrieNode{ParentIdx, Character, Depth, -1, FirstState, {}};
 
-  //If we are in the middle of a path, we just remove the wid and add </w>
-  if (lastDecideState == curState) {
-    if (Debug) {
-      cout << "Remove wid" << endl;
-    }
+  std::vector<std::pair<CharId, int> > &Children = Trie->Nodes[ParentIdx].Children;
+  Children.insert(std::lower_bound(Children.begin(), Children.end(), Character, LexFst::ChildCharacterLess),
+                  std::make_pair(Character, NodeIdx));
+  InvalidateNode(ParentIdx);
+  return NodeIdx;
+}
 
-    //Save all arcs without the wid and add them later
-    vector<fst::LogArc> arcs;
-    if (Debug) {
-      cout << "Arcs total: " << NumArcs(curState) << endl;
-    }
+void LexFst::RemoveNode(int NodeIdx)
+{
+  TrieNode &Node = Trie->Nodes[NodeIdx];
+  std::vector<std::pair<CharId, int> > &Children = Trie->Nodes[Node.Parent].Children;
+  Children.erase(std::lower_bound(Children.begin(), Children.end(), Node.Character, LexFst::ChildCharacterLess));
+  InvalidateNode(Node.Parent);
+
+  for (StateId s = Node.FirstState; s <= Node.FirstState + Node.Depth; ++s) {
+    Trie->StateToNode[s] = -1;
+    Arcs.erase(TrieStatesBegin + s);
+  }
+  if (static_cast<int>(Trie->FreeStateBlocks.size()) <= Node.Depth) {
+    Trie->FreeStateBlocks.resize(Node.Depth + 1);
+  }
+  Trie->FreeStateBlocks[Node.Depth].push_back(Node.FirstState);
+  Trie->NumFreeStates += Node.Depth + 1;
+  Trie->FreeNodes.push_back(NodeIdx);
+  Node.Parent = -1;
+  Node.WordId = -1;
+}
 
-    for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, curState); !aiter.Done(); aiter.Next()) {
-      if (aiter.Value().olabel < CharactersEnd) {
-        arcs.push_back(aiter.Value());
-      } else if (Debug) {
-        cout << "Deleting arc with label: " << aiter.Value().olabel << endl;
-      }
-    }
-    if (Debug) {
-      cout << "Keeping " << arcs.size() << " arcs" << endl;
-    }
-    DeleteArcs(curState);
-    for (unsigned k = 0; k < arcs.size(); k++) {
-      AddArc(curState, arcs.at(k));
-    }
+void LexFst::InvalidateNode(int NodeIdx)
+{
+  if (NodeIdx == 0) {
+    Arcs.erase(HomeState);
+  } else {
+    const TrieNode &Node = Trie->Nodes[NodeIdx];
+    Arcs.erase(TrieStatesBegin + Node.FirstState);
+    Arcs.erase(TrieStatesBegin + Node.FirstState + Node.Depth);
+  }
+}
 
-    //find last history state and add the word end tag
-    int histState = getLastHistState(curState);
-    if (Debug) {
-      cout << "CurState: " << curState << " -> histState: " << histState << endl;
-    }
-    addArcSorted(histState, fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, HomeState));
+int LexFst::FindChild(int NodeIdx, CharId Character) const
+{
+  const std::vector<std::pair<CharId, int> > &Children = Trie->Nodes[NodeIdx].Children;
+  auto Child = std::lower_bound(Children.begin(), Children.end(), Character, LexFst::ChildCharacterLess);
+  if ((Child != Children.end()) && (Child->first == Character)) {
+    return Child->second;
   } else {
-    //cout << "Cut tree" << endl;
-    //Cut the tree at lastDecideState
-    vector<fst::LogArc> arcs;
-    //cout << "Arcs total: " << NumArcs ( lastDecideState ) << endl;
-    for (fst::ArcIterator<VectorFst<fst::LogArc> > aiter(*this, lastDecideState); !aiter.Done(); aiter.Next()) {
-      if (aiter.Value().ilabel != lastDecideId) {
-        arcs.push_back(aiter.Value());
-      }
-      // else
-      // cout << "Deleting arc with label: " << aiter.Value().ilabel << endl;
-    }
-    //cout << "Keeping " << arcs.size() << " arcs" << endl;
-    DeleteArcs(lastDecideState);
-    for (unsigned k = 0; k < arcs.size(); k++) {
-      AddArc(lastDecideState, arcs.at(k));
-    }
-    //Add the id at the end of the history (only if the decide state is not the start state which already has a phi transition
-    if (lastDecideState > 1) {
-      int histState = getLastHistState(lastDecideState);
-      addArcSorted(histState, fst::LogArc(lastDecideId, lastDecideId, 0, UnkState));
-    }
+    return -1;
   }
 }
 
-uint64 LexFst::Properties(uint64 mask, bool) const
+inline bool LexFst::ChildCharacterLess(const std::pair<CharId, int> &Child, CharId Character)
 {
-//   std::cout << std::oct << "Mask: " << mask << " Test: " << test << std::endl;
-  return VectorFst::Properties(mask, false);
+  return Child.first < Character;
 }
@@ -60,44 +60,106 @@
 #ifndef _LEXFST_HPP_
 #define _LEXFST_HPP_
 
-#include <fst/vector-fst.h>
+#include <memory>
+#include <unordered_map>
+#include <fst/fst.h>
 #include "definitions.hpp"
 
-/* class for lexicon fst */
-class LexFst : public fst::VectorFst<fst::LogArc> {
+/* class for lexicon fst (arcs are computed on demand from a character trie) */
+class LexFst : public fst::Fst<fst::LogArc> {
   typedef fst::LogArc::StateId StateId; // alias for state id
+  typedef fst::LogArc::Weight Weight;   // weights
+
+  /* node of the character trie, every node owns a block of states starting
+   * with the node state followed by one history state per character */
+  struct TrieNode {
+    int Parent;                                    // index of parent node
+    CharId Character;                              // character on the arc from the parent node
+    int Depth;                                     // number of characters from the home state
+    int WordId;                                    // id of the word ending at this node (-1 if none)
+    StateId FirstState;                            // first state of the state block (relative to TrieStatesBegin)
+    std::vector<std::pair<CharId, int> > Children; // characters and indices of child nodes sorted by character
+  };
+
+  /* character trie, shared by all copies of the lexicon fst */
+  struct LexTrie {
+    std::vector<TrieNode> Nodes;                        // trie nodes, node 0 belongs to the home state
+    std::vector<int> StateToNode;                       // mapping from state (relative to TrieStatesBegin) to trie node (-1 if unused)
+    std::vector<int> FreeNodes;                         // indices of removed nodes, reused when adding nodes
+    std::vector<std::vector<StateId> > FreeStateBlocks; // first states of unused state blocks, indexed by node depth
+    std::size_t NumFreeStates;                          // number of states in unused state blocks
+  };
 
   const bool Debug;                       // debuging option
   const std::vector<std::string> Symbols; // symbols for debug output
   const int CharactersBegin;              // first character id
   const int CharactersEnd;                // number of characters
+  const uint64 FSTProperties;             // properties of fst
+  const std::string FSTType;              // type of fst
   StateId HomeState;                      // home state of fst
   StateId UnkState;                       // state for unknown sequences
+  StateId PhiState;                       // state reached by the phi arc of the home state
+  StateId TrieStatesBegin;                // first state of the character trie (after the states for unknown sequences)
   std::vector<double> CharacterSequenceProbabilityScale; // weights for character sequence probability scaling
+  std::shared_ptr<LexTrie> Trie;          // the character trie holding the words
+  bool TrackChanges;                      // record the changed word prefixes when adding or removing words
+  std::vector<std::vector<CharId> > ChangedPrefixes; // prefixes of words whose paths in the lexicon fst were changed
+
+  mutable std::unordered_map<StateId, std::vector<fst::LogArc> > Arcs; // arcs of already visited states
 
 
   /* internal functions */
-  // function to add an arc in sorted order
-  void addArcSorted(
+  // get arcs of a state (build them if not yet done)
+  const fst::LogArc *GetArcs(
+    StateId s
+  ) const;
+
+  // build arcs of the states for unknown sequences
+  void BuildUnkArcs(
     StateId s,
-    const fst::LogArc &arc
+    std::vector<fst::LogArc> *StateArcs
+  ) const;
+
+  // build arcs of a node state or a history state
+  void BuildTrieArcs(
+    StateId s,
+    std::vector<fst::LogArc> *StateArcs
+  ) const;
+
+  // returns the characters on the path from the home state to a trie node
+  std::vector<CharId> GetNodeCharacters(
+    int NodeIdx
+  ) const;
+
+  // reset the trie to the home node only
+  void ClearTrie();
+
+  // add a child node to the trie and return its index (reuses removed nodes and states)
+  int AddNode(
+    int ParentIdx,
+    CharId Character
   );
 
-  // comparison function for arc sorting
-  static inline bool iLabelSort(
-    const fst::LogArc &i,
-    const fst::LogArc &j
+  // remove a childless node from the trie and put its states to the free list
+  void RemoveNode(
+    int NodeIdx
   );
 
-  // returns last state of history sequence
-  int getLastHistState(
-    StateId s
+  // remove the cached arcs of the node state and the last history state
+  void InvalidateNode(
+    int NodeIdx
+  );
+
+  // find child of trie node with given character (-1 if not found)
+  int FindChild(
+    int NodeIdx,
+    CharId Character
   ) const;
 
-  // finds and removes an arc with given id from given state
-  void rmArcWithId(
-    StateId s,
-    CharId id
+  // comparison function for child search
+  static inline bool ChildCharacterLess(
+    const std::pair<CharId, int> &Child,
+    CharId Character
   );
 
 public:
@@ -109,33 +171,115 @@ public:
     const std::vector<double> &CharacterSequenceProbabilityScale
   );
 
-  
+  // copy constructor (shares the trie but not the visited arcs)
+  LexFst(
+    const LexFst &other
+  );
+
+
   /* interface */
-  // build lexicon transducer from Word2Id map
+  // build lexicon transducer from Word2Id map (replaces all words)
   void BuildLexiconTansducer(
     const Word2IdHashmap &Word2Id
   );
-  
-  // initialize arcs
+
+  // initialize the states for unknown sequences
   void initializeArcs();
-  
+
+  // set new weights for character sequence probability scaling
+  void SetCharacterSequenceProbabilityScale(
+    const std::vector<double> &CharacterSequenceProbabilityScale_
+  );
+
+  // return weights for character sequence probability scaling
+  const std::vector<double> &GetCharacterSequenceProbabilityScale() const;
+
+  // enable or disable recording of changed word prefixes
+  void SetTrackChanges(
+    bool TrackChanges_
+  );
+
+  // return the prefixes of words whose paths were changed by addWord and rmWord
+  // (a composition with an input not containing any of them is unchanged)
+  const std::vector<std::vector<CharId> > &GetChangedPrefixes() const;
+
+  // clear the recorded changed word prefixes
+  void ClearChangedPrefixes();
+
+  // renumber nodes and states contiguously (removes unused states)
+  void Compact();
+
+  // return the number of states (including unused states)
+  std::size_t GetNumStates() const;
+
+  // return the number of unused states
+  std::size_t GetNumFreeStates() const;
+
   // add word to lexicon fst
   void addWord(
     std::vector<int>::const_iterator WordBegin,
     int WordLength,
     int WordId);
-  
+
   // remove word from lexicon fst
   void rmWord(
     std::vector<int>::const_iterator WordBegin,
     int WordLength
   );
-  
+
+  // Initial state
+  StateId Start() const;
+
+  // State's final weight
+  Weight Final(
+    StateId s
+  ) const;
+
+  // State's arc count
+  size_t NumArcs(
+    StateId s
+  ) const;
+
+  // State's input epsilon count
+  size_t NumInputEpsilons(
+    StateId s
+  ) const;
+
+  // State's output epsilon count
+  size_t NumOutputEpsilons(
+    StateId s
+  ) const;
+
   // Property bits
   uint64 Properties(
     uint64 mask,
     bool
   ) const;
+
+  // Fst type name
+  const string &Type() const;
+
+  // Get a copy of this Fst
+  Fst<fst::LogArc> *Copy(
+    bool = false
+  ) const;
+
+  // Return input label symbol table; return NULL if not specified
+  const fst::SymbolTable *InputSymbols() const;
+
+  // Return output label symbol table; return NULL if not specified
+  const fst::SymbolTable *OutputSymbols() const;
+
+  // For generic state iterator construction
+  void InitStateIterator(
+    fst::StateIteratorData<fst::LogArc> *data
+  ) const;
+
+  // For generic arc iterator construction
+  void InitArcIterator(
+    StateId s,
+    fst::ArcIteratorData<fst::LogArc> *data
+  ) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,219 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LexiconLookAheadFilter.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: compose filter cutting dead ends of input and lexicon compositions
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _LEXICONLOOKAHEADFILTER_HPP_
+#define _LEXICONLOOKAHEADFILTER_HPP_
+
+#include <memory>
+#include <vector>
+#include <fst/compose.h>
+
+/* compose filter for the composition of an input fst with the lexicon fst,
+ * which does not create states from which the composition cannot continue.
+ * A transition to the state pair (s1, s2) is only allowed if the input
+ * state s1 is final or has an output epsilon arc, or if a lexicon state
+ * reachable from s2 by input epsilon arcs is final together with s1 or
+ * matches an output label of s1. This cuts the lexicon history paths of
+ * word prefixes which do not fit the input before they are expanded. */
+template<class M>
+class LexiconLookAheadFilter {
+public:
+  typedef fst::SequenceComposeFilter<M> Filter;
+  typedef typename Filter::FST1 FST1;
+  typedef typename Filter::FST2 FST2;
+  typedef typename Filter::Arc Arc;
+  typedef typename Filter::FilterState FilterState;
+  typedef typename Filter::Matcher1 Matcher1;
+  typedef typename Filter::Matcher2 Matcher2;
+  typedef typename Arc::StateId StateId;
+  typedef typename Arc::Label Label;
+  typedef typename Arc::Weight Weight;
+
+private:
+  Filter SequenceFilter;                        // filter deciding about epsilon transitions
+  const FST1 &InputFst;                         // the input fst
+  std::unique_ptr<Matcher2> LookAheadMatcher;   // own copy of the lexicon matcher for the lookahead
+  std::size_t *NumTransitions;                  // counter for allowed transitions (may be NULL)
+  std::size_t *NumCutTransitions;               // counter for cut transitions (may be NULL)
+
+  mutable std::vector<Label> InputLabels;       // output labels of the current input state
+  mutable std::vector<StateId> LexiconStates;   // lexicon states to visit in the lookahead
+
+  // check if the composition can continue from the state pair (s1, s2)
+  bool CanContinue(
+    StateId s1,
+    StateId s2
+  ) const {
+    const FST2 &LexiconFst = LookAheadMatcher->GetFst();
+    bool InputFinal = InputFst.Final(s1) != Weight::Zero();
+    InputLabels.clear();
+    for (fst::ArcIterator<FST1> aiter(InputFst, s1); !aiter.Done(); aiter.Next()) {
+      if (aiter.Value().olabel == 0) {
+        return true;
+      }
+      InputLabels.push_back(aiter.Value().olabel);
+    }
+    if (!InputFinal && InputLabels.empty()) {
+      return false;
+    }
+
+    // follow the input epsilon arcs of the lexicon (arcs are sorted by input label)
+    LexiconStates.assign(1, s2);
+    while (!LexiconStates.empty()) {
+      StateId s = LexiconStates.back();
+      LexiconStates.pop_back();
+      if (InputFinal && (LexiconFst.Final(s) != Weight::Zero())) {
+        return true;
+      }
+      LookAheadMatcher->SetState(s);
+      for (Label InputLabel : InputLabels) {
+        if (LookAheadMatcher->Find(InputLabel)) {
+          return true;
+        }
+      }
+      for (fst::ArcIterator<FST2> aiter(LexiconFst, s); !aiter.Done() && (aiter.Value().ilabel == 0); aiter.Next()) {
+        LexiconStates.push_back(aiter.Value().nextstate);
+      }
+    }
+    return false;
+  }
+
+public:
+  /* constructor */
+  LexiconLookAheadFilter(
+    const FST1 &fst1,
+    const FST2 &fst2,
+    Matcher1 *matcher1 = 0,
+    Matcher2 *matcher2 = 0
+  ) :
+    SequenceFilter(fst1, fst2, matcher1, matcher2),
+    InputFst(SequenceFilter.GetMatcher1()->GetFst()),
+    LookAheadMatcher(SequenceFilter.GetMatcher2()->Copy()),
+    NumTransitions(NULL),
+    NumCutTransitions(NULL) {}
+
+  // copy constructor (used by ComposeFst)
+  LexiconLookAheadFilter(
+    const LexiconLookAheadFilter<M> &filter,
+    bool safe = false
+  ) :
+    SequenceFilter(filter.SequenceFilter, safe),
+    InputFst(SequenceFilter.GetMatcher1()->GetFst()),
+    LookAheadMatcher(filter.LookAheadMatcher->Copy(safe)),
+    NumTransitions(filter.NumTransitions),
+    NumCutTransitions(filter.NumCutTransitions) {}
+
+
+  /* interface */
+  // count allowed and cut transitions in the given counters
+  void SetCounters(
+    std::size_t *NumTransitions_,
+    std::size_t *NumCutTransitions_
+  ) {
+    NumTransitions = NumTransitions_;
+    NumCutTransitions = NumCutTransitions_;
+  }
+
+  FilterState Start() const {
+    return SequenceFilter.Start();
+  }
+
+  void SetState(
+    StateId s1,
+    StateId s2,
+    const FilterState &f
+  ) {
+    SequenceFilter.SetState(s1, s2, f);
+  }
+
+  FilterState FilterArc(
+    Arc *arc1,
+    Arc *arc2
+  ) const {
+    FilterState f = SequenceFilter.FilterArc(arc1, arc2);
+    if (f == FilterState::NoState()) {
+      return f;
+    }
+    if (!CanContinue(arc1->nextstate, arc2->nextstate)) {
+      if (NumCutTransitions != NULL) {
+        ++(*NumCutTransitions);
+      }
+      return FilterState::NoState();
+    }
+    if (NumTransitions != NULL) {
+      ++(*NumTransitions);
+    }
+    return f;
+  }
+
+  void FilterFinal(
+    Weight *w1,
+    Weight *w2
+  ) const {
+    SequenceFilter.FilterFinal(w1, w2);
+  }
+
+  Matcher1 *GetMatcher1() {
+    return SequenceFilter.GetMatcher1();
+  }
+
+  Matcher2 *GetMatcher2() {
+    return SequenceFilter.GetMatcher2();
+  }
+
+  uint64 Properties(
+    uint64 props
+  ) const {
+    return SequenceFilter.Properties(props);
+  }
+};
+
+#endif
@@ -42,6 +42,7 @@
 */
 // ----------------------------------------------------------------------------
 #include "Dictionary.hpp"
+#include "../Utils/BinaryIO.hpp"
 
 /** construct dictionary **/
 Dictionary::Dictionary(unsigned int CHPYLMContextLength_,
@@ -52,19 +53,14 @@ Dictionary::Dictionary(unsigned int CHPYLMContextLength_,
   FreedIds(),
   CHPYLMContextLength(CHPYLMContextLength_),
   Id2Word(),
-  Id2CharacterSequence(),
+  Id2CharacterSequence(Symbols_),
+  WordLengths(Symbols_.size(), 0),
   SortFreedIds(false)
 {
   Word2Id.set_deleted_key(std::vector<int>(1, DELETED));
   Word2Id.set_empty_key(std::vector<int>(1, EMPTY));
   Id2Word.set_deleted_key(DELETED);
   Id2Word.set_empty_key(EMPTY);
-  Id2CharacterSequence.set_deleted_key(DELETED);
-  Id2CharacterSequence.set_empty_key(EMPTY);
-  for (std::size_t SymbolIdx = 0; SymbolIdx < Symbols_.size(); ++SymbolIdx) {
-    const auto& Symbol = Symbols_.at(SymbolIdx);
-    Id2CharacterSequence.insert(std::make_pair(SymbolIdx, Symbol));
-  }
 }
 
 
@@ -95,6 +91,8 @@ WordIdAddedPair Dictionary::AddCharacterIdSequenceToDictionary(
     /* get next availabe word id */
     if (FreedIds.empty()) {
       WordId = MaxId++;
+      Id2CharacterSequence.resize(MaxId);
+      WordLengths.resize(MaxId, 0);
     } else {
       if (SortFreedIds) {
         FreedIds.sort();
@@ -111,6 +109,7 @@ WordIdAddedPair Dictionary::AddCharacterIdSequenceToDictionary(
     Id2Word[WordId].insert(Id2Word[WordId].end(), c, c + length);
     Id2Word[WordId].push_back(EOW);
     AddWordToId2CharacterSequence(c, length, WordId);
+    WordLengths[WordId] = length;
     return std::make_pair(WordId, true);
   } else {
     return std::make_pair(it->second, false);
@@ -125,7 +124,8 @@ void Dictionary::RemoveWordFromDictionary(int OldWordId)
                               Id2Word[OldWordId].end() - 1);
   Word2Id.erase(WordVector);
   Id2Word.erase(OldWordId);
-  Id2CharacterSequence.erase(OldWordId);
+  Id2CharacterSequence[OldWordId].clear();
+  WordLengths[OldWordId] = 0;
   FreedIds.push_back(OldWordId);
   SortFreedIds = true;
 //     std::cout << "Pushing back: " << WordId << std::endl;
@@ -168,33 +168,23 @@ int Dictionary::GetWordLength(int WordId) const
 void Dictionary::AddWordToId2CharacterSequence(const_citerator c,
                                                unsigned int length, int WordId)
 {
-  std::ostringstream oss;
+  std::string &CharacterSequence = Id2CharacterSequence[WordId];
+  CharacterSequence.clear();
   for (unsigned int i = 0; i < length; i++) {
-    oss << Id2CharacterSequence[*(c + i)];
+    CharacterSequence += Id2CharacterSequence[*(c + i)];
   }
-  Id2CharacterSequence.insert(make_pair(WordId, oss.str()));
 }
 
 /** return vector of strings containing characters and words **/
-std::vector<std::string> Dictionary::GetId2CharacterSequenceVector() const
+const std::vector<std::string> &Dictionary::GetId2CharacterSequenceVector() const
 {
-  std::vector<std::string> Id2CharacterSequenceVector(MaxId);
-  for (auto CharSequence = Id2CharacterSequence.begin();
-       CharSequence != Id2CharacterSequence.end(); ++CharSequence)
-  {
-    Id2CharacterSequenceVector[CharSequence->first] = CharSequence->second;
-  }
-  return Id2CharacterSequenceVector;
+  return Id2CharacterSequence;
 }
 
 /** return vector of ints containing word lengths **/
-std::vector<int> Dictionary::GetWordLengthVector() const
+const std::vector<int> &Dictionary::GetWordLengthVector() const
 {
-  std::vector<int> WordLengthVector(MaxId);
-  for (const auto& Word: Id2Word) {
-    WordLengthVector[Word.first] = Word.second.size() - CHPYLMContextLength - 1;
-  }
-  return WordLengthVector;
+  return WordLengths;
 }
 
 
@@ -208,7 +198,7 @@ std::vector<std::vector<std::string>>
               CharacterIdSequence.second.begin() + CHPYLMContextLength;
          CharacterId != CharacterIdSequence.second.end(); ++CharacterId)
     {
-      auto currentCharacter(Id2CharacterSequence.find(*CharacterId)->second);
+      auto currentCharacter(Id2CharacterSequence[*CharacterId]);
       Id2SeparatedCharacterSequenceVector[CharacterIdSequence.first].push_back(
             std::move(currentCharacter)
       );
@@ -228,3 +218,53 @@ int Dictionary::GetWordsBegin() const
 {
   return WordsBegin;
 }
+
+
+/** write words and freed ids **/
+void Dictionary::Write(BinaryWriter *Writer) const
+{
+  Writer->Write<int32_t>(WordsBegin);
+  Writer->Write<int32_t>(MaxId);
+  Writer->WriteVector(std::vector<int>(FreedIds.begin(), FreedIds.end()));
+  Writer->Write<uint8_t>(SortFreedIds);
+  Writer->Write<uint64_t>(Id2Word.size());
+  for (const auto &Word : Id2Word) {
+    Writer->Write<int32_t>(Word.first);
+    Writer->WriteVector(Word.second);
+  }
+}
+
+/** read dictionary written by Write, the other mappings are rebuilt from the words **/
+void Dictionary::Read(BinaryReader *Reader)
+{
+  if (Reader->Read<int32_t>() != WordsBegin) {
+    throw std::runtime_error("Number of symbols of dictionary does not match");
+  }
+  MaxId = Reader->Read<int32_t>();
+  std::vector<int> FreedIdsVector;
+  Reader->ReadVector(&FreedIdsVector);
+  FreedIds.assign(FreedIdsVector.begin(), FreedIdsVector.end());
+  SortFreedIds = Reader->Read<uint8_t>() != 0;
+
+  Word2Id.clear();
+  Id2Word.clear();
+  Id2CharacterSequence.resize(WordsBegin);
+  Id2CharacterSequence.resize(MaxId);
+  WordLengths.assign(MaxId, 0);
+  std::size_t NumWords = Reader->Read<uint64_t>();
+  for (std::size_t IdxWord = 0; IdxWord < NumWords; ++IdxWord) {
+    int WordId = Reader->Read<int32_t>();
+    std::vector<int> &WordVector = Id2Word[WordId];
+    Reader->ReadVector(&WordVector);
+    if ((WordId < WordsBegin) || (WordId >= MaxId) ||
+        (WordVector.size() < CHPYLMContextLength + 1)) {
+      throw std::runtime_error("Invalid dictionary entry");
+    }
+    unsigned int length = WordVector.size() - CHPYLMContextLength - 1;
+    Word2Id[std::vector<int>(WordVector.begin() + CHPYLMContextLength,
+                             WordVector.end() - 1)] = WordId;
+    AddWordToId2CharacterSequence(WordVector.begin() + CHPYLMContextLength,
+                                  length, WordId);
+    WordLengths[WordId] = length;
+  }
+}
@@ -70,7 +70,8 @@ class Dictionary {
   std::list<int> FreedIds;                          // list with freed ids because of removed words
   const unsigned int CHPYLMContextLength;           // Order of character level hierarchical pitman yor model
   Id2WordHashmap Id2Word;                           // index to word mapping
-  Id2CharacterSequenceHashmap Id2CharacterSequence; // index to character sequence mapping
+  std::vector<std::string> Id2CharacterSequence;    // index to character sequence mapping (updated on word adding and removal)
+  std::vector<int> WordLengths;                     // index to word length mapping (updated on word adding and removal)
   bool SortFreedIds;                                // set to true if freedids should be sorted before word adding
 
   /* some internal functions */
@@ -88,12 +89,14 @@ public:
   const Word2IdHashmap &GetWord2Id() const;                                                           // return word to id hashmap
   WordBeginLengthPair GetWordBeginLength(int WordId) const;                                           // return a pair containing Word.begin() iterators and length
   int GetWordLength(int WordId) const;                                                                // return Word length
-  std::vector<std::string> GetId2CharacterSequenceVector() const;                                     // construct and return a Id2CharacterSequence vector
-  std::vector<int> GetWordLengthVector() const;                                                       // return vector with word lengths
+  const std::vector<std::string> &GetId2CharacterSequenceVector() const;                              // return Id2CharacterSequence vector (empty string for unused ids)
+  const std::vector<int> &GetWordLengthVector() const;                                                // return vector with word lengths (zero for unused ids)
   std::vector<std::vector<std::string>> GetId2SeparatedCharacterSequenceVector() const;               // construct and return a Id2SeparatedCharacterSequenceVector vector
   int GetMaxNumWords() const;                                                                         // return maximum number of words
   int GetWordsBegin() const;                                                                          // get first word id
   const std::vector<int> &GetWordVector(int WordId) const;                                            // return stored word vector from lexicon
+  void Write(BinaryWriter *Writer) const;                                                             // write words and freed ids
+  void Read(BinaryReader *Reader);                                                                    // read dictionary written by Write (replaces all words), throws std::runtime_error if the number of symbols does not match
 };
 
 #endif
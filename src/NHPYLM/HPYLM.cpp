@@ -41,8 +41,11 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <algorithm>
 #include <chrono>
+#include <sstream>
 #include "HPYLM.hpp"
+#include "../Utils/BinaryIO.hpp"
 
 std::default_random_engine HPYLM::RandomGenerator(std::chrono::system_clock::now().time_since_epoch().count());
 std::gamma_distribution<double> HPYLM::GammaDistribution;
@@ -470,6 +473,135 @@ void HPYLM::SetDiscount(int Level, double Value)
   Parameters.Discount[Level] = Value;
 }
 
+void HPYLM::Write(BinaryWriter *Writer) const
+{
+  Writer->Write<uint32_t>(Order);
+  Writer->WriteVector(Parameters.Discount);
+  Writer->WriteVector(Parameters.Concentration);
+  Writer->WriteVector(BaseProbabilitiesScale);
+  Writer->Write<int32_t>(NextUnusedContextId);
+  Writer->WriteVector(std::vector<int>(FreedIds.begin(), FreedIds.end()));
+  Writer->Write<uint8_t>(SortFreedIds);
+  WriteRestaurantTreeRecursively(RestaurantTree, Writer);
+}
+
+void HPYLM::WriteRestaurantTreeRecursively(const HPYLM::ContextRestaurant &CurrentRestaurant, BinaryWriter *Writer) const
+{
+  CurrentRestaurant.ThisRestaurant.Write(Writer);
+  Writer->Write<uint64_t>(CurrentRestaurant.NextContext.size());
+  for (const auto &NextContext : CurrentRestaurant.NextContext) {
+    Writer->Write<int32_t>(NextContext.first);
+    Writer->Write<int32_t>(NextContext.second->ContextId);
+    WriteRestaurantTreeRecursively(*NextContext.second, Writer);
+  }
+}
+
+void HPYLM::Read(BinaryReader *Reader)
+{
+  if (Reader->Read<uint32_t>() != Order) {
+    throw std::runtime_error("Order of HPYLM does not match");
+  }
+
+  /* the restaurants refer to the parameters, so they are overwritten in place */
+  std::vector<double> Discount;
+  std::vector<double> Concentration;
+  Reader->ReadVector(&Discount);
+  Reader->ReadVector(&Concentration);
+  if ((Discount.size() != Order) || (Concentration.size() != Order)) {
+    throw std::runtime_error("Invalid HPYLM parameters");
+  }
+  std::copy(Discount.begin(), Discount.end(), Parameters.Discount.begin());
+  std::copy(Concentration.begin(), Concentration.end(), Parameters.Concentration.begin());
+  Reader->ReadVector(&BaseProbabilitiesScale);
+
+  NextUnusedContextId = Reader->Read<int32_t>();
+  std::vector<int> FreedIdsVector;
+  Reader->ReadVector(&FreedIdsVector);
+  FreedIds.assign(FreedIdsVector.begin(), FreedIdsVector.end());
+  SortFreedIds = Reader->Read<uint8_t>() != 0;
+
+  /* replace the restaurant tree */
+  DestructRestaurantTreeRecursively(&RestaurantTree);
+  RestaurantTree.NextContext.clear();
+  ContextIdToContext.clear();
+  ContextIdToContext.insert(std::make_pair(RestaurantTree.ContextId, &RestaurantTree));
+  ReadRestaurantTreeRecursively(1, &RestaurantTree, Reader);
+}
+
+void HPYLM::ReadRestaurantTreeRecursively(unsigned int level, HPYLM::ContextRestaurant *CurrentRestaurant, BinaryReader *Reader)
+{
+  CurrentRestaurant->ThisRestaurant.Read(Reader);
+  std::size_t NumNextContexts = Reader->Read<uint64_t>();
+  if ((NumNextContexts > 0) && (level >= Order)) {
+    throw std::runtime_error("Invalid HPYLM restaurant tree");
+  }
+  for (std::size_t IdxNextContext = 0; IdxNextContext < NumNextContexts; ++IdxNextContext) {
+    int ContextWord = Reader->Read<int32_t>();
+    int ContextId = Reader->Read<int32_t>();
+
+    /* the context sequence is the context word followed by the context sequence of the previous restaurant */
+    std::vector<int> ContextSequence(1, ContextWord);
+    ContextSequence.insert(ContextSequence.end(), CurrentRestaurant->ContextSequence.begin(), CurrentRestaurant->ContextSequence.end());
+
+    ContextRestaurant *NextContext = new ContextRestaurant(Parameters.Discount[level], Parameters.Concentration[level], CurrentRestaurant, ContextId, ContextSequence);
+    ContextIdToContext.insert(std::make_pair(ContextId, NextContext));
+    CurrentRestaurant->NextContext.insert(std::make_pair(ContextWord, NextContext));
+    ReadRestaurantTreeRecursively(level + 1, NextContext, Reader);
+  }
+}
+
+void HPYLM::Export(BinaryWriter *Writer) const
+{
+  Writer->Write<uint32_t>(Order);
+  Writer->Align(8);
+  Writer->WriteVector(Parameters.Discount);
+  Writer->WriteVector(Parameters.Concentration);
+  Writer->WriteVector(BaseProbabilitiesScale);
+
+  /* restaurants in breadth first order, so that the next contexts of each restaurant are contiguous */
+  std::vector<std::pair<int, const ContextRestaurant *> > Restaurants(1, std::make_pair(static_cast<int>(EMPTY), &RestaurantTree));
+  std::vector<ExportedContext> Contexts;
+  std::vector<ExportedWordCounts> WordCounts;
+  for (std::size_t IdxRestaurant = 0; IdxRestaurant < Restaurants.size(); ++IdxRestaurant) {
+    const ContextRestaurant &CurrentRestaurant = *Restaurants[IdxRestaurant].second;
+    std::vector<std::pair<int, const ContextRestaurant *> > NextContexts(CurrentRestaurant.NextContext.begin(), CurrentRestaurant.NextContext.end());
+    std::sort(NextContexts.begin(), NextContexts.end());
+
+    ExportedContext Context;
+    Context.ContextWord = Restaurants[IdxRestaurant].first;
+    Context.FirstNextContext = Restaurants.size();
+    Context.NumNextContexts = NextContexts.size();
+    Context.FirstWord = WordCounts.size();
+    CurrentRestaurant.ThisRestaurant.AppendWordCounts(&WordCounts);
+    Context.NumWords = WordCounts.size() - Context.FirstWord;
+    Context.TotalWordCount = CurrentRestaurant.ThisRestaurant.GetTotalWordCount();
+    Context.TotalTableCount = CurrentRestaurant.ThisRestaurant.GetTotalTableCount();
+    Contexts.push_back(Context);
+    Restaurants.insert(Restaurants.end(), NextContexts.begin(), NextContexts.end());
+  }
+  Writer->WriteVector(Contexts);
+  Writer->Align(8);
+  Writer->WriteVector(WordCounts);
+  Writer->Align(8);
+}
+
+std::string HPYLM::GetRandomState()
+{
+  std::ostringstream State;
+  State << RandomGenerator << ' ' << GammaDistribution << ' '
+        << DiscreteDistribution;
+  return State.str();
+}
+
+void HPYLM::SetRandomState(const std::string &State)
+{
+  std::istringstream StateStream(State);
+  StateStream >> RandomGenerator >> GammaDistribution >> DiscreteDistribution;
+  if (!StateStream) {
+    throw std::runtime_error("Invalid random state for HPYLM");
+  }
+}
+
 HPYLM::ContextRestaurant::ContextRestaurant(const double &Discount_, const double &Concentration_, ContextRestaurant *PreviousContext_, int ContextId_, const std::vector< int > &ContextSequence_) :
   ContextId(ContextId_),
   ContextSequence(ContextSequence_),
@@ -173,6 +173,19 @@ class HPYLM {
   // internal function to get the next availabe context id
   int GetNextAvailableContextId();
 
+  // internal function to recursively write the restaurant tree
+  void WriteRestaurantTreeRecursively(
+    const HPYLM::ContextRestaurant &CurrentRestaurant,
+    BinaryWriter *Writer
+  ) const;
+
+  // internal function to recursively read the restaurant tree
+  void ReadRestaurantTreeRecursively(
+    unsigned int level,
+    HPYLM::ContextRestaurant *CurrentRestaurant,
+    BinaryReader *Reader
+  );
+
   // internal function to recursively remove a word from the resaurant tree,
   // considdering its context
   WordRemoveStatus RemoveWordRecursively(
@@ -348,6 +361,31 @@ public:
     int Level,
     double Value
   );
+
+  // write parameters, context ids and the restaurant tree
+  void Write(
+    BinaryWriter *Writer
+  ) const;
+
+  // read hpylm written by Write (replaces the restaurant tree),
+  // throws std::runtime_error if the order does not match
+  void Read(
+    BinaryReader *Reader
+  );
+
+  // write parameters and the restaurant tree in the read-only format of
+  // MappedNHPYLM (restaurants in breadth first order)
+  void Export(
+    BinaryWriter *Writer
+  ) const;
+
+  // return state of random generator and distributions (shared by all hpylms)
+  static std::string GetRandomState();
+
+  // restore state returned by GetRandomState
+  static void SetRandomState(
+    const std::string &State
+  );
 };
 
 #endif
\ No newline at end of file
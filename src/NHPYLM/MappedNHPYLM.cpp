@@ -0,0 +1,333 @@
+// ----------------------------------------------------------------------------
+/**
+   File: MappedNHPYLM.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "MappedNHPYLM.hpp"
+#include "../Utils/BinaryIO.hpp"
+
+const uint64_t MappedNHPYLM::FILE_MAGIC;
+const uint32_t MappedNHPYLM::FILE_VERSION;
+const int MappedNHPYLM::ARPA_SENTSTART;
+
+MappedNHPYLM::MappedNHPYLM(const std::string &FileName) :
+  File(FileName)
+{
+  BinaryReader Reader(File.GetData(), File.GetSize());
+  if ((Reader.Read<uint64_t>() != FILE_MAGIC) ||
+      (Reader.Read<uint32_t>() != FILE_VERSION)) {
+    throw std::runtime_error(FileName + " is not a language model of this version");
+  }
+  CHPYLMOrder = Reader.Read<uint32_t>();
+  WHPYLMOrder = Reader.Read<uint32_t>();
+  CharactersBegin = Reader.Read<int32_t>();
+  CharactersEnd = Reader.Read<int32_t>();
+  MaxId = Reader.Read<int32_t>();
+  WordBaseProbability = Reader.Read<double>();
+
+  /* dictionary (only the sizes are checked, so loading does not depend on the size of the model) */
+  std::size_t NumSpellingOffsets;
+  std::size_t NumSpellingBytes;
+  SpellingOffsets = Reader.MapVector<uint64_t>(&NumSpellingOffsets);
+  Spellings = Reader.MapVector<char>(&NumSpellingBytes);
+  Reader.Align(8);
+  std::size_t NumCharacterOffsets;
+  std::size_t NumCharacters;
+  CharacterOffsets = Reader.MapVector<uint32_t>(&NumCharacterOffsets);
+  Reader.Align(8);
+  Characters = Reader.MapVector<int32_t>(&NumCharacters);
+  Reader.Align(8);
+  SortedWordIds = Reader.MapVector<int32_t>(&NumWords);
+  Reader.Align(8);
+  std::size_t NumCharacterBaseProbabilities;
+  CharacterBaseProbabilities = Reader.MapVector<double>(&NumCharacterBaseProbabilities);
+  if ((MaxId < CharactersEnd) ||
+      (NumSpellingOffsets != static_cast<std::size_t>(MaxId) + 1) ||
+      (SpellingOffsets[MaxId] != NumSpellingBytes) ||
+      (NumCharacterOffsets != static_cast<std::size_t>(MaxId) + 1) ||
+      (CharacterOffsets[MaxId] != NumCharacters) ||
+      (NumCharacterBaseProbabilities != static_cast<std::size_t>(CharactersEnd))) {
+    throw std::runtime_error("Invalid dictionary in language model " + FileName);
+  }
+
+  /* language models */
+  MapHPYLM(&Reader, &CHPYLM);
+  MapHPYLM(&Reader, &WHPYLM);
+  if ((CHPYLM.Order != CHPYLMOrder) || (WHPYLM.Order != WHPYLMOrder)) {
+    throw std::runtime_error("Invalid orders in language model " + FileName);
+  }
+}
+
+void MappedNHPYLM::MapHPYLM(BinaryReader *Reader, MappedHPYLM *Model)
+{
+  Model->Order = Reader->Read<uint32_t>();
+  Reader->Align(8);
+  std::size_t NumDiscount;
+  std::size_t NumConcentration;
+  Model->Discount = Reader->MapVector<double>(&NumDiscount);
+  Model->Concentration = Reader->MapVector<double>(&NumConcentration);
+  Model->BaseProbabilitiesScale = Reader->MapVector<double>(&Model->NumBaseProbabilitiesScale);
+  Model->Contexts = Reader->MapVector<ExportedContext>(&Model->NumContexts);
+  Reader->Align(8);
+  Model->WordCounts = Reader->MapVector<ExportedWordCounts>(&Model->NumWordCounts);
+  Reader->Align(8);
+  if ((NumDiscount != Model->Order) || (NumConcentration != Model->Order) ||
+      (Model->NumContexts == 0)) {
+    throw std::runtime_error("Invalid HPYLM in language model");
+  }
+}
+
+double MappedNHPYLM::RestaurantWordProbability(const MappedHPYLM &Model, const ExportedContext &Context, unsigned int Level, int Word, double BaseProbability)
+{
+  const double Discount = Model.Discount[Level];
+  const double Concentration = Model.Concentration[Level];
+
+  /* check if word is present in current context, else return scaled base probability (as Restaurant::WordProbability) */
+  const ExportedWordCounts *WordsBegin = Model.WordCounts + Context.FirstWord;
+  const ExportedWordCounts *WordsEnd = WordsBegin + Context.NumWords;
+  const ExportedWordCounts *it = std::lower_bound(WordsBegin, WordsEnd, Word, [](const ExportedWordCounts &Counts, int Word) {
+    return Counts.WordId < Word;
+  });
+  if ((it == WordsEnd) || (it->WordId != Word)) {
+    if (Word != PHI) {
+      return BaseProbability * (Concentration + Discount * Context.TotalTableCount) / (Concentration + Context.TotalWordCount);
+    } else {
+      return (Concentration + Discount * Context.TotalTableCount) / (Concentration + Context.TotalWordCount);
+    }
+  } else {
+    return (it->WordCount - Discount * it->TableCount + BaseProbability * (Concentration + Discount * Context.TotalTableCount)) / (Concentration + Context.TotalWordCount);
+  }
+}
+
+const ExportedContext *MappedNHPYLM::FindNextContext(const MappedHPYLM &Model, const ExportedContext &Context, int ContextWord)
+{
+  const ExportedContext *NextContextsBegin = Model.Contexts + Context.FirstNextContext;
+  const ExportedContext *NextContextsEnd = NextContextsBegin + Context.NumNextContexts;
+  const ExportedContext *it = std::lower_bound(NextContextsBegin, NextContextsEnd, ContextWord, [](const ExportedContext &NextContext, int ContextWord) {
+    return NextContext.ContextWord < ContextWord;
+  });
+  if ((it == NextContextsEnd) || (it->ContextWord != ContextWord)) {
+    return NULL;
+  }
+  return it;
+}
+
+double MappedNHPYLM::HPYLMWordProbability(const MappedHPYLM &Model, const int *ContextEnd, std::size_t ContextLength, int Word, double BaseProbability)
+{
+  /* adjust base probability for word according to the contexts from the root to the longest found context */
+  const ExportedContext *Context = Model.Contexts;
+  double Probability = RestaurantWordProbability(Model, *Context, 0, Word, BaseProbability);
+  for (unsigned int Level = 1; (Level <= ContextLength) && (Level < Model.Order); ++Level) {
+    Context = FindNextContext(Model, *Context, *(ContextEnd - Level));
+    if (Context == NULL) {
+      break;
+    }
+    Probability = RestaurantWordProbability(Model, *Context, Level, Word, Probability);
+  }
+  return Probability;
+}
+
+int MappedNHPYLM::GetCHPYLMOrder() const
+{
+  return CHPYLMOrder;
+}
+
+int MappedNHPYLM::GetWHPYLMOrder() const
+{
+  return WHPYLMOrder;
+}
+
+int MappedNHPYLM::GetMaxNumWords() const
+{
+  return MaxId;
+}
+
+int MappedNHPYLM::GetWordId(const std::string &Spelling) const
+{
+  const int32_t *it = std::lower_bound(SortedWordIds, SortedWordIds + NumWords, Spelling, [this](int32_t WordId, const std::string &Spelling) {
+    return Spelling.compare(0, std::string::npos, Spellings + SpellingOffsets[WordId], SpellingOffsets[WordId + 1] - SpellingOffsets[WordId]) > 0;
+  });
+  if ((it == SortedWordIds + NumWords) || (GetWordSpelling(*it) != Spelling)) {
+    return UNKNOWN;
+  }
+  return *it;
+}
+
+std::string MappedNHPYLM::GetWordSpelling(int WordId) const
+{
+  if ((WordId < 0) || (WordId >= MaxId)) {
+    throw std::out_of_range("Invalid word id");
+  }
+  return std::string(Spellings + SpellingOffsets[WordId], SpellingOffsets[WordId + 1] - SpellingOffsets[WordId]);
+}
+
+std::vector<int> MappedNHPYLM::GetCharacterSequence(int WordId) const
+{
+  if ((WordId < 0) || (WordId >= MaxId)) {
+    throw std::out_of_range("Invalid word id");
+  }
+  return std::vector<int>(Characters + CharacterOffsets[WordId], Characters + CharacterOffsets[WordId + 1]);
+}
+
+double MappedNHPYLM::CharacterSequenceBaseProbability(const std::vector<int> &CharacterSequence) const
+{
+  if ((WordBaseProbability != 0.0) || (CharactersEnd <= CharactersBegin) || (CHPYLMOrder == 0)) {
+    return WordBaseProbability;
+  }
+
+  /* same layout as the word vectors of the dictionary */
+  std::vector<int> WordVector(CHPYLMOrder - 1, EOW);
+  WordVector.insert(WordVector.end(), CharacterSequence.begin(), CharacterSequence.end());
+  WordVector.push_back(EOW);
+
+  /* log likelihood of the character sequence (as HPYLM::WordSequenceLoglikelihood) */
+  double Loglikelihood = 0;
+  for (std::size_t Idx = CHPYLMOrder - 1; Idx < WordVector.size(); ++Idx) {
+    int Character = WordVector[Idx];
+    double BaseProbability = ((Character >= 0) && (Character < CharactersEnd)) ? CharacterBaseProbabilities[Character] : 0.0;
+    Loglikelihood += log(HPYLMWordProbability(CHPYLM, WordVector.data() + Idx, Idx, Character, BaseProbability));
+  }
+  std::size_t Length = WordVector.size() - CHPYLMOrder + 1;
+  if (CHPYLM.NumBaseProbabilitiesScale == 0) {
+    return exp(Loglikelihood);
+  } else if (CHPYLM.NumBaseProbabilitiesScale > Length) {
+    return exp(Loglikelihood + log(CHPYLM.BaseProbabilitiesScale[Length]));
+  } else {
+    return 0.0;
+  }
+}
+
+double MappedNHPYLM::WordProbability(const std::vector<int> &ContextSequence, int WordId) const
+{
+  double BaseProbability = 0.0;
+  if ((WordId >= CharactersEnd) && (WordId < MaxId)) {
+    BaseProbability = CharacterSequenceBaseProbability(GetCharacterSequence(WordId));
+  }
+  return WordProbability(ContextSequence, WordId, BaseProbability);
+}
+
+double MappedNHPYLM::WordProbability(const std::vector<int> &ContextSequence, int WordId, double BaseProbability) const
+{
+  return HPYLMWordProbability(WHPYLM, ContextSequence.data() + ContextSequence.size(), ContextSequence.size(), WordId, BaseProbability);
+}
+
+std::vector<double> MappedNHPYLM::WordVectorProbability(const std::vector<int> &ContextSequence, const std::vector<int> &Words) const
+{
+  std::vector<double> Probabilities;
+  Probabilities.reserve(Words.size());
+  for (int Word : Words) {
+    if (Word != PHI) {
+      Probabilities.push_back(WordProbability(ContextSequence, Word));
+    } else {
+      Probabilities.push_back(WordProbability(ContextSequence, Word, 0.0));
+    }
+  }
+  return Probabilities;
+}
+
+void MappedNHPYLM::CollectARPANGramsRecursively(const ExportedContext &Context, unsigned int Level, const std::vector<int> &ContextSequence, int SentEndWordId, std::vector<std::map<std::vector<int>, double> > *NGrams) const
+{
+  /* n-grams of the words in the restaurant */
+  std::vector<int> NGram(ContextSequence);
+  NGram.push_back(0);
+  for (uint32_t IdxWord = Context.FirstWord; IdxWord < Context.FirstWord + Context.NumWords; ++IdxWord) {
+    NGram.back() = WHPYLM.WordCounts[IdxWord].WordId;
+    NGrams->at(Level).insert(std::make_pair(NGram, -1.0));
+  }
+
+  /* n-grams of the next contexts with the probability of a new table as backoff weight */
+  for (uint32_t IdxNextContext = Context.FirstNextContext; IdxNextContext < Context.FirstNextContext + Context.NumNextContexts; ++IdxNextContext) {
+    const ExportedContext &NextContext = WHPYLM.Contexts[IdxNextContext];
+    std::vector<int> NextContextSequence(1, NextContext.ContextWord == SentEndWordId ? ARPA_SENTSTART : NextContext.ContextWord);
+    NextContextSequence.insert(NextContextSequence.end(), ContextSequence.begin(), ContextSequence.end());
+    (*NGrams)[Level][NextContextSequence] = RestaurantWordProbability(WHPYLM, NextContext, Level + 1, PHI, 0.0);
+    CollectARPANGramsRecursively(NextContext, Level + 1, NextContextSequence, SentEndWordId, NGrams);
+  }
+}
+
+void MappedNHPYLM::WriteARPA(const std::string &FileName) const
+{
+  std::ofstream ARPAFile(FileName);
+  if (!ARPAFile) {
+    throw std::runtime_error("Could not open " + FileName + " for writing");
+  }
+  int SentEndWordId = GetWordId(GetWordSpelling(EOS));
+
+  /* all words of the dictionary are unigrams */
+  std::vector<std::map<std::vector<int>, double> > NGrams(WHPYLMOrder);
+  for (std::size_t IdxWord = 0; IdxWord < NumWords; ++IdxWord) {
+    NGrams[0].insert(std::make_pair(std::vector<int>(1, SortedWordIds[IdxWord]), -1.0));
+  }
+  CollectARPANGramsRecursively(WHPYLM.Contexts[0], 0, std::vector<int>(), SentEndWordId, &NGrams);
+
+  ARPAFile << std::endl << "\\data\\" << std::endl;
+  for (unsigned int Order = 1; Order <= WHPYLMOrder; ++Order) {
+    ARPAFile << "ngram " << Order << "=" << NGrams[Order - 1].size() << std::endl;
+  }
+  ARPAFile << std::setprecision(7);
+  for (unsigned int Order = 1; Order <= WHPYLMOrder; ++Order) {
+    ARPAFile << std::endl << "\\" << Order << "-grams:" << std::endl;
+    for (const auto &NGram : NGrams[Order - 1]) {
+      /* <s> is only a context */
+      double Probability = 0.0;
+      if (NGram.first.back() != ARPA_SENTSTART) {
+        std::vector<int> ContextSequence(NGram.first.begin(), NGram.first.end() - 1);
+        std::replace(ContextSequence.begin(), ContextSequence.end(), ARPA_SENTSTART, SentEndWordId);
+        Probability = WordProbability(ContextSequence, NGram.first.back());
+      }
+      ARPAFile << (Probability > 0 ? log10(Probability) : -99) << "\t";
+      for (std::size_t IdxWord = 0; IdxWord < NGram.first.size(); ++IdxWord) {
+        ARPAFile << (IdxWord > 0 ? " " : "")
+                 << (NGram.first[IdxWord] == ARPA_SENTSTART ? "<s>" : GetWordSpelling(NGram.first[IdxWord]));
+      }
+      if (NGram.second >= 0) {
+        ARPAFile << "\t" << (NGram.second > 0 ? log10(NGram.second) : -99);
+      }
+      ARPAFile << "\n";
+    }
+  }
+  ARPAFile << std::endl << "\\end\\" << std::endl;
+  if (!ARPAFile) {
+    throw std::runtime_error("Could not write " + FileName);
+  }
+}
@@ -0,0 +1,221 @@
+// ----------------------------------------------------------------------------
+/**
+   File: MappedNHPYLM.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: read-only memory mapped nested hierarchical pitman yor language model
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _MAPPEDNHPYLM_HPP_
+#define _MAPPEDNHPYLM_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "definitions.hpp"
+#include "../Utils/MappedFile.hpp"
+
+/*
+ * read-only nested hierarchical pitman yor language model written by
+ * NHPYLM::Export. The file is memory mapped and queried in place, so
+ * loading does not depend on the size of the model. The probabilities are
+ * the same as the ones of the exported NHPYLM, word ids are the ids of its
+ * dictionary
+ */
+class MappedNHPYLM {
+  /* hierarchical pitman yor language model in the mapped file */
+  struct MappedHPYLM {
+    unsigned int Order;                        // order of the language model
+    const double *Discount;                    // discount parameters for the different levels
+    const double *Concentration;               // concentration parameters for the different levels
+    const double *BaseProbabilitiesScale;      // scaling factors for base probabilities by sequence length
+    std::size_t NumBaseProbabilitiesScale;     // number of scaling factors
+    const ExportedContext *Contexts;           // restaurants in breadth first order (root first)
+    std::size_t NumContexts;                   // number of restaurants
+    const ExportedWordCounts *WordCounts;      // words of the restaurants
+    std::size_t NumWordCounts;                 // number of words of all restaurants
+  };
+
+  MappedFile File;                             // the mapped language model file
+  unsigned int CHPYLMOrder;                    // order of character hierarchical pitman yor language model
+  unsigned int WHPYLMOrder;                    // order of word hierarchical pitman yor language model
+  int CharactersBegin;                         // first character id
+  int CharactersEnd;                           // 1 + last character id (first word id)
+  int MaxId;                                   // number of ids in the dictionary
+  double WordBaseProbability;                  // fixed base probability for words (0: use character model)
+  const uint64_t *SpellingOffsets;             // offsets of the written forms of the ids
+  const char *Spellings;                       // concatenated written forms of the ids
+  const uint32_t *CharacterOffsets;            // offsets of the character sequences of the ids
+  const int32_t *Characters;                   // concatenated character sequences of the words
+  const int32_t *SortedWordIds;                // word ids sorted by written form
+  std::size_t NumWords;                        // number of words in the dictionary
+  const double *CharacterBaseProbabilities;    // base probabilities of the characters
+  MappedHPYLM CHPYLM;                          // character hierarchical pitman yor language model
+  MappedHPYLM WHPYLM;                          // word hierarchical pitman yor language model
+
+  /* some internal functions */
+  // map the hierarchical pitman yor language model at the current position
+  static void MapHPYLM(
+    BinaryReader *Reader,
+    MappedHPYLM *Model
+  );
+
+  // calculate the probability of a word in the restaurant of a context
+  // at level Level (0: root) of the restaurant tree
+  static double RestaurantWordProbability(
+    const MappedHPYLM &Model,
+    const ExportedContext &Context,
+    unsigned int Level,
+    int Word,
+    double BaseProbability
+  );
+
+  // calculate the probability of a word after the ContextLength context
+  // words before ContextEnd (the most recent word is ContextEnd[-1])
+  static double HPYLMWordProbability(
+    const MappedHPYLM &Model,
+    const int *ContextEnd,
+    std::size_t ContextLength,
+    int Word,
+    double BaseProbability
+  );
+
+  // find the next context of a restaurant for a given context word
+  // (NULL if not found)
+  static const ExportedContext *FindNextContext(
+    const MappedHPYLM &Model,
+    const ExportedContext &Context,
+    int ContextWord
+  );
+
+  // recursively collect the n-grams of the restaurants at level Level and
+  // below with their backoff weights (-1 if the n-gram is no context).
+  // ContextSequence holds the context words of the restaurant (oldest
+  // first, contexts of the sentence end word as ARPA_SENTSTART)
+  void CollectARPANGramsRecursively(
+    const ExportedContext &Context,
+    unsigned int Level,
+    const std::vector<int> &ContextSequence,
+    int SentEndWordId,
+    std::vector<std::map<std::vector<int>, double> > *NGrams
+  ) const;
+
+public:
+  // identification and version of the file format
+  static const uint64_t FILE_MAGIC = 0x4c5950484e53574cULL; // "LWSNHPYL"
+  static const uint32_t FILE_VERSION = 1;
+  // id of <s> in the n-grams of the arpa file
+  static const int ARPA_SENTSTART = -1;
+
+  /* constructor */
+  // map language model file FileName, throws std::runtime_error on failure
+  MappedNHPYLM(
+    const std::string &FileName
+  );
+
+  /* interface */
+  // get the character hierarchical language model order
+  int GetCHPYLMOrder() const;
+
+  // get the word hierarchical language model order
+  int GetWHPYLMOrder() const;
+
+  // return number of ids in the dictionary (characters and words)
+  int GetMaxNumWords() const;
+
+  // return word id of a written form (UNKNOWN if not in the dictionary)
+  int GetWordId(
+    const std::string &Spelling
+  ) const;
+
+  // return written form of a character or word id
+  std::string GetWordSpelling(
+    int WordId
+  ) const;
+
+  // return the character sequence of a word
+  std::vector<int> GetCharacterSequence(
+    int WordId
+  ) const;
+
+  // calculate base probability (character model) of a character sequence,
+  // which need not be in the dictionary
+  double CharacterSequenceBaseProbability(
+    const std::vector<int> &CharacterSequence
+  ) const;
+
+  // calculate probability of a word in the dictionary after the context
+  // words in ContextSequence (most recent word last). Context words may
+  // be UNKNOWN
+  double WordProbability(
+    const std::vector<int> &ContextSequence,
+    int WordId
+  ) const;
+
+  // calculate probability of a word with given base probability after the
+  // context words in ContextSequence. The word may be UNKNOWN
+  double WordProbability(
+    const std::vector<int> &ContextSequence,
+    int WordId,
+    double BaseProbability
+  ) const;
+
+  // calculate probabilities of all words in given vector in given context
+  std::vector<double> WordVectorProbability(
+    const std::vector<int> &ContextSequence,
+    const std::vector<int> &Words
+  ) const;
+
+  // write the word model in arpa format. Every restaurant becomes an n-gram
+  // context whose backoff weight is the probability of the new table
+  // (exact for the words in the dictionary). Contexts of the sentence end
+  // word are written as <s>
+  void WriteARPA(
+    const std::string &FileName
+  ) const;
+};
+
+#endif
@@ -41,9 +41,13 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <ParallelFor.hpp>
 #include "NHPYLM.hpp"
+#include "MappedNHPYLM.hpp"
+#include "../Utils/BinaryIO.hpp"
 
 NHPYLM::NHPYLM(
   unsigned int CHPYLMOrder_,
@@ -231,6 +235,24 @@ double NHPYLM::WordProbability(const const_witerator &Word) const
   return WHPYLM.WordProbability(Word, BaseProbability);
 }
 
+double NHPYLM::WordProbability(const const_witerator &Word, double BaseProbability) const
+{
+  return WHPYLM.WordProbability(Word, BaseProbability);
+}
+
+double NHPYLM::CharacterSequenceBaseProbability(const const_citerator &c, unsigned int length) const
+{
+  if ((WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)) {
+    /* same layout as the word vectors of the dictionary */
+    std::vector<int> WordVector(CHPYLMOrder - 1, EOW);
+    WordVector.insert(WordVector.end(), c, c + length);
+    WordVector.push_back(EOW);
+    return exp(CHPYLM.WordSequenceLoglikelihood(WordVector, CHPYLMBaseProbabilities));
+  } else {
+    return WordBaseProbability;
+  }
+}
+
 std::vector<double> NHPYLM::WordVectorProbability(const std::vector< int > &ContextSequence, const std::vector< int > &Words) const
 {
   /* get base probability for character sequences represting words and calculate word probabilities */
@@ -282,6 +304,40 @@ double NHPYLM::WordSequenceLoglikelihood(const std::vector< int > &WordSequence)
   return WHPYLM.WordSequenceLoglikelihood(WordSequence, WHPYLMBaseProbabilities);
 }
 
+std::vector<double> NHPYLM::WordSequencesLoglikelihoods(const std::vector<std::vector<int> > &WordSequences, unsigned int NumThreads) const
+{
+  std::lock_guard<std::mutex> lck(mtx);
+
+  /* collect words without base probability and calculate them in parallel */
+  std::vector<int> MissingWords;
+  google::dense_hash_map<int, bool> IsMissingWord;
+  IsMissingWord.set_empty_key(EMPTY);
+  for (const std::vector<int> &WordSequence : WordSequences) {
+    for (const_witerator Word = WordSequence.begin() + WHPYLMOrder - 1; Word != WordSequence.end(); ++Word) {
+      if ((WHPYLMBaseProbabilities.find(*Word) == WHPYLMBaseProbabilities.end()) &&
+          IsMissingWord.insert(std::make_pair(*Word, true)).second) {
+        MissingWords.push_back(*Word);
+      }
+    }
+  }
+  std::vector<double> MissingBaseProbabilities(MissingWords.size(), WordBaseProbability);
+  if ((WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)) {
+    ParallelFor(NumThreads, MissingWords.size(), [&](std::size_t IdxWord) {
+      MissingBaseProbabilities[IdxWord] = exp(CHPYLM.WordSequenceLoglikelihood(GetWordVector(MissingWords[IdxWord]), CHPYLMBaseProbabilities));
+    });
+  }
+  for (std::size_t IdxWord = 0; IdxWord < MissingWords.size(); ++IdxWord) {
+    WHPYLMBaseProbabilities.insert(std::make_pair(MissingWords[IdxWord], MissingBaseProbabilities[IdxWord]));
+  }
+
+  /* calculate word sequence likelihoods (the model is only read) */
+  std::vector<double> Loglikelihoods(WordSequences.size());
+  ParallelFor(NumThreads, WordSequences.size(), [&](std::size_t IdxSequence) {
+    Loglikelihoods[IdxSequence] = WHPYLM.WordSequenceLoglikelihood(WordSequences[IdxSequence], WHPYLMBaseProbabilities);
+  });
+  return Loglikelihoods;
+}
+
 void NHPYLM::ResampleHyperParameters()
 {
   if ((WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)) {
@@ -591,4 +647,96 @@ NHPYLMParameters::NHPYLMParameters(const std::vector< double > &CHPYLMDiscount_,
   WHPYLMDiscount(WHPYLMDiscount_),
   WHPYLMConcentration(WHPYLMConcentration_)
 {
-}
\ No newline at end of file
+}
+
+void NHPYLM::Write(BinaryWriter *Writer) const
+{
+  Dictionary::Write(Writer);
+  CHPYLM.Write(Writer);
+  WHPYLM.Write(Writer);
+  Writer->Write<uint64_t>(CHPYLMBaseProbabilities.size());
+  for (const auto &BaseProbability : CHPYLMBaseProbabilities) {
+    Writer->Write<int32_t>(BaseProbability.first);
+    Writer->Write<double>(BaseProbability.second);
+  }
+}
+
+void NHPYLM::Read(BinaryReader *Reader)
+{
+  std::lock_guard<std::mutex> lck(mtx);
+  Dictionary::Read(Reader);
+  CHPYLM.Read(Reader);
+  WHPYLM.Read(Reader);
+  CHPYLMBaseProbabilities.clear();
+  std::size_t NumBaseProbabilities = Reader->Read<uint64_t>();
+  for (std::size_t Idx = 0; Idx < NumBaseProbabilities; ++Idx) {
+    int CharId = Reader->Read<int32_t>();
+    CHPYLMBaseProbabilities[CharId] = Reader->Read<double>();
+  }
+
+  /* word base probabilities are recalculated on demand */
+  WHPYLMBaseProbabilities.clear();
+}
+
+void NHPYLM::Export(const std::string &FileName) const
+{
+  BinaryWriter Writer(FileName);
+  Writer.Write<uint64_t>(MappedNHPYLM::FILE_MAGIC);
+  Writer.Write<uint32_t>(MappedNHPYLM::FILE_VERSION);
+  Writer.Write<uint32_t>(CHPYLMOrder);
+  Writer.Write<uint32_t>(WHPYLMOrder);
+  Writer.Write<int32_t>(CharactersBegin);
+  Writer.Write<int32_t>(CharactersEnd);
+  Writer.Write<int32_t>(GetMaxNumWords());
+  Writer.Write<double>(WordBaseProbability);
+
+  /* written forms of all ids */
+  const std::vector<std::string> &Id2CharacterSequence = GetId2CharacterSequenceVector();
+  std::vector<uint64_t> SpellingOffsets(1, 0);
+  std::string Spellings;
+  for (int Id = 0; Id < GetMaxNumWords(); ++Id) {
+    Spellings += Id2CharacterSequence[Id];
+    SpellingOffsets.push_back(Spellings.size());
+  }
+  Writer.WriteVector(SpellingOffsets);
+  Writer.WriteVector(std::vector<char>(Spellings.begin(), Spellings.end()));
+  Writer.Align(8);
+
+  /* character sequences of the words and word ids sorted by written form */
+  const Id2WordHashmap &Id2Word = GetId2Word();
+  std::vector<uint32_t> CharacterOffsets(1, 0);
+  std::vector<int32_t> Characters;
+  std::vector<int32_t> SortedWordIds;
+  for (int Id = 0; Id < GetMaxNumWords(); ++Id) {
+    if (Id2Word.find(Id) != Id2Word.end()) {
+      WordBeginLengthPair Word = GetWordBeginLength(Id);
+      Characters.insert(Characters.end(), Word.first, Word.first + Word.second);
+      SortedWordIds.push_back(Id);
+    }
+    CharacterOffsets.push_back(Characters.size());
+  }
+  std::stable_sort(SortedWordIds.begin(), SortedWordIds.end(), [&Id2CharacterSequence](int a, int b) {
+    return Id2CharacterSequence[a] < Id2CharacterSequence[b];
+  });
+  Writer.WriteVector(CharacterOffsets);
+  Writer.Align(8);
+  Writer.WriteVector(Characters);
+  Writer.Align(8);
+  Writer.WriteVector(SortedWordIds);
+  Writer.Align(8);
+
+  /* base probabilities of the characters */
+  std::vector<double> CharacterBaseProbabilities(CharactersEnd, 0.0);
+  for (const auto &BaseProbability : CHPYLMBaseProbabilities) {
+    if ((BaseProbability.first >= 0) && (BaseProbability.first < CharactersEnd)) {
+      CharacterBaseProbabilities[BaseProbability.first] = BaseProbability.second;
+    }
+  }
+  Writer.WriteVector(CharacterBaseProbabilities);
+
+  CHPYLM.Export(&Writer);
+  WHPYLM.Export(&Writer);
+  if (!Writer.Close()) {
+    throw std::runtime_error("Could not write language model to " + FileName);
+  }
+}
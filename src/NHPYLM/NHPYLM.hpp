@@ -139,6 +139,20 @@ public:
     const const_witerator &Word
   ) const;
 
+  // calculate probability of a word with given base probability. The word
+  // and its context words may be UNKNOWN (not in the dictionary)
+  double WordProbability(
+    const const_witerator &Word,
+    double BaseProbability
+  ) const;
+
+  // calculate base probability (character model) of the character sequence
+  // given by iterator and length, which need not be in the dictionary
+  double CharacterSequenceBaseProbability(
+    const const_citerator &c,
+    unsigned int length
+  ) const;
+
   // calculate probabilities of all words in given vector in given context
   std::vector<double> WordVectorProbability(
     const std::vector< int > &ContextSequence,
@@ -149,6 +163,14 @@ public:
   double WordSequenceLoglikelihood(
     const std::vector< int > &WordSequence
   ) const;
+
+  // calculate log likelihoods of word sequences using NumThreads threads.
+  // Missing base probabilities are calculated in parallel first, then the
+  // model is only read while the sequences are evaluated
+  std::vector<double> WordSequencesLoglikelihoods(
+    const std::vector<std::vector<int> > &WordSequences,
+    unsigned int NumThreads
+  ) const;
   
   // Resample hyper parameters of the hierarchical models
   void ResampleHyperParameters();
@@ -217,6 +239,24 @@ public:
     int Level,
     double Value
   );
+
+  // write dictionary, both hierarchical models (with table seating and
+  // hyper parameters) and the character base probabilities
+  void Write(
+    BinaryWriter *Writer
+  ) const;
+
+  // read language model written by Write, throws std::runtime_error if
+  // the orders or the number of symbols do not match
+  void Read(
+    BinaryReader *Reader
+  );
+
+  // write the language model to FileName in the read-only format of
+  // MappedNHPYLM, throws std::runtime_error on failure
+  void Export(
+    const std::string &FileName
+  ) const;
 };
 
 #endif
\ No newline at end of file
@@ -41,8 +41,11 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <algorithm>
 #include <chrono>
+#include <sstream>
 #include "Restaurant.hpp"
+#include "../Utils/BinaryIO.hpp"
 
 std::default_random_engine Restaurant::RandomGenerator(std::chrono::system_clock::now().time_since_epoch().count());
 std::discrete_distribution<unsigned int> Restaurant::TableDistribution;
@@ -267,6 +270,66 @@ int Restaurant::GetTablesPerWord(int WordId) const
   }
 }
 
+void Restaurant::Write(BinaryWriter *Writer) const
+{
+  Writer->Write<uint32_t>(TotalWordCount);
+  Writer->Write<uint32_t>(TotalTableCount);
+  Writer->Write<uint64_t>(Words.size());
+  for (const auto &Word : Words) {
+    Writer->Write<int32_t>(Word.first);
+    Writer->Write<uint32_t>(Word.second.Wordcount);
+    Writer->Write<uint32_t>(Word.second.GroupTableCount);
+    Writer->WriteVector(Word.second.TableWordcount);
+  }
+}
+
+void Restaurant::Read(BinaryReader *Reader)
+{
+  Words.clear();
+  TotalWordCount = Reader->Read<uint32_t>();
+  TotalTableCount = Reader->Read<uint32_t>();
+  std::size_t NumWords = Reader->Read<uint64_t>();
+  for (std::size_t IdxWord = 0; IdxWord < NumWords; ++IdxWord) {
+    WordTableGroup &TableGroup = Words[Reader->Read<int32_t>()];
+    TableGroup.Wordcount = Reader->Read<uint32_t>();
+    TableGroup.GroupTableCount = Reader->Read<uint32_t>();
+    Reader->ReadVector(&TableGroup.TableWordcount);
+  }
+}
+
+void Restaurant::AppendWordCounts(std::vector<ExportedWordCounts> *WordCounts) const
+{
+  std::size_t FirstWord = WordCounts->size();
+  for (const auto &Word : Words) {
+    ExportedWordCounts Counts;
+    Counts.WordId = Word.first;
+    Counts.WordCount = Word.second.Wordcount;
+    Counts.TableCount = Word.second.GroupTableCount;
+    WordCounts->push_back(Counts);
+  }
+  std::sort(WordCounts->begin() + FirstWord, WordCounts->end(), [](const ExportedWordCounts &a, const ExportedWordCounts &b) {
+    return a.WordId < b.WordId;
+  });
+}
+
+std::string Restaurant::GetRandomState()
+{
+  std::ostringstream State;
+  State << RandomGenerator << ' ' << TableDistribution << ' '
+        << BernoulliDistribution << ' ' << GammaDistribution;
+  return State.str();
+}
+
+void Restaurant::SetRandomState(const std::string &State)
+{
+  std::istringstream StateStream(State);
+  StateStream >> RandomGenerator >> TableDistribution
+              >> BernoulliDistribution >> GammaDistribution;
+  if (!StateStream) {
+    throw std::runtime_error("Invalid random state for restaurants");
+  }
+}
+
 Restaurant::WordTableGroup::WordTableGroup() :
   Wordcount(0),
   TableWordcount(),
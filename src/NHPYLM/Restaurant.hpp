@@ -106,6 +106,11 @@ public:
   double GetTotalWordCount() const;                                      // return total number of words in restaurant
   double GetTotalTableCount() const;                                     // return total number of tables in restaurant
   int GetTablesPerWord(int WordId) const;                                // return totoal number of tables per word
+  void Write(BinaryWriter *Writer) const;                                // write word and table counts
+  void Read(BinaryReader *Reader);                                       // read word and table counts written by Write (replaces all words)
+  void AppendWordCounts(std::vector<ExportedWordCounts> *WordCounts) const; // append words sorted by id with their word and table counts
+  static std::string GetRandomState();                                   // return state of random generator and distributions
+  static void SetRandomState(const std::string &State);                  // restore state returned by GetRandomState
 };
 
 #endif
\ No newline at end of file
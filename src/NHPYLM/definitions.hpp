@@ -60,6 +60,7 @@
 #ifndef _DEFINITIONS_HPP_
 #define _DEFINITIONS_HPP_
 
+#include <cstdint>
 #include <sparsehash/dense_hash_map>
 #include <boost/functional/hash.hpp>
 
@@ -76,6 +77,9 @@ enum SpecialSyms{
   EMPTY = -32768
 };
 
+class BinaryWriter; // writer for binary serialization (Utils/BinaryIO.hpp)
+class BinaryReader; // reader for binary serialization (Utils/BinaryIO.hpp)
+
 // What has been removed:
 enum WordRemoveStatus {
   NONEREMOVED,          // Nothing,
@@ -96,7 +100,6 @@ typedef std::pair<const_iiterator, int> WordBeginLengthPair; // pair containing
 typedef std::pair<int, bool> WordIdAddedPair;                // pair containing word id and boolean indicating if word was added to dictionary
 
 typedef google::dense_hash_map<int, std::vector<int> > Id2WordHashmap;                                  // int to vector of ints map
-typedef google::dense_hash_map<int, std::string> Id2CharacterSequenceHashmap;                           // int to vector of strings map
 typedef google::dense_hash_map<std::vector<int>, int, boost::hash< std::vector<int> > > Word2IdHashmap; // vector to int hashmap
 
 struct NHPYLMParameters {
@@ -107,6 +110,25 @@ struct NHPYLMParameters {
     NHPYLMParameters(const std::vector< double > &CHPYLMDiscount_, const std::vector< double > &CHPYLMConcentration_, const std::vector< double > &WHPYLMDiscount_, const std::vector< double > &WHPYLMConcentration_); // initialize parameters
 };
 
+/* word of a restaurant in an exported language model (see MappedNHPYLM) */
+struct ExportedWordCounts {
+    int32_t WordId;      // word id
+    uint32_t WordCount;  // number of times the word exists in the restaurant
+    uint32_t TableCount; // number of tables for the word in the restaurant
+};
+
+/* restaurant of a context in an exported language model (see MappedNHPYLM),
+ * the next contexts and the words are stored contiguously, sorted by id */
+struct ExportedContext {
+    int32_t ContextWord;       // word added to the context of the previous restaurant
+    uint32_t FirstNextContext; // index of the first next context
+    uint32_t NumNextContexts;  // number of next contexts
+    uint32_t FirstWord;        // index of the first word
+    uint32_t NumWords;         // number of words
+    uint32_t TotalWordCount;   // total number of words in restaurant
+    uint32_t TotalTableCount;  // number of tables in restaurant
+};
+
 /* transitions from one to the next context */
 struct ContextToContextTransitions {
     std::vector<int> Words;            // word ids for transitions
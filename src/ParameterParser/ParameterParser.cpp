@@ -209,6 +209,56 @@ ParameterParser::ParameterParser(int argc, const char **argv):
       Parameters.PruningEnd = atof(argv[++argPos]);
     } else if (!strcmp(argv[argPos], "-ReadNodeTimes")) {
       Parameters.ReadNodeTimes = true;
+    } else if (!strcmp(argv[argPos], "-TrimInputLexicon")) {
+      Parameters.TrimInputLexicon = true;
+    } else if (!strcmp(argv[argPos], "-InputLexiconCache")) {
+      Parameters.InputLexiconCacheSize = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-LexFstCompaction")) {
+      Parameters.LexFstCompaction = atof(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-CorpusCache")) {
+      Parameters.CorpusCacheFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-OutOfCore")) {
+      Parameters.LatticeStoreFile = argv[++argPos];
+      Parameters.LatticeCacheSize = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-CompactFsts")) {
+      Parameters.CompactFsts = true;
+    } else if (!strcmp(argv[argPos], "-StringSegmentation")) {
+      Parameters.StringSegmentation = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-PosteriorPruning")) {
+      Parameters.PosteriorPruning = true;
+    } else if (!strcmp(argv[argPos], "-AsyncEvaluation")) {
+      Parameters.AsyncEvaluation = true;
+    } else if (!strcmp(argv[argPos], "-AsyncEvaluationThreads")) {
+      Parameters.AsyncEvaluationThreads = atoi(argv[++argPos]);
+      if (Parameters.AsyncEvaluationThreads == 0) {
+        Parameters.AsyncEvaluationThreads = 1;
+      }
+    } else if (!strcmp(argv[argPos], "-ConsolidateEditOperations")) {
+      Parameters.ConsolidateEditOperations = true;
+    } else if (!strcmp(argv[argPos], "-SegmentationOutput")) {
+      ++argPos;
+      if (!strcmp("text", argv[argPos])) {
+        Parameters.SegmentationOutput = SEGMENTATION_TEXT;
+      } else if (!strcmp("delta", argv[argPos])) {
+        Parameters.SegmentationOutput = SEGMENTATION_DELTA;
+      } else {
+        std::ostringstream err;
+        err << "Bad segmentation output format '" << argv[argPos] << "'";
+        DieOnHelp(err.str());
+      }
+    } else if (!strcmp(argv[argPos], "-DeltaSnapshotInterval")) {
+      Parameters.DeltaSnapshotInterval = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-CompressSegmentations")) {
+      Parameters.CompressSegmentations = true;
+    } else if (!strcmp(argv[argPos], "-Checkpoint")) {
+      Parameters.CheckpointFile = argv[++argPos];
+      Parameters.CheckpointInterval = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Resume")) {
+      Parameters.Resume = true;
+    } else if (!strcmp(argv[argPos], "-ExportLM")) {
+      Parameters.ExportLMFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-ExportARPA")) {
+      Parameters.ExportARPAFile = argv[++argPos];
     } else if (!strcmp(argv[argPos], "-WordData")) {
       Parameters.InitLM = true;
       Parameters.UseDictFile = true;
@@ -231,6 +281,16 @@ ParameterParser::ParameterParser(int argc, const char **argv):
     DieOnHelp(err.str());
   }
 
+  // Word length modulation changes the lexicon fst in every iteration,
+  // which invalidates all cached compositions of input and lexicon
+  if ((Parameters.InputLexiconCacheSize > 0) &&
+      (Parameters.WordLengthModulation > -1)) {
+    std::cout << "Warning: -InputLexiconCache is disabled, because"
+              << " -WordLengthModulation clears it in every iteration!"
+              << std::endl;
+    Parameters.InputLexiconCacheSize = 0;
+  }
+
   // load the input files, either from the list or from the parameters
   if (!Parameters.InputFilesList.empty()) {
     ReadFilesFromFileList(Parameters.InputFilesList);
@@ -256,6 +316,8 @@ void ParameterParser::DieOnHelp(const std::string& err) const
             << "  -InputFilesList:       A list of input files, one file per line.  (-InputFilesList InputFileListName (NULL))" << std::endl
             << "                         For fst input, files must be in OpenFST binary format, Log semiring" << std::endl
             << "                         Text files consist of one sentence per line, each symbol seperated by a whitespace." << std::endl
+            << "                         Files may be gzip, bzip2 or xz compressed, tar archives (.tar, .tar.gz, .tgz," << std::endl
+            << "                         .tar.bz2, .tbz2, .tar.xz, .txz) are read member by member without unpacking." << std::endl
             << "  -InputType:            The type of the input (-InputType [text|fst] (text))" << std::endl
             << "                         text:    Textual input data with characters separated by spaces forming a sentence per line." << std::endl
             << "                         fst:     FST input files in a supported lattice format. See parameter LatticeFileType." << std::endl
@@ -288,6 +350,9 @@ void ParameterParser::DieOnHelp(const std::string& err) const
             << "  -BeamWidth:            Beam width through the composed FST I*L*G. To disable pruning, set it to -1" << std::endl
             << "                         (-BeamWidth BeamWidth (-1))" << std::endl
             << "  -OutputEditOperations: Output edit operations after LPER, PER and WER calculation (false)" << std::endl
+            << "                         WER and PER align the sentences by dynamic programming instead of a shortest path" << std::endl
+            << "                         search. Of several alignments with equal cost a different one may be chosen than by" << std::endl
+            << "                         earlier versions, so the edit operations can differ while the error counts match" << std::endl
             << "                         (-OutputEditOperations (false))" << std::endl
             << "  -EvalInterval:         Evaluation interval (-EvalInterval EvalInterval (1))" << std::endl
             << "  -WordLengthModulation: Set word length modulation. -1: off, 0: automatic, >0 set mean word length" << std::endl
@@ -298,6 +363,49 @@ void ParameterParser::DieOnHelp(const std::string& err) const
             << "                             0: off, >0 number of iteration (Parameter: -DeactivateCharacterModel NumIter)" << std::endl
             << "  -HTKLMScale:           Language model scaling factor when reading HTK lattices (Parameter: -HTKLMScale K (0))" << std::endl
             << "  -ReadNodeTimes;        Read node timing informations from HTK lattice" << std::endl
+            << "  -TrimInputLexicon:     Do not create dead end states in the composition of input and lexicon by a lookahead" << std::endl
+            << "                         on the input before composing with the language model (-TrimInputLexicon (false))" << std::endl
+            << "  -InputLexiconCache:    Memory budget in MB for caching the compositions of input and lexicon" << std::endl
+            << "                         across iterations. 0: off (-InputLexiconCache SizeMB (0))" << std::endl
+            << "  -LexFstCompaction:     Compact lexicon fst before an iteration if the fraction of unused states" << std::endl
+            << "                         exceeds the given value. 0: off (-LexFstCompaction X (0))" << std::endl
+            << "  -CorpusCache:          Binary cache of the preprocessed corpus. Read if it matches the input" << std::endl
+            << "                         parameters and files, written otherwise (-CorpusCache CorpusCacheFile ())" << std::endl
+            << "  -OutOfCore:            Keep the preprocessed input lattices in a memory mapped store file instead of in" << std::endl
+            << "                         memory and cache at most CacheSizeMB of them (-OutOfCore LatticeStoreFile CacheSizeMB ())" << std::endl
+            << "  -CompactFsts:          Convert the input and initialization fsts to immutable ConstFsts with contiguous" << std::endl
+            << "                         storage after preprocessing to save memory (-CompactFsts (false))" << std::endl
+            << "  -StringSegmentation:   Sample the segmentations of text input (-LatticeFileType text) directly from the" << std::endl
+            << "                         language model instead of composing fsts, with words of at most MaxWordLength" << std::endl
+            << "                         characters. 0: off (-StringSegmentation MaxWordLength (0))" << std::endl
+            << "  -PosteriorPruning:     Prune arcs of the input by their negative log posterior instead of" << std::endl
+            << "                         the score of the best path through them (applies to -PruneFactor" << std::endl
+            << "                         and -PruningStep) (-PosteriorPruning (false))" << std::endl
+            << "  -AsyncEvaluation:      Write the sentences and calculate WER and PER of an iteration in a background" << std::endl
+            << "                         thread while the next iteration is sampled. Results are printed in iteration" << std::endl
+            << "                         order when they are available (-AsyncEvaluation (false))" << std::endl
+            << "  -AsyncEvaluationThreads: The number of threads used by -AsyncEvaluation for the WER and PER calculation." << std::endl
+            << "                         They run in addition to the -NoThreads sampling threads (-AsyncEvaluationThreads N (1))" << std::endl
+            << "  -ConsolidateEditOperations: Write the edit operations of all sentences to one file <Prefix>EditOperations" << std::endl
+            << "                         with index <Prefix>EditOperations.idx instead of one file per sentence. Entries" << std::endl
+            << "                         are read with ReadEditOperations (-ConsolidateEditOperations (false))" << std::endl
+            << "  -SegmentationOutput:   Format of the sampled segmentations of the iterations, written in a separate thread" << std::endl
+            << "                         (-SegmentationOutput [text|delta] (text))" << std::endl
+            << "                         text:    Sentences and TimedSentences text files per iteration." << std::endl
+            << "                         delta:   One binary file <OutputDirectoryBasename><OutputFilesBasename>Segmentations.delta" << std::endl
+            << "                                  with a full snapshot every DeltaSnapshotInterval iterations and only the changed" << std::endl
+            << "                                  sentences in between. Text files are regenerated with ConvertSegmentations." << std::endl
+            << "  -DeltaSnapshotInterval: Number of iterations between full snapshots in the delta segmentation output" << std::endl
+            << "                         (-DeltaSnapshotInterval N (10))" << std::endl
+            << "  -CompressSegmentations: Gzip compress the segmentation output files (-CompressSegmentations (false))" << std::endl
+            << "  -Checkpoint:           Write the complete sampler state to CheckpointFile every Interval iterations and" << std::endl
+            << "                         after the last iteration (-Checkpoint CheckpointFile Interval ())" << std::endl
+            << "  -Resume:               Continue after the last iteration stored in the checkpoint file given by -Checkpoint" << std::endl
+            << "                         instead of starting from scratch, if the file exists (-Resume (false))" << std::endl
+            << "  -ExportLM:             Export the final language model to LMFile in a compact read-only format, which is memory" << std::endl
+            << "                         mapped by MappedNHPYLM and the QueryLM tool (-ExportLM LMFile ())" << std::endl
+            << "  -ExportARPA:           Additionally write the word model of the language model exported by -ExportLM to ARPAFile" << std::endl
+            << "                         in arpa format (-ExportARPA ARPAFile ())" << std::endl
             << "  -WordData:             Use init transciptions and a pronounciation dictionary for initialization."
             << "This needs SentenceFile and PronDictFile as additional inputs." << std::endl;
 
@@ -425,6 +533,26 @@ ParameterStruct::ParameterStruct() :
   UseViterby(0),
   DeactivateCharacterModel(0),
   HTKLMScale(0),
-  ReadNodeTimes(false)
+  ReadNodeTimes(false),
+  TrimInputLexicon(false),
+  InputLexiconCacheSize(0),
+  LexFstCompaction(0),
+  CorpusCacheFile(),
+  LatticeStoreFile(),
+  LatticeCacheSize(0),
+  CompactFsts(false),
+  StringSegmentation(0),
+  PosteriorPruning(false),
+  AsyncEvaluation(false),
+  AsyncEvaluationThreads(1),
+  ConsolidateEditOperations(false),
+  SegmentationOutput(SEGMENTATION_TEXT),
+  DeltaSnapshotInterval(10),
+  CompressSegmentations(false),
+  CheckpointFile(),
+  CheckpointInterval(10),
+  Resume(false),
+  ExportLMFile(),
+  ExportARPAFile()
 {
 }
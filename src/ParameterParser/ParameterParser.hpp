@@ -140,6 +140,26 @@ struct ParameterStruct {
   unsigned int DeactivateCharacterModel;        // Set iteration to deactivate character model. 0: off, >0 number of iteration (Patameter: -DeactivateCharacterModel NumIter)
   double HTKLMScale;                    // Language model scaling factor when reading HTK lattices (Parameter: -HTKLMScale K (0))
   bool ReadNodeTimes;                   // Read node timing informations from HTK lattice
+  bool TrimInputLexicon;                // Cut dead end states of composition of input and lexicon by a lookahead before composing with language model (Parameter: -TrimInputLexicon (false))
+  unsigned int InputLexiconCacheSize;   // Memory budget in MB for caching the compositions of input and lexicon across iterations. 0: off (Parameter: -InputLexiconCache SizeMB (0))
+  double LexFstCompaction;              // Compact lexicon fst before an iteration if the fraction of unused states exceeds this value. 0: off (Parameter: -LexFstCompaction X (0))
+  std::string CorpusCacheFile;          // Binary cache of the preprocessed corpus, read if it matches the parameters, written otherwise (Parameter: -CorpusCache CorpusCacheFile ())
+  std::string LatticeStoreFile;         // Out-of-core mode: store file for the preprocessed input lattices (Parameter: -OutOfCore LatticeStoreFile CacheSizeMB ())
+  unsigned int LatticeCacheSize;        // Memory budget in MB for input lattices loaded from the lattice store
+  bool CompactFsts;                     // Convert input and initialization fsts to immutable ConstFsts after preprocessing (Parameter: -CompactFsts (false))
+  unsigned int StringSegmentation;     // Sample segmentations of text input directly from the language model with words of at most MaxWordLength characters. 0: off (Parameter: -StringSegmentation MaxWordLength (0))
+  bool PosteriorPruning;                // Prune input lattices (-PruneFactor) and lattices for lper calculation by arc posteriors instead of best path scores (Parameter: -PosteriorPruning (false))
+  bool AsyncEvaluation;                 // Evaluate iterations on a snapshot in a background thread while sampling continues (Parameter: -AsyncEvaluation (false))
+  unsigned int AsyncEvaluationThreads; // Number of threads for the WER and PER calculation in the background thread, in addition to the NoThreads sampling threads (Parameter: -AsyncEvaluationThreads N (1))
+  bool ConsolidateEditOperations;       // Write the edit operations of all sentences to one indexed file per calculation instead of one file per sentence (Parameter: -ConsolidateEditOperations (false))
+  SegmentationOutputFormats SegmentationOutput; // Format of the sampled segmentations of the iterations (Parameter: -SegmentationOutput [text|delta] (text))
+  unsigned int DeltaSnapshotInterval;  // Number of iterations between full snapshots in the delta segmentation output (Parameter: -DeltaSnapshotInterval N (10))
+  bool CompressSegmentations;          // Gzip compress the segmentation output files (Parameter: -CompressSegmentations (false))
+  std::string CheckpointFile;          // Binary checkpoint of the sampler state, written in the background every CheckpointInterval iterations (Parameter: -Checkpoint CheckpointFile Interval ())
+  unsigned int CheckpointInterval;     // Number of iterations between checkpoints
+  bool Resume;                         // Continue from the checkpoint file if it exists (Parameter: -Resume (false))
+  std::string ExportLMFile;            // Export the final language model in the memory mapped format of MappedNHPYLM (Parameter: -ExportLM LMFile ())
+  std::string ExportARPAFile;          // Additionally write the word model of the exported language model in arpa format (Parameter: -ExportARPA ARPAFile ())
 
   ParameterStruct(); // constructor to set default values
 };
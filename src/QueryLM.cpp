@@ -0,0 +1,104 @@
+// ----------------------------------------------------------------------------
+/**
+   File: QueryLM.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "NHPYLM/MappedNHPYLM.hpp"
+
+/* print the log10 probabilities of the sentences read from stdin (words
+   separated by whitespace) under a language model exported with -ExportLM,
+   or convert the language model to arpa format */
+int main(int argc, const char **argv)
+{
+  if ((argc != 2) && !((argc == 4) && (std::string(argv[1]) == "-arpa"))) {
+    std::cerr << "Usage: " << argv[0] << " LMFile < Sentences" << std::endl
+              << "       " << argv[0] << " -arpa LMFile ARPAFile" << std::endl
+              << "  print the log10 probability of each sentence and the perplexity, words not in" << std::endl
+              << "  the dictionary are skipped, or write the word model in arpa format" << std::endl;
+    return 1;
+  }
+
+  try {
+    if (argc == 4) {
+      MappedNHPYLM(argv[2]).WriteARPA(argv[3]);
+      return 0;
+    }
+
+    MappedNHPYLM LanguageModel(argv[1]);
+    int SentEndWordId = LanguageModel.GetWordId(LanguageModel.GetWordSpelling(EOS));
+    std::size_t NumSentences = 0;
+    std::size_t NumWords = 0;
+    std::size_t NumOOVs = 0;
+    double TotalLog10Probability = 0;
+    std::string Line;
+    while (std::getline(std::cin, Line)) {
+      // sentences start with the context used in training
+      std::vector<int> ContextSequence(LanguageModel.GetWHPYLMOrder() - 1, SentEndWordId);
+      double Log10Probability = 0;
+      std::istringstream Words(Line);
+      std::string Word;
+      while (Words >> Word) {
+        int WordId = LanguageModel.GetWordId(Word);
+        if (WordId == UNKNOWN) {
+          ++NumOOVs;
+        } else {
+          Log10Probability += log10(LanguageModel.WordProbability(ContextSequence, WordId));
+          ++NumWords;
+        }
+        ContextSequence.push_back(WordId);
+      }
+      Log10Probability += log10(LanguageModel.WordProbability(ContextSequence, SentEndWordId));
+      std::cout << Log10Probability << "\t" << Line << std::endl;
+      TotalLog10Probability += Log10Probability;
+      ++NumSentences;
+    }
+    std::cout << NumSentences << " sentences, " << NumWords << " words, " << NumOOVs << " OOVs" << std::endl
+              << "logprob= " << TotalLog10Probability << " ppl= "
+              << pow(10, -TotalLog10Probability / (NumWords + NumSentences)) << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+// ----------------------------------------------------------------------------
+/**
+   File: ReadEditOperations.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <iostream>
+#include <stdexcept>
+#include "EditDistanceCalculator/EditOperationsFile.hpp"
+
+/* print the edit operations of the given sentences (input file names) from
+   a consolidated edit operations file, or list its entries if no sentences
+   are given */
+int main(int argc, const char **argv)
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " EditOperationsFile [FileName ...]" << std::endl
+              << "  print the edit operations of the given input files written with" << std::endl
+              << "  -ConsolidateEditOperations, or list all entries if no input files are given" << std::endl;
+    return 1;
+  }
+
+  try {
+    std::vector<EditOperationsFile::Entry> Index = EditOperationsFile::ReadIndex(argv[1]);
+    if (argc == 2) {
+      for (const EditOperationsFile::Entry &IndexEntry : Index) {
+        std::cout << IndexEntry.Name << "\n";
+      }
+      return 0;
+    }
+
+    int NumNotFound = 0;
+    for (int IdxArg = 2; IdxArg < argc; ++IdxArg) {
+      std::vector<EditOperationsFile::Entry>::const_iterator IndexEntry = Index.begin();
+      while ((IndexEntry != Index.end()) && (IndexEntry->Name != argv[IdxArg])) {
+        ++IndexEntry;
+      }
+      if (IndexEntry == Index.end()) {
+        std::cerr << "No edit operations for " << argv[IdxArg] << " in " << argv[1] << std::endl;
+        ++NumNotFound;
+        continue;
+      }
+      if (argc > 3) {
+        std::cout << "# " << IndexEntry->Name << "\n";
+      }
+      std::cout << EditOperationsFile::ReadEntry(argv[1], *IndexEntry);
+    }
+    return NumNotFound > 0 ? 2 : 0;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
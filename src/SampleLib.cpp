@@ -78,32 +78,62 @@ void SampleLib::ComposeAndSampleFromInputLexiconAndLM(
   int SentEndWordId,
   fst::VectorFst< fst::LogArc > *SampledFst,
   std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
-  int beamWidth, bool UseViterby)
+  int beamWidth, bool UseViterby, bool TrimInputLexicon,
+  std::vector<std::size_t> *NumInputLexiconTransitions,
+  InputLexiconCache *InputLexiconFstCache, int SentenceIdx)
 {
 //   std::cout << "Composing and Sampling: " << std::endl;
 
-  // compose input with lexicon transducer
+  // compose input with lexicon transducer. With -TrimInputLexicon the
+  // lookahead filter does not create states from which the composition
+  // cannot continue, which also removes their words from the active words
+  // of the language model
   (*tInSample)[0].SetStart();
   PM *PM11 = new PM(*InputFst, fst::MATCH_NONE);
   mtx.lock();
   PM *PM21 = new PM(*LexiconTransducer, fst::MATCH_INPUT, PHI_SYMBOLID, false);
+  LookAheadFilter *Filter1 = NULL;
+  if (TrimInputLexicon) {
+    Filter1 = new LookAheadFilter(*InputFst, *LexiconTransducer, PM11, PM21);
+  }
   mtx.unlock();
-  fst::ComposeFstOptions<fst::LogArc, PM> copts1(fst::CacheOptions(), PM11, PM21);
-  fst::ComposeFst<fst::LogArc> Input_Unk_Lex(*InputFst, *LexiconTransducer, copts1);
+  std::unique_ptr<fst::ComposeFst<fst::LogArc> > Input_Unk_Lex;
+  if (TrimInputLexicon) {
+    // the filter owns the matchers
+    Filter1->SetCounters(&(*NumInputLexiconTransitions)[0], &(*NumInputLexiconTransitions)[1]);
+    fst::ComposeFstOptions<fst::LogArc, PM, LookAheadFilter> copts1(fst::CacheOptions(), NULL, NULL, Filter1);
+    Input_Unk_Lex.reset(new fst::ComposeFst<fst::LogArc>(*InputFst, *LexiconTransducer, copts1));
+  } else {
+    fst::ComposeFstOptions<fst::LogArc, PM> copts1(fst::CacheOptions(), PM11, PM21);
+    Input_Unk_Lex.reset(new fst::ComposeFst<fst::LogArc>(*InputFst, *LexiconTransducer, copts1));
+  }
 //   fst::ArcSortFst<fst::LogArc, fst::OLabelCompare<fst::LogArc> > Input_Unk_Lex_OSort(Input_Unk_Lex, fst::OLabelCompare<fst::LogArc>());
   (*tInSample)[0].AddTimeSinceStartToDuration();
 
-  // instantiate language model fst
+  // take the composition from the cache or expand it into the cache, if specified
   (*tInSample)[1].SetStart();
-  NHPYLMFst LanguageModelFST(*LanguageModel, SentEndWordId, GetActiveWordIdsInFst(Input_Unk_Lex, LanguageModel->GetMaxNumWords()));
+  std::shared_ptr<const fst::VectorFst<fst::LogArc> > Input_Unk_Lex_Expanded;
+  if (InputLexiconFstCache != NULL) {
+    Input_Unk_Lex_Expanded = InputLexiconFstCache->Get(SentenceIdx);
+    if (!Input_Unk_Lex_Expanded) {
+      Input_Unk_Lex_Expanded = std::make_shared<const fst::VectorFst<fst::LogArc> >(*Input_Unk_Lex);
+      InputLexiconFstCache->Put(SentenceIdx, Input_Unk_Lex_Expanded);
+    }
+  }
+  const fst::Fst<fst::LogArc> &Input_Lex = Input_Unk_Lex_Expanded ?
+    static_cast<const fst::Fst<fst::LogArc> &>(*Input_Unk_Lex_Expanded) :
+    static_cast<const fst::Fst<fst::LogArc> &>(*Input_Unk_Lex);
+
+  // instantiate language model fst
+  NHPYLMFst LanguageModelFST(*LanguageModel, SentEndWordId, GetActiveWordIdsInFst(Input_Lex, LanguageModel->GetMaxNumWords()));
   (*tInSample)[1].AddTimeSinceStartToDuration();
 
   // compose with language model
   (*tInSample)[2].SetStart();
-  PM *PM12 = new PM(Input_Unk_Lex, fst::MATCH_NONE);
+  PM *PM12 = new PM(Input_Lex, fst::MATCH_NONE);
   PM *PM22 = new PM(LanguageModelFST, fst::MATCH_INPUT, PHI_SYMBOLID, false);
   fst::ComposeFstOptions<fst::LogArc, PM> copts2(fst::CacheOptions(), PM12, PM22);
-  fst::ComposeFst<fst::LogArc> Input_Unk_Lex_LM(Input_Unk_Lex, LanguageModelFST, copts2);
+  fst::ComposeFst<fst::LogArc> Input_Unk_Lex_LM(Input_Lex, LanguageModelFST, copts2);
 //   fst::ComposeFst<fst::LogArc> Input_Unk_Lex_LM(Input_Unk_Lex_OSort, LanguageModelFST, copts2);
   (*tInSample)[2].AddTimeSinceStartToDuration();
 
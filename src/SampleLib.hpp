@@ -85,6 +85,8 @@
 
 #include "NHPYLMFst.hpp"
 #include "LexFst.hpp"
+#include "InputLexiconCache.hpp"
+#include "LexiconLookAheadFilter.hpp"
 #include "LatticeWordSegmentationTimer.hpp"
 
 /* library for generating and parsing samples from input lattice */
@@ -92,6 +94,9 @@ class SampleLib {
   
   static std::mutex mtx;
 
+  // filter cutting dead ends of the composition of input and lexicon
+  typedef LexiconLookAheadFilter<PM> LookAheadFilter;
+
   // find all active words in the word fst
   inline static std::vector< bool > GetActiveWordIdsInFst(
     const fst::Fst< fst::LogArc > &SegmentFST,
@@ -116,7 +121,11 @@ public:
     fst::VectorFst< fst::LogArc > *SampledFst,
     vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
     int beamWidth,
-    bool UseViterby);
+    bool UseViterby,
+    bool TrimInputLexicon,
+    std::vector<std::size_t> *NumInputLexiconTransitions,
+    InputLexiconCache *InputLexiconFstCache,
+    int SentenceIdx);
 };
 
 #endif
@@ -0,0 +1,305 @@
+// ----------------------------------------------------------------------------
+/**
+   File: StringSampleLib.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include "StringSampleLib.hpp"
+
+const std::size_t StringSampleLib::MAX_NUM_STATES;
+
+std::size_t StringSampleLib::GetNumStates(
+  unsigned int WHPYLMOrder,
+  unsigned int MaxWordLength)
+{
+  std::size_t NumStates = 1;
+  for (unsigned int IdxContext = 1; IdxContext < WHPYLMOrder; ++IdxContext) {
+    NumStates *= MaxWordLength + 1;
+    if (NumStates > MAX_NUM_STATES) {
+      return MAX_NUM_STATES + 1;
+    }
+  }
+  return NumStates;
+}
+
+std::size_t StringSampleLib::SampleLogWeights(
+  const std::vector<double> &LogWeights,
+  bool UseViterby)
+{
+  std::size_t IdxMax = std::max_element(LogWeights.begin(), LogWeights.end()) -
+                       LogWeights.begin();
+  if (UseViterby || std::isinf(LogWeights[IdxMax])) {
+    return IdxMax;
+  }
+
+  double WeightTotal = 0;
+  for (double LogWeight : LogWeights) {
+    WeightTotal += exp(LogWeight - LogWeights[IdxMax]);
+  }
+  WeightTotal *= rand() / static_cast<double>(RAND_MAX);
+  for (std::size_t Idx = 0; Idx < LogWeights.size(); ++Idx) {
+    WeightTotal -= exp(LogWeights[Idx] - LogWeights[IdxMax]);
+    if ((WeightTotal <= 0) && !std::isinf(LogWeights[Idx])) {
+      return Idx;
+    }
+  }
+  return IdxMax;
+}
+
+double StringSampleLib::LogAdd(
+  double LogProbability1,
+  double LogProbability2,
+  bool UseViterby)
+{
+  if (LogProbability1 < LogProbability2) {
+    std::swap(LogProbability1, LogProbability2);
+  }
+  if (UseViterby || std::isinf(LogProbability2)) {
+    return LogProbability1;
+  }
+  return LogProbability1 + log1p(exp(LogProbability2 - LogProbability1));
+}
+
+std::vector<int> StringSampleLib::ParseCharacterSequence(
+  const fst::Fst<fst::LogArc> &InputFst)
+{
+  std::vector<int> Characters;
+  int sid = InputFst.Start();
+  while (sid != fst::kNoStateId) {
+    fst::ArcIterator<fst::Fst<fst::LogArc> > ai(InputFst, sid);
+    if (ai.Done()) {
+      break;
+    }
+    const fst::LogArc &arc = ai.Value();
+    if (arc.olabel >= CHARACTERSBEGIN) {
+      Characters.push_back(arc.olabel);
+    }
+    sid = arc.nextstate;
+  }
+  return Characters;
+}
+
+void StringSampleLib::SampleFromCharacterSequence(
+  const std::vector<int> &Characters,
+  const NHPYLM *LanguageModel,
+  int SentEndWordId,
+  unsigned int MaxWordLength,
+  bool UseViterby,
+  SamplingBuffers *Buffers,
+  fst::VectorFst<fst::LogArc> *SampledFst)
+{
+  const double LogZero = -std::numeric_limits<double>::infinity();
+  const std::size_t NumCharacters = Characters.size();
+  const std::size_t ContextLength = LanguageModel->GetWHPYLMOrder() - 1;
+
+  // a state at position t is given by the lengths (k_1, ..., k_m) of the
+  // last m = ContextLength words ending at t (k_1 being the length of the
+  // word ending at t), encoded as k_1 + Radix * k_2 + ... Length 0 denotes
+  // the sentence begin (padded with sentence end words as in the lm)
+  const std::size_t Radix = MaxWordLength + 1;
+  const std::size_t NumStates =
+    GetNumStates(LanguageModel->GetWHPYLMOrder(), MaxWordLength);
+  if (NumStates > MAX_NUM_STATES) {
+    throw std::runtime_error("Too many states for string segmentation, "
+                             "reduce the word lm order or the maximum word "
+                             "length");
+  }
+  const std::size_t HistoryStates = ContextLength > 0 ? NumStates / Radix : 1;
+
+  // word ids and base probabilities of all words ending at position t with
+  // length k (index t * Radix + k)
+  std::vector<int> &WordIds = Buffers->WordIds;
+  std::vector<double> &BaseProbabilities = Buffers->BaseProbabilities;
+  WordIds.assign((NumCharacters + 1) * Radix, UNKNOWN);
+  BaseProbabilities.assign((NumCharacters + 1) * Radix, 0);
+  for (std::size_t t = 1; t <= NumCharacters; ++t) {
+    for (std::size_t k = 1; k <= std::min<std::size_t>(MaxWordLength, t); ++k) {
+      const_citerator WordBegin = Characters.begin() + (t - k);
+      WordIds[t * Radix + k] = LanguageModel->GetWordId(WordBegin, k);
+      BaseProbabilities[t * Radix + k] =
+        LanguageModel->CharacterSequenceBaseProbability(WordBegin, k);
+    }
+  }
+
+  // log probability of the word ending at End with length k given the
+  // context words of State at position t. The probabilities are cached by
+  // the word ids, unknown words additionally by their position since their
+  // probability depends on their characters
+  std::vector<int> WordSequence(ContextLength + 1);
+  std::vector<int> &Key = Buffers->WordSequenceKey;
+  auto &Cache = Buffers->WordLogProbabilities;
+  Cache.clear();
+  auto SetContext = [&](std::size_t t, std::size_t State) {
+    for (std::size_t IdxContext = 0; IdxContext < ContextLength; ++IdxContext) {
+      std::size_t k = State % Radix;
+      WordSequence[ContextLength - 1 - IdxContext] =
+        (k == 0) ? SentEndWordId : WordIds[t * Radix + k];
+      t -= k;
+      State /= Radix;
+    }
+  };
+  auto WordLogProbability = [&](std::size_t t, std::size_t State,
+                                std::size_t End, std::size_t k) {
+    SetContext(t, State);
+    int WordId = WordIds[End * Radix + k];
+    WordSequence[ContextLength] = WordId;
+    Key.assign(WordSequence.begin(), WordSequence.end());
+    Key.push_back(WordId == UNKNOWN ? static_cast<int>(End * Radix + k) : -1);
+    auto Cached = Cache.find(Key);
+    if (Cached != Cache.end()) {
+      return Cached->second;
+    }
+    double LogProbability = log(LanguageModel->WordProbability(
+      WordSequence.begin() + ContextLength, BaseProbabilities[End * Radix + k]));
+    Cache.emplace(Key, LogProbability);
+    return LogProbability;
+  };
+
+  // forward filtering, the log probability of State at position t is
+  // Alpha[t * NumStates + State]
+  std::vector<double> &Alpha = Buffers->Alpha;
+  Alpha.assign((NumCharacters + 1) * NumStates, LogZero);
+  Alpha[0] = 0;
+  for (std::size_t t = 1; t <= NumCharacters; ++t) {
+    for (std::size_t k = 1; k <= std::min<std::size_t>(MaxWordLength, t); ++k) {
+      for (std::size_t PreviousState = 0; PreviousState < NumStates;
+           ++PreviousState) {
+        if (std::isinf(Alpha[(t - k) * NumStates + PreviousState])) {
+          continue;
+        }
+        std::size_t State = k + Radix * (PreviousState % HistoryStates);
+        if (ContextLength == 0) {
+          State = 0;
+        }
+        Alpha[t * NumStates + State] = LogAdd(
+          Alpha[t * NumStates + State],
+          Alpha[(t - k) * NumStates + PreviousState] +
+            WordLogProbability(t - k, PreviousState, t, k),
+          UseViterby);
+      }
+    }
+  }
+
+  // sample the state at the sentence end including the sentence end word
+  std::vector<double> LogWeights(NumStates);
+  for (std::size_t State = 0; State < NumStates; ++State) {
+    LogWeights[State] = Alpha[NumCharacters * NumStates + State];
+    if (!std::isinf(LogWeights[State])) {
+      SetContext(NumCharacters, State);
+      WordSequence[ContextLength] = SentEndWordId;
+      LogWeights[State] += log(LanguageModel->WordProbability(
+        WordSequence.begin() + ContextLength));
+    }
+  }
+  std::size_t State = SampleLogWeights(LogWeights, UseViterby);
+  if (std::isinf(LogWeights[State]) && (NumCharacters > 0)) {
+    throw std::runtime_error("No segmentation found during sampling");
+  }
+
+  // backward sampling of the word lengths
+  std::vector<std::size_t> WordEnds;
+  std::vector<std::size_t> WordLengths;
+  std::size_t t = NumCharacters;
+  while (t > 0) {
+    std::size_t k = (ContextLength == 0) ? 0 : State % Radix;
+    if (ContextLength == 0) {
+      // without context, the state does not hold the word length
+      LogWeights.assign(Radix, LogZero);
+      for (k = 1; k <= std::min<std::size_t>(MaxWordLength, t); ++k) {
+        LogWeights[k] = Alpha[(t - k) * NumStates] + WordLogProbability(t - k, 0, t, k);
+      }
+      k = SampleLogWeights(LogWeights, UseViterby);
+    }
+    WordEnds.push_back(t);
+    WordLengths.push_back(k);
+
+    // the previous state shares the lengths k_2, ..., k_m and has an
+    // additional length for the oldest context word
+    std::size_t PreviousState = 0;
+    if (ContextLength > 0) {
+      std::size_t History = State / Radix;
+      LogWeights.assign(Radix, LogZero);
+      for (std::size_t kOldest = 0; kOldest < Radix; ++kOldest) {
+        std::size_t Candidate = History + HistoryStates * kOldest;
+        if (!std::isinf(Alpha[(t - k) * NumStates + Candidate])) {
+          LogWeights[kOldest] = Alpha[(t - k) * NumStates + Candidate] +
+                                WordLogProbability(t - k, Candidate, t, k);
+        }
+      }
+      PreviousState = History + HistoryStates *
+                      SampleLogWeights(LogWeights, UseViterby);
+    }
+    State = PreviousState;
+    t -= k;
+  }
+
+  // write the sample as linear fst: known words as characters with the
+  // word id on the last arc, unknown words as characters followed by </unk>
+  SampledFst->DeleteStates();
+  StateId CurrentState = SampledFst->AddState();
+  SampledFst->SetStart(CurrentState);
+  for (std::size_t IdxWord = WordEnds.size(); IdxWord-- > 0;) {
+    std::size_t End = WordEnds[IdxWord];
+    std::size_t k = WordLengths[IdxWord];
+    int WordId = WordIds[End * Radix + k];
+    for (std::size_t Idx = End - k; Idx < End; ++Idx) {
+      StateId NextState = SampledFst->AddState();
+      int OutputLabel = Characters[Idx];
+      if (WordId != UNKNOWN) {
+        OutputLabel = (Idx + 1 == End) ? WordId : EPS_SYMBOLID;
+      }
+      SampledFst->AddArc(CurrentState,
+        fst::LogArc(Characters[Idx], OutputLabel, 0, NextState));
+      CurrentState = NextState;
+    }
+    if (WordId == UNKNOWN) {
+      StateId NextState = SampledFst->AddState();
+      SampledFst->AddArc(CurrentState,
+        fst::LogArc(EPS_SYMBOLID, UNKEND_SYMBOLID, 0, NextState));
+      CurrentState = NextState;
+    }
+  }
+  StateId FinalState = SampledFst->AddState();
+  SampledFst->AddArc(CurrentState,
+    fst::LogArc(EPS_SYMBOLID, SentEndWordId, 0, FinalState));
+  SampledFst->SetFinal(FinalState, 0);
+}
@@ -0,0 +1,123 @@
+// ----------------------------------------------------------------------------
+/**
+   File: StringSampleLib.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: sampling of a segmentation of a character string directly from the
+                language model (forward filtering backward sampling)
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _STRINGSAMPLELIB_HPP_
+#define _STRINGSAMPLELIB_HPP_
+
+#include <unordered_map>
+#include <fst/vector-fst.h>
+#include "NHPYLM/NHPYLM.hpp"
+#include "definitions.hpp"
+
+/* library for sampling segmentations of unsegmented text without fsts */
+class StringSampleLib {
+  // draw an index from a vector of log weights
+  // (or the index of the maximum if UseViterby is set)
+  static std::size_t SampleLogWeights(
+    const std::vector<double> &LogWeights,
+    bool UseViterby
+  );
+
+  // add logarithmic probabilities (or take the maximum for viterby)
+  static double LogAdd(
+    double LogProbability1,
+    double LogProbability2,
+    bool UseViterby
+  );
+
+public:
+  /* buffers of a sampling thread, reused for all sentences it samples */
+  struct SamplingBuffers {
+    std::vector<int> WordIds;              // ids of the words ending at each position with each length
+    std::vector<double> BaseProbabilities; // base probabilities of these words
+    std::vector<double> Alpha;             // forward log probabilities of the states at each position
+    std::vector<int> WordSequenceKey;      // key of a word log probability in the cache
+    std::unordered_map<std::vector<int>, double, boost::hash<std::vector<int> > > WordLogProbabilities; // word log probabilities of the current sentence by context word ids and word
+  };
+
+  // maximum number of states (MaxWordLength + 1)^(WHPYLMOrder - 1) per
+  // position, larger state spaces are rejected
+  static const std::size_t MAX_NUM_STATES = 1 << 16;
+
+  // number of states per position for a word language model of order
+  // WHPYLMOrder and words of at most MaxWordLength characters (saturated
+  // at MAX_NUM_STATES + 1)
+  static std::size_t GetNumStates(
+    unsigned int WHPYLMOrder,
+    unsigned int MaxWordLength
+  );
+
+  // get the character sequence of a preprocessed input fst of a
+  // single sentence (characters of any path, all paths of a linear input
+  // have the same characters)
+  static std::vector<int> ParseCharacterSequence(
+    const fst::Fst<fst::LogArc> &InputFst
+  );
+
+  // sample a segmentation of the character sequence from the language
+  // model with words of at most MaxWordLength characters by forward
+  // filtering backward sampling over the positions and the lengths of the
+  // last (WHPYLMOrder - 1) words. The sample is written to SampledFst in the
+  // format of the samples from the input lattices (see ParseLib). Throws
+  // std::runtime_error if there are more than MAX_NUM_STATES states
+  static void SampleFromCharacterSequence(
+    const std::vector<int> &Characters,
+    const NHPYLM *LanguageModel,
+    int SentEndWordId,
+    unsigned int MaxWordLength,
+    bool UseViterby,
+    SamplingBuffers *Buffers,
+    fst::VectorFst<fst::LogArc> *SampledFst
+  );
+};
+
+#endif
@@ -0,0 +1,111 @@
+// ----------------------------------------------------------------------------
+/**
+   File: BinaryIO.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include "BinaryIO.hpp"
+
+BinaryWriter::BinaryWriter(const std::string &FileName) :
+  FileOut(FileName, std::ios::binary),
+  BufferOut(),
+  Out(FileOut)
+{
+  if (!Out) {
+    throw std::runtime_error("Could not open " + FileName + " for writing");
+  }
+}
+
+BinaryWriter::BinaryWriter() :
+  FileOut(),
+  BufferOut(std::ios::binary),
+  Out(BufferOut)
+{
+}
+
+void BinaryWriter::WriteString(const std::string &String)
+{
+  Write<uint64_t>(String.size());
+  Out.write(String.data(), String.size());
+}
+
+void BinaryWriter::WriteStringVector(const std::vector<std::string> &Strings)
+{
+  Write<uint64_t>(Strings.size());
+  for (const auto &String : Strings) {
+    WriteString(String);
+  }
+}
+
+bool BinaryWriter::Close()
+{
+  Out.flush();
+  if (FileOut.is_open()) {
+    FileOut.close();
+  }
+  return !Out.fail();
+}
+
+BinaryReader::BinaryReader(const char *Data, std::size_t Size) :
+  Pos(Data),
+  End(Data + Size)
+{
+}
+
+void BinaryReader::Require(std::size_t Size) const
+{
+  if (static_cast<std::size_t>(End - Pos) < Size) {
+    throw std::runtime_error("Unexpected end of binary data");
+  }
+}
+
+std::string BinaryReader::ReadString()
+{
+  std::size_t Size = Read<uint64_t>();
+  Require(Size);
+  std::string String(Pos, Size);
+  Pos += Size;
+  return String;
+}
+
+void BinaryReader::ReadStringVector(std::vector<std::string> *Strings)
+{
+  Strings->resize(Read<uint64_t>());
+  for (auto &String : *Strings) {
+    String = ReadString();
+  }
+}
@@ -0,0 +1,225 @@
+// ----------------------------------------------------------------------------
+/**
+   File: BinaryIO.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: binary serialization of plain values and strings
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _BINARYIO_HPP_
+#define _BINARYIO_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* writes values in native binary representation to a file or a memory
+   buffer */
+class BinaryWriter {
+  std::ofstream FileOut;               // output file stream
+  std::ostringstream BufferOut;        // output memory buffer
+  std::ostream &Out;                   // output stream (file or memory buffer)
+
+public:
+  /* constructor */
+  // open file FileName for writing, throws std::runtime_error on failure
+  BinaryWriter(
+    const std::string &FileName
+  );
+
+  // write to a memory buffer, which is returned by GetBuffer
+  BinaryWriter();
+
+  /* interface */
+  // write a trivially copyable value
+  template<typename T>
+  void Write(
+    const T &Value
+  ) {
+    Out.write(reinterpret_cast<const char *>(&Value), sizeof(T));
+  }
+
+  // write a vector of trivially copyable values (size followed by values)
+  template<typename T>
+  void WriteVector(
+    const std::vector<T> &Values
+  ) {
+    Write<uint64_t>(Values.size());
+    Out.write(reinterpret_cast<const char *>(Values.data()),
+              Values.size() * sizeof(T));
+  }
+
+  // write Size raw bytes
+  void WriteBytes(
+    const char *Data,
+    std::size_t Size
+  ) {
+    Out.write(Data, Size);
+  }
+
+  // write zero bytes up to the next multiple of Alignment
+  void Align(
+    std::size_t Alignment
+  ) {
+    for (std::size_t Position = GetPosition(); Position % Alignment != 0;
+         ++Position) {
+      Out.put(0);
+    }
+  }
+
+  // write a string (length followed by characters)
+  void WriteString(
+    const std::string &String
+  );
+
+  // write a vector of strings
+  void WriteStringVector(
+    const std::vector<std::string> &Strings
+  );
+
+  // get current position in the file
+  uint64_t GetPosition() {
+    return Out.tellp();
+  }
+
+  // get the written data (memory buffer only)
+  std::string GetBuffer() const {
+    return BufferOut.str();
+  }
+
+  // flush and check if all writes were successful
+  bool Close();
+};
+
+/* reads values written by BinaryWriter from a memory buffer */
+class BinaryReader {
+  const char *Pos;                     // current read position
+  const char *End;                     // end of buffer
+
+  // throw std::runtime_error if less than Size bytes are left
+  void Require(
+    std::size_t Size
+  ) const;
+
+public:
+  /* constructor */
+  // read from the Size bytes starting at Data
+  BinaryReader(
+    const char *Data,
+    std::size_t Size
+  );
+
+  /* interface */
+  // read a trivially copyable value
+  template<typename T>
+  T Read() {
+    Require(sizeof(T));
+    T Value;
+    std::memcpy(&Value, Pos, sizeof(T));
+    Pos += sizeof(T);
+    return Value;
+  }
+
+  // read a vector of trivially copyable values
+  template<typename T>
+  void ReadVector(
+    std::vector<T> *Values
+  ) {
+    std::size_t Size = Read<uint64_t>();
+    Require(Size * sizeof(T));
+    Values->resize(Size);
+    std::memcpy(Values->data(), Pos, Size * sizeof(T));
+    Pos += Size * sizeof(T);
+  }
+
+  // get a pointer to a vector written by WriteVector without copying it.
+  // The data must be suitably aligned for T (see Align)
+  template<typename T>
+  const T *MapVector(
+    std::size_t *Size
+  ) {
+    *Size = Read<uint64_t>();
+    Require(*Size * sizeof(T));
+    const T *Values = reinterpret_cast<const T *>(Pos);
+    Pos += *Size * sizeof(T);
+    return Values;
+  }
+
+  // skip the bytes written by BinaryWriter::Align (the buffer has to start
+  // at an address which is a multiple of Alignment)
+  void Align(
+    std::size_t Alignment
+  ) {
+    std::size_t Padding = (Alignment - reinterpret_cast<uintptr_t>(Pos) %
+                           Alignment) % Alignment;
+    Require(Padding);
+    Pos += Padding;
+  }
+
+  // read a string
+  std::string ReadString();
+
+  // read a vector of strings
+  void ReadStringVector(
+    std::vector<std::string> *Strings
+  );
+
+  // get pointer to the current read position
+  const char *GetPosition() const {
+    return Pos;
+  }
+
+  // get number of bytes left
+  std::size_t GetNumBytesLeft() const {
+    return End - Pos;
+  }
+};
+
+#endif
@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------------
+/**
+   File: MappedFile.cpp
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+*/
+// ----------------------------------------------------------------------------
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedFile.hpp"
+
+MappedFile::MappedFile(const std::string &FileName) :
+  FileDescriptor(open(FileName.c_str(), O_RDONLY)),
+  Data(NULL),
+  Size(0)
+{
+  if (FileDescriptor < 0) {
+    throw std::runtime_error("Could not open file " + FileName);
+  }
+  struct stat FileStat;
+  if (fstat(FileDescriptor, &FileStat) != 0) {
+    close(FileDescriptor);
+    throw std::runtime_error("Could not stat file " + FileName);
+  }
+  Size = FileStat.st_size;
+  if (Size > 0) {
+    void *Mapping =
+      mmap(NULL, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+    if (Mapping == MAP_FAILED) {
+      close(FileDescriptor);
+      throw std::runtime_error("Could not map file " + FileName);
+    }
+    madvise(Mapping, Size, MADV_SEQUENTIAL);
+    Data = static_cast<const char *>(Mapping);
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (Data != NULL) {
+    munmap(const_cast<char *>(Data), Size);
+  }
+  close(FileDescriptor);
+}
@@ -117,24 +117,24 @@ void WordLengthProbCalculator::UpdateWHPYLMBaseProbabilitiesScale(
   int WordLengthModulation
 )
 {
-  std::vector<int> WordLengths(LanguageModel->GetWordLengthVector());
+  const std::vector<int> &WordLengths = LanguageModel->GetWordLengthVector();
 
   int NumWords = 0;
   double MeanWordLength = 0;
   std::vector<double> ObservedWordLengthProbabilities;
   for (unsigned int WordId = 0; WordId < WordLengths.size(); ++WordId) {
     if (WordLengths[WordId] > 0) {
-      WordLengths[WordId]++;
+      int CurrentWordLength = WordLengths[WordId] + 1;
       int TablesPerWord = LanguageModel->GetWHPYLBaseTablesPerWord(WordId);
       NumWords += TablesPerWord;
-      MeanWordLength += TablesPerWord * WordLengths[WordId];
+      MeanWordLength += TablesPerWord * CurrentWordLength;
       ObservedWordLengthProbabilities.resize(
         std::max(
-          static_cast<size_t>(WordLengths[WordId] + 1),
+          static_cast<size_t>(CurrentWordLength + 1),
           ObservedWordLengthProbabilities.size()
         )
       );
-      ObservedWordLengthProbabilities.at(WordLengths[WordId]) += TablesPerWord;
+      ObservedWordLengthProbabilities.at(CurrentWordLength) += TablesPerWord;
     }
   }
 
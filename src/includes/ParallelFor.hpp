@@ -0,0 +1,132 @@
+// ----------------------------------------------------------------------------
+/**
+   File: ParallelFor.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2013> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Description: parallel loops over item indices, distributed by a shared
+                atomic counter, with exception propagation
+
+   Limitations: -
+*/
+// ----------------------------------------------------------------------------
+#ifndef _PARALLELFOR_HPP_
+#define _PARALLELFOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// number of worker threads used by ParallelFor for NumItems items and at
+// most MaxThreads threads
+inline std::size_t GetNumWorkerThreads(
+  std::size_t MaxThreads,
+  std::size_t NumItems
+)
+{
+  return std::max<std::size_t>(1, std::min<std::size_t>(MaxThreads, NumItems));
+}
+
+// run Function(Idx, IdxThread) for Idx in [0, NumItems), IdxThread being
+// the index of the calling worker thread (< GetNumWorkerThreads()). Every
+// thread takes the next unprocessed item from a shared atomic counter, as
+// processing times may differ a lot. The first exception thrown by any of
+// the calls is rethrown after all threads have finished, the remaining
+// items are skipped
+inline void ParallelForWithThreadIdx(
+  std::size_t MaxThreads,
+  std::size_t NumItems,
+  const std::function<void(std::size_t, std::size_t)> &Function
+)
+{
+  std::size_t NumThreads = GetNumWorkerThreads(MaxThreads, NumItems);
+  std::atomic<std::size_t> NextItem(0);
+  std::exception_ptr Exception;
+  std::mutex ExceptionMutex;
+
+  auto WorkerFn = [&](std::size_t IdxThread) {
+    for (std::size_t Item = NextItem++; Item < NumItems; Item = NextItem++) {
+      try {
+        Function(Item, IdxThread);
+      } catch (...) {
+        std::lock_guard<std::mutex> Lock(ExceptionMutex);
+        if (!Exception) {
+          Exception = std::current_exception();
+        }
+        NextItem = NumItems;
+      }
+    }
+  };
+
+  // the last worker runs in the calling thread
+  std::vector<std::thread> Threads;
+  for (std::size_t IdxThread = 0; IdxThread < NumThreads - 1; ++IdxThread) {
+    Threads.push_back(std::thread(WorkerFn, IdxThread));
+  }
+  WorkerFn(NumThreads - 1);
+  for (std::thread &Thread : Threads) {
+    Thread.join();
+  }
+
+  if (Exception) {
+    std::rethrow_exception(Exception);
+  }
+}
+
+// like ParallelForWithThreadIdx, but call Function(Idx)
+inline void ParallelFor(
+  std::size_t MaxThreads,
+  std::size_t NumItems,
+  const std::function<void(std::size_t)> &Function
+)
+{
+  ParallelForWithThreadIdx(MaxThreads, NumItems, [&](std::size_t Item, std::size_t) {
+    Function(Item);
+  });
+}
+
+#endif
@@ -60,8 +60,10 @@
 #ifndef _DEFINES_HPP_
 #define _DEFINES_HPP_
 
+#include <cstdint>
 #include <unordered_map>
 #include <fst/matcher.h>
+#include <fst/const-fst.h>
 #include <fst/compose-filter.h>
 #include <fst/lookahead-filter.h>
 #include "../NHPYLM/definitions.hpp"
@@ -85,6 +87,10 @@ static const std::string PHONE_PREFIX("");
 typedef fst::VectorFst<fst::StdArc> StdVectorFst;
 typedef fst::VectorFst<fst::LogArc> LogVectorFst;
 typedef fst::StateIterator<LogVectorFst>  LogStateIterator;
+// immutable fst with contiguous states and arcs and 32 bit offsets
+typedef fst::ConstFst<fst::LogArc, uint32_t> LogConstFst;
+// common base of LogVectorFst and LogConstFst
+typedef fst::ExpandedFst<fst::LogArc> LogExpandedFst;
 
 typedef std::unordered_map<std::string, int> StringToIntMap;
 typedef std::unordered_map<std::string, std::vector<std::string>> PronDictType;
@@ -97,6 +103,16 @@ typedef fst::ArcMapFst<fst::LogArc, fst::StdArc,
 
 typedef fst::ComposeFst<fst::LogArc> LogComposeFst;
 
+// copy of Fst with its own implementation. Copies made by the copy
+// constructor share the implementation with Fst through a reference count
+// that is not thread safe, so fsts used concurrently by several threads
+// have to be deep copies
+template<class Arc>
+inline fst::VectorFst<Arc> DeepCopyFst(const fst::VectorFst<Arc> &Fst)
+{
+  return fst::VectorFst<Arc>(static_cast<const fst::Fst<Arc> &>(Fst));
+}
+
 typedef int CharId; // alias for character id
 typedef int WordId; // alias for word id
 typedef LogVectorFst::StateId StateId;
@@ -113,5 +129,6 @@ struct ArcInfo {
 enum LatticeFileTypes {CMU_FST, HTK_FST, OPEN_FST, TEXT}; // file types for input lattices
 enum InputTypes {INPUT_FST, INPUT_TEXT};                  // input modes: fst or text
 enum SymbolWriteModes {NONE, NAMES, NAMESANDIDS};         // modes for symbol output in fst printing
+enum SegmentationOutputFormats {SEGMENTATION_TEXT, SEGMENTATION_DELTA}; // output formats for the sampled segmentations
 
 #endif
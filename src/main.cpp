@@ -62,7 +62,7 @@ int main(int argc, const char **argv)
 
   // Parse Input Files into FST data structures
   FileReader Reader(Parser.GetParameters());
-  FileData InputFileData = Reader.GetInputFileData();
+  FileData InputFileData = Reader.ReleaseInputFileData();
   // initialize the segmenter
   LatticeWordSegmentation Segmenter(Parser.GetParameters(), InputFileData);
 
@@ -1,6 +1,7 @@
 #!/bin/bash
 ./StartSim_text.bash Text/WSJCAM0_Grapheme_Text.txt 2 6 2
 ./StartSim_text_fixed.bash Text/WSJCAM0_Grapheme_Text.txt 2 6 2
+./StartSim_text_string.bash Text/WSJCAM0_Grapheme_Text.txt 2 6 2
 
 ./StartSim_htk_lattice_export.bash WSJCAM0_WSJ0+1_Cross_Lattice/WSJCAM0_Phoneme_Lattice.htk.txt 16
 ./StartSim_htk_lattice_export_NodeTimes.bash WSJCAM0_WSJ0+1_Cross_Lattice/WSJCAM0_Phoneme_Lattice.htk.txt 16